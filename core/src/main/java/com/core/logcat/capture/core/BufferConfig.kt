@@ -0,0 +1,19 @@
+package com.core.logcat.capture.core
+
+/**
+ * BufferConfig: Native buffer sizing, passed to [LogManager.startNative].
+ * Values are clamped natively; the pipe never exceeds `/proc/sys/fs/pipe-max-size`
+ * (the size actually granted is reported in [EngineStats.pipeCapacity]).
+ */
+data class BufferConfig(
+    /** Bytes per read from logcat. */
+    val readBufferSize: Int = 128 * 1024,
+    /** Idle poll interval: bounds stop and restart latency. */
+    val pollTimeoutMs: Int = 200,
+    /** Kernel buffer of the pipe towards Kotlin. */
+    val pipeSize: Int = 1024 * 1024,
+    /** Bytes of an unterminated line kept before it is discarded. */
+    val accumulatorCap: Int = 512 * 1024,
+    /** Grow read buffer and pipe under sustained backlog, shrink them when idle. */
+    val autoTune: Boolean = false,
+)
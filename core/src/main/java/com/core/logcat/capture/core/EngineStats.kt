@@ -0,0 +1,65 @@
+package com.core.logcat.capture.core
+
+/**
+ * EngineStats: Counters of the native engine, see [LogManager.engineStats].
+ */
+class EngineStats(
+    val bytesRead: Long,
+    val linesRead: Long,
+    val batches: Long,
+    val droppedBytes: Long,
+    val droppedRecords: Long,
+    /** Heap allocations made by the per-batch arena; stays flat once the engine is warmed up. */
+    val arenaAllocations: Long,
+    val arenaPeakBytes: Long,
+    /** Resident set size of the whole app process (/proc/self/statm). */
+    val rssBytes: Long,
+    /** Native buffers governed by the memory budget, see [LogManager.nativeMemoryUsage]. */
+    val nativeBytes: Long,
+    val memoryBudget: Long,
+    val trimLevel: Int,
+    /** Pipe size granted by the kernel (may be below [BufferConfig.pipeSize]). */
+    val pipeCapacity: Long,
+    /** Current read size; moves when [BufferConfig.autoTune] is on. */
+    val readBufferSize: Long,
+    /** Records lost by the in-process liblog hook because its queue was full. */
+    val sourceDropped: Long,
+    /** Events whose invalid UTF-8 was repaired natively before delivery. */
+    val utf8Repaired: Long,
+    /** Events tested against the filter regex. */
+    val filterChecks: Long,
+    /** Of [filterChecks], events rejected by the required-literal prefilter without running the regex. */
+    val prefilterSkips: Long,
+) {
+    /** Share of filtered events that never reached the regex engine (0 when nothing was filtered). */
+    val prefilterSkipRate: Double
+        get() = if (filterChecks > 0) prefilterSkips.toDouble() / filterChecks else 0.0
+
+    override fun toString(): String =
+        "lines=$linesRead bytes=$bytesRead batches=$batches dropped=$droppedRecords/${droppedBytes}B " +
+            "arenaAllocs=$arenaAllocations arenaPeak=${arenaPeakBytes}B " +
+            "rss=${rssBytes}B native=${nativeBytes}B/${memoryBudget}B trim=$trimLevel " +
+            "pipe=${pipeCapacity}B read=${readBufferSize}B sourceDropped=$sourceDropped " +
+            "utf8Repaired=$utf8Repaired filterChecks=$filterChecks prefilterSkips=$prefilterSkips"
+
+    /** Counter indices for [LogManager.engineCounter] (constructor order). */
+    companion object {
+        const val BYTES_READ = 0
+        const val LINES_READ = 1
+        const val BATCHES = 2
+        const val DROPPED_BYTES = 3
+        const val DROPPED_RECORDS = 4
+        const val ARENA_ALLOCATIONS = 5
+        const val ARENA_PEAK_BYTES = 6
+        const val RSS_BYTES = 7
+        const val NATIVE_BYTES = 8
+        const val MEMORY_BUDGET = 9
+        const val TRIM_LEVEL = 10
+        const val PIPE_CAPACITY = 11
+        const val READ_BUFFER_SIZE = 12
+        const val SOURCE_DROPPED = 13
+        const val UTF8_REPAIRED = 14
+        const val FILTER_CHECKS = 15
+        const val PREFILTER_SKIPS = 16
+    }
+}
@@ -0,0 +1,15 @@
+package com.core.logcat.capture.core
+
+/**
+ * FieldSummary: Aggregates of a numeric extracted field, maintained natively.
+ */
+class FieldSummary(
+    val count: Long,
+    val min: Double,
+    val max: Double,
+    val sum: Double,
+) {
+    val mean: Double get() = if (count > 0) sum / count else Double.NaN
+
+    override fun toString(): String = "count=$count min=$min max=$max mean=$mean"
+}
@@ -0,0 +1,20 @@
+package com.core.logcat.capture.core
+
+/**
+ * LogField: A typed value extracted natively by an extraction rule.
+ *
+ * @property rule Rule id returned by [LogManager.addExtractionRule].
+ * @property name Group name from the rule pattern, e.g. `ms` for `(?<ms:int>\d+)`.
+ * @property value [Long] for `int`, [Double] for `float`, [String] otherwise.
+ */
+class LogField(
+    val rule: Int,
+    val name: String,
+    val value: Any,
+) {
+    val longValue: Long? get() = value as? Long
+
+    val doubleValue: Double? get() = (value as? Double) ?: (value as? Long)?.toDouble()
+
+    override fun toString(): String = "$name=$value"
+}
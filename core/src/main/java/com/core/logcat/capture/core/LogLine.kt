@@ -0,0 +1,40 @@
+package com.core.logcat.capture.core
+
+/**
+ * LogLine: One delivered log event in framed mode.
+ *
+ * @property text The event text; multi-line events (stack traces) keep their inner '\n'.
+ * @property highlights Filter matches as [start0, end0, start1, end1, ...] char offsets into
+ * [text] (end exclusive), computed natively so the UI never re-runs the regex.
+ * @property highlightsTruncated True if the engine found more matches than it reported.
+ * @property fields Values extracted by rules registered with [LogManager.addExtractionRule].
+ * @property fieldsOnly True if only extraction rules matched; [text] is empty in that case.
+ * @property buffer logd buffer of the event ([BUFFER_MAIN], [BUFFER_CRASH], ...).
+ * @property textTruncated True if [text] was cut to fit one native frame (64KB).
+ */
+class LogLine(
+    val text: String,
+    val highlights: IntArray,
+    val highlightsTruncated: Boolean = false,
+    val fields: List<LogField> = emptyList(),
+    val fieldsOnly: Boolean = false,
+    val buffer: Int = BUFFER_MAIN,
+    val textTruncated: Boolean = false,
+) {
+    val highlightCount: Int get() = highlights.size / 2
+
+    fun highlightStart(index: Int): Int = highlights[index * 2]
+
+    fun highlightEnd(index: Int): Int = highlights[index * 2 + 1]
+
+    override fun toString(): String = text
+
+    companion object {
+        const val BUFFER_MAIN = 0
+        const val BUFFER_RADIO = 1
+        const val BUFFER_EVENTS = 2
+        const val BUFFER_SYSTEM = 3
+        const val BUFFER_CRASH = 4
+        const val BUFFER_KERNEL = 7
+    }
+}
@@ -10,7 +10,7 @@ import kotlinx.coroutines.sync.Mutex
 import kotlinx.coroutines.sync.withLock
 import java.io.FileInputStream
 import java.nio.ByteBuffer
-import java.nio.CharBuffer
+import java.nio.ByteOrder
 import java.nio.charset.StandardCharsets
 
 /**
@@ -40,20 +40,109 @@ object LogManager {
      */
     val logFlow = logChannel.receiveAsFlow()
 
+    /**
+     * FRAMED MODE CHANNEL
+     * Same backpressure policy as [logChannel]; carries events with native match spans.
+     */
+    private val lineChannel = Channel<LogLine>(
+        capacity = 5000,
+        onBufferOverflow = BufferOverflow.DROP_OLDEST,
+    )
+
+    /**
+     * Events delivered when started with `framed = true`, including highlight spans.
+     */
+    val lineFlow = lineChannel.receiveAsFlow()
+
+    // Framed batch layout, mirrored from BatchWriter.hpp
+    private const val BATCH_MAGIC = 0x3142434C
+    private const val BATCH_HEADER_BYTES = 16
+    private const val BATCH_MAX_FRAME_BYTES = 64 * 1024 // Enforced natively (BatchWriter)
+    private const val BATCH_FLAG_ASCII = 1
+    private const val RECORD_HEADER_BYTES = 8
+    private const val RECORD_FLAG_SPANS_TRUNCATED = 1
+    private const val RECORD_FLAG_HAS_FIELDS = 2
+    private const val RECORD_FLAG_FIELDS_ONLY = 4
+    private const val RECORD_FLAG_TEXT_TRUNCATED = 8
+    private const val RECORD_BUFFER_SHIFT = 12
+    private const val FIELD_TYPE_INT = 1
+    private const val FIELD_TYPE_FLOAT = 2
+
+    /**
+     * Native buffer names, in the engine's MemComponent order.
+     */
+    private val MEMORY_COMPONENTS = listOf(
+        "pipe", "readBuffer", "accumulator", "triggerRing", "assembler", "arena", "export",
+    )
+
+    /**
+     * Field names per extraction rule id, resolved once when the rule is added.
+     */
+    private val extractFieldNames = java.util.concurrent.ConcurrentHashMap<Int, Array<String>>()
+
+    /**
+     * Native tag id -> name. Ids are append-only, so only new names are fetched.
+     */
+    private val tagNames = ArrayList<String>()
+
+    /**
+     * Staging for ASCII batches and record text ranges (framed capture job only).
+     */
+    private var asciiBytes = ByteArray(16 * 1024)
+    private var textOffsets = IntArray(256)
+    private var textLengths = IntArray(256)
+
     init {
         System.loadLibrary("logcat_capture")
     }
 
     /**
      * Initializes and starts the native logcat capture process.
+     * @param framed Deliver [LogLine]s with match spans on [lineFlow] instead of Strings on [logFlow].
+     * @param buffers Native buffer sizes and auto-tuning.
+     * @param inProcess When [pid] is this app, capture through a liblog hook on Android 11+
+     * instead of a logcat child (falls back to logcat elsewhere). Only logs written after
+     * the start are seen.
+     * @param captureStdio Also capture what native code writes to stdout/stderr (normally
+     * discarded on Android) as lines tagged `stdout` (I) and `stderr` (W).
+     * @param logBuffers Comma-separated logcat buffers, e.g. "main,system,crash,events"
+     * (empty = main,system,crash); framed lines report theirs in [LogLine.buffer].
+     * @param mergeDelayMs How long a line may wait for older lines of other inputs
+     * (logcat, hook, stdio) so the output is timestamp-ordered; 0 = arrival order.
+     * @param tailFiles Text log files to follow like `tail -F` and merge into the stream,
+     * as `path` or `path|format` entries separated by ';'. The format describes the line
+     * prefix, e.g. "%Y-%m-%d %H:%M:%S.%f %L" (%L = level word); lines are tagged with the
+     * file's base name.
+     * @param packages Comma-separated package names: only lines of their processes pass
+     * (matched by name, so app restarts need no new pid). Leave [pid] empty to use it.
+     * @param format logcat `-v` options, comma-separated: "time" (default) or "threadtime",
+     * plus "epoch"/"monotonic" and "usec"/"nsec". Lines of every input use this format.
+     * @param template Reformats every delivered event natively, e.g. "{iso} {level} {tag:-20} {message}"
+     * (fields time, date, iso, epoch_ms, epoch_ns, level, tag, pid, tid, process, thread,
+     * buffer, message, line, rules; `:N`/`:-N` pads, `:json`/`:csv` escapes), or a preset:
+     * "compact", "threadtime", "csv", or "json" for JSON lines with ts, level, tag, pid, tid,
+     * msg and the ids of the matched extraction rules. Empty delivers lines as read.
+     * @param utf8HexEscape Invalid UTF-8 from native code is repaired before delivery: each
+     * invalid sequence becomes U+FFFD, or with this flag each invalid byte becomes `\xNN`.
      */
-    fun startNative(pid: String, tags: String, lv: String, reg: String) {
+    fun startNative(
+        pid: String, tags: String, lv: String, reg: String, framed: Boolean = false,
+        buffers: BufferConfig = BufferConfig(), inProcess: Boolean = true, captureStdio: Boolean = false,
+        logBuffers: String = "", mergeDelayMs: Int = 100, tailFiles: String = "",
+        packages: String = "", format: String = "time", template: String = "",
+        utf8HexEscape: Boolean = false,
+    ) {
         scope.launch {
             stopWithLock()
             globalLock.withLock {
-                val fd = configureAndStart(pid, tags, lv, reg)
+                val fd = configureAndStart(
+                    pid, tags, lv, reg, framed,
+                    buffers.readBufferSize, buffers.pollTimeoutMs, buffers.pipeSize, buffers.accumulatorCap,
+                    buffers.autoTune, inProcess, captureStdio, logBuffers, mergeDelayMs, tailFiles, packages, format,
+                    template, utf8HexEscape,
+                )
                 if (fd > 0) {
-                    captureJob = launchCaptureJob(fd)
+                    captureJob = if (framed) launchFramedCaptureJob(fd) else launchCaptureJob(fd)
                 }
             }
         }
@@ -93,66 +182,228 @@ object LogManager {
         scope.launch { globalLock.withLock { updateLiteral(text) } }
     }
 
+    /**
+     * Adds a native extraction rule. Named groups become typed fields on [LogLine.fields]:
+     * `(?<name:int>...)`, `(?<name:float>...)` or `(?<name>...)` for strings, e.g.
+     * `took (?<ms:int>\d+)ms`. Fields are delivered in framed mode only.
+     *
+     * Numeric fields also feed native quantile sketches, see [fieldQuantiles].
+     *
+     * @param withLine Deliver the matching event's text even if the current filter rejects it;
+     * when false such events arrive as field-only [LogLine]s.
+     * @param deliverFields Send fields to Kotlin per event; false keeps them in the native
+     * histograms only (no per-line traffic).
+     * @return the rule id, or -1 if the pattern is invalid (lookbehinds included) or has more
+     * than 255 named groups; the reason is logged.
+     */
+    fun addExtractionRule(pattern: String, withLine: Boolean = false, deliverFields: Boolean = true): Int {
+        val id = addExtractRule(pattern, withLine, deliverFields)
+        if (id >= 0) extractFieldNames[id] = getExtractFieldNames(id)
+        return id
+    }
+
+    /**
+     * Removes all extraction rules.
+     */
+    fun clearExtractionRules() {
+        clearExtractRules()
+        extractFieldNames.clear()
+    }
+
+    /**
+     * Live quantiles of a numeric field, e.g. `fieldQuantiles(rule, "ms", 0.5, 0.99)`.
+     * Values are within 1% relative error (DDSketch).
+     * @return one value per quantile, or null if the field has no samples yet.
+     */
+    fun fieldQuantiles(ruleId: Int, field: String, vararg quantiles: Double): DoubleArray? {
+        val index = extractFieldNames[ruleId]?.indexOf(field) ?: return null
+        if (index < 0) return null
+        return getFieldQuantiles(ruleId, index, quantiles)
+    }
+
+    /**
+     * Count/min/max/sum of a numeric field, or null if it has no samples yet.
+     */
+    fun fieldSummary(ruleId: Int, field: String): FieldSummary? {
+        val index = extractFieldNames[ruleId]?.indexOf(field) ?: return null
+        if (index < 0) return null
+        val v = getFieldSummary(ruleId, index) ?: return null
+        return FieldSummary(v[0].toLong(), v[1], v[2], v[3])
+    }
+
+    /**
+     * Clears the histograms of [ruleId] (-1 = all rules), keeping the rules.
+     */
+    fun resetFieldHistograms(ruleId: Int = -1) {
+        resetFieldStats(ruleId)
+    }
+
+    /**
+     * Lines captured per tag since the engine was loaded, counted natively on interned tag ids.
+     * Headerless lines (e.g. "--------- beginning of main") are counted under "".
+     */
+    fun tagLineCounts(): Map<String, Long> {
+        val counts = getTagLineCounts()
+        val names = synchronized(tagNames) {
+            if (counts.size > tagNames.size) tagNames.addAll(getTagNames(tagNames.size))
+            tagNames.toList()
+        }
+        val result = HashMap<String, Long>(counts.size)
+        for (id in 0 until minOf(counts.size, names.size)) result[names[id]] = counts[id]
+        return result
+    }
+
+    /**
+     * Snapshot of the native engine counters (throughput, drops, per-batch arena usage).
+     */
+    fun engineStats(): EngineStats {
+        val v = getEngineStats()
+        return EngineStats(
+            v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10].toInt(), v[11], v[12], v[13], v[14],
+            v[15], v[16],
+        )
+    }
+
+    /**
+     * One engine counter by index ([EngineStats.LINES_READ], ...), for polling at UI rate:
+     * no array or object is allocated on either side of the bridge.
+     */
+    fun engineCounter(index: Int): Long = getEngineCounter(index)
+
+    /**
+     * Number of distinct tags seen so far; cheap enough to poll before [tagLineCounts].
+     */
+    fun tagCount(): Int = getTagCount()
+
+    /**
+     * Sets the total budget for the engine's native buffers (pipe, read buffer, crash
+     * history ring, export block, ...). Quotas scale with it; 0 restores the default.
+     */
+    fun setNativeMemoryBudget(bytes: Long) {
+        setMemoryBudget(bytes)
+    }
+
+    /**
+     * Forward `ComponentCallbacks2.onTrimMemory` here: native buffers shrink with the
+     * level (history is kept as far as it fits). Call with 0 to restore full size.
+     */
+    fun onTrimMemory(level: Int) {
+        trimMemory(level)
+    }
+
+    /**
+     * Current size and quota of each native buffer.
+     */
+    fun nativeMemoryUsage(): List<NativeMemoryUsage> {
+        val v = getMemoryUsage()
+        return MEMORY_COMPONENTS.mapIndexed { i, name -> NativeMemoryUsage(name, v[i * 2], v[i * 2 + 1]) }
+    }
+
+    /**
+     * Sets the multi-line event window. Stack traces and other continuation lines from the
+     * same pid/tag arriving within [windowMs] are grouped, filtered and delivered as one
+     * event (so a regex on the exception name keeps the whole trace). 0 disables grouping.
+     */
+    fun setEventReassembly(windowMs: Int) {
+        scope.launch { globalLock.withLock { setReassemblyWindow(windowMs) } }
+    }
+
+    /**
+     * Enables native crash/ANR capture. On a trigger line (FATAL EXCEPTION, ANR in, native
+     * crash markers) the engine writes the previous [preSeconds] and the next [postSeconds]
+     * of log into `crash_<time>.log` inside [dir], without any help from the Kotlin layer.
+     */
+    fun enableCrashCapture(dir: String, preSeconds: Int = 10, postSeconds: Int = 5) {
+        scope.launch { globalLock.withLock { configureTrigger(dir, preSeconds, postSeconds) } }
+    }
+
+    /**
+     * Disables crash/ANR capture; a bundle in flight is finalized.
+     */
+    fun disableCrashCapture() {
+        scope.launch { globalLock.withLock { configureTrigger("", 0, 0) } }
+    }
+
+    /**
+     * Exports every captured line into a compressed columnar file (LOGCOL) at [path],
+     * written in blocks by the native thread. Read it on a desktop with `tools/logcol`.
+     */
+    fun startColumnarExport(path: String) {
+        scope.launch { globalLock.withLock { startExport(path) } }
+    }
+
+    /**
+     * Stops the columnar export; the last partial block is flushed and the file closed.
+     */
+    fun stopColumnarExport() {
+        scope.launch { globalLock.withLock { stopExport() } }
+    }
+
     /**
      * DATA CAPTURE JOB
      * Reads raw bytes from the Native pipe and decodes them into UTF-8 lines.
      */
     private fun CoroutineScope.launchCaptureJob(fd: Int): Job = launch(Dispatchers.IO) {
         val byteBuffer = ByteBuffer.allocateDirect(256 * 1024)
-        val charBuffer = CharBuffer.allocate(256 * 1024)
-        val decoder = StandardCharsets.UTF_8.newDecoder()
-        val lineBuilder = StringBuilder(4096)
-
-        fun drainCharBuffer() {
-            charBuffer.flip()
-            while (charBuffer.hasRemaining()) {
-                val c = charBuffer.get()
-                if (c == '\n') {
-                    if (lineBuilder.isNotEmpty()) {
-                        logChannel.trySend(lineBuilder.toString())
-                        lineBuilder.setLength(0)
-                    }
-                } else {
-                    lineBuilder.append(c)
-                }
-            }
-            charBuffer.clear()
+        val consumed = IntArray(1)
+
+        // Complete lines are split and decoded natively, one JNI call per read
+        fun dispatchLines(last: Boolean) {
+            val lines = decodeLines(byteBuffer, byteBuffer.position(), last, consumed)
+            lines?.forEach { logChannel.trySend(it) }
+            // Shifts the unterminated tail to the beginning for the next read cycle
+            byteBuffer.flip()
+            byteBuffer.position(consumed[0])
+            byteBuffer.compact()
         }
 
         try {
             ParcelFileDescriptor.adoptFd(fd).use { pfd ->
                 val channel = FileInputStream(pfd.fileDescriptor).channel
                 while (isActive && channel.isOpen) {
-                    byteBuffer.clear()
                     val bytesRead = channel.read(byteBuffer)
                     if (bytesRead <= 0) break
-
-                    byteBuffer.flip()
-                    charBuffer.clear()
-
-                    // Decode chunk -> chars
-                    decoder.decode(byteBuffer, charBuffer, false)
-                    drainCharBuffer()
-
-                    // Shifts unread bytes to the beginning for the next read cycle
-                    byteBuffer.compact()
+                    dispatchLines(false)
                 }
 
-                // Flush the decoder state and dispatch the final log line if it lacks a trailing newline
-                byteBuffer.flip()
-                decoder.decode(byteBuffer, charBuffer, true)
-                drainCharBuffer()
+                // Dispatch the final log line if it lacks a trailing newline
+                dispatchLines(true)
+            }
+        } catch (e: Exception) {
+            Log.e(TAG, "Error in log capture job", e)
+        } finally {
+            withContext(NonCancellable) {
+                stop() // Final fallback cleanup
+            }
+        }
+    }
 
-                decoder.flush(charBuffer)
-                drainCharBuffer()
+    /**
+     * FRAMED CAPTURE JOB
+     * Reads whole batches (see BatchWriter.hpp) and emits one [LogLine] per record.
+     * A batch is only parsed once all of its bytes are buffered. Frames never exceed
+     * BATCH_MAX_FRAME_BYTES, so after compact() the buffer always has room for the rest of
+     * a pending frame and read() can only return 0 at end of stream.
+     */
+    private fun CoroutineScope.launchFramedCaptureJob(fd: Int): Job = launch(Dispatchers.IO) {
+        val buffer = ByteBuffer.allocateDirect(8 * BATCH_MAX_FRAME_BYTES).order(ByteOrder.LITTLE_ENDIAN)
 
-                if (lineBuilder.isNotEmpty()) {
-                    logChannel.trySend(lineBuilder.toString())
-                    lineBuilder.setLength(0)
+        try {
+            ParcelFileDescriptor.adoptFd(fd).use { pfd ->
+                val channel = FileInputStream(pfd.fileDescriptor).channel
+                while (isActive && channel.isOpen) {
+                    if (channel.read(buffer) <= 0) break
+                    buffer.flip()
+                    if (!drainBatches(buffer)) {
+                        Log.e(TAG, "Framed stream out of sync, dropping buffered bytes")
+                        buffer.clear()
+                        continue
+                    }
+                    buffer.compact()
                 }
             }
         } catch (e: Exception) {
-            Log.e(TAG, "Error in log capture job", e)
+            Log.e(TAG, "Error in framed capture job", e)
         } finally {
             withContext(NonCancellable) {
                 stop() // Final fallback cleanup
@@ -160,9 +411,155 @@ object LogManager {
         }
     }
 
+    /**
+     * Parses every complete batch in [buf]; an incomplete tail is left for the next read.
+     * Texts of a batch are turned into strings together: a Latin-1 copy for batches the
+     * engine flagged ASCII, one native UTF-8 -> UTF-16 call ([decodeTexts]) otherwise.
+     * @return false if the stream is not positioned on a batch header.
+     */
+    private fun drainBatches(buf: ByteBuffer): Boolean {
+        while (buf.remaining() >= BATCH_HEADER_BYTES) {
+            val start = buf.position()
+            if (buf.getInt(start) != BATCH_MAGIC) return false
+            val ascii = buf.getShort(start + 6).toInt() and BATCH_FLAG_ASCII != 0
+            val count = buf.getInt(start + 8)
+            val payload = buf.getInt(start + 12)
+            // A frame above the native maximum can only be a corrupt header
+            if (payload < 0 || BATCH_HEADER_BYTES + payload > BATCH_MAX_FRAME_BYTES) return false
+            if (buf.remaining() < BATCH_HEADER_BYTES + payload) break
+
+            if (textOffsets.size < count) {
+                textOffsets = IntArray(maxOf(count, textOffsets.size * 2))
+                textLengths = IntArray(textOffsets.size)
+            }
+            val flagsOf = IntArray(count)
+            val spansOf = arrayOfNulls<IntArray>(count)
+            val fieldsOf = arrayOfNulls<List<LogField>>(count)
+            buf.position(start + BATCH_HEADER_BYTES)
+            for (i in 0 until count) {
+                val length = buf.int
+                val spanCount = buf.short.toInt() and 0xFFFF
+                flagsOf[i] = buf.short.toInt() and 0xFFFF
+                spansOf[i] = IntArray(spanCount * 2) { buf.int }
+                fieldsOf[i] = if (flagsOf[i] and RECORD_FLAG_HAS_FIELDS != 0) readFields(buf) else emptyList()
+                textOffsets[i] = buf.position()
+                textLengths[i] = length
+                buf.position(buf.position() + length)
+            }
+            val end = buf.position()
+            val texts = if (ascii) null else decodeTexts(buf, textOffsets, textLengths, count) ?: return false
+
+            for (i in 0 until count) {
+                val textStart = textOffsets[i]
+                val length = textLengths[i]
+                val spans = spansOf[i]!!
+                val text = if (texts != null) {
+                    texts[i]
+                } else {
+                    // Latin-1 is a plain byte -> char copy (and a compact string on ART)
+                    if (asciiBytes.size < length) asciiBytes = ByteArray(maxOf(length, asciiBytes.size * 2))
+                    buf.position(textStart)
+                    buf.get(asciiBytes, 0, length)
+                    String(asciiBytes, 0, length, StandardCharsets.ISO_8859_1)
+                }
+
+                if (text.length != length && spans.isNotEmpty()) {
+                    byteToCharOffsets(buf, textStart, length, spans)
+                }
+                lineChannel.trySend(
+                    LogLine(
+                        text = text,
+                        highlights = spans,
+                        highlightsTruncated = flagsOf[i] and RECORD_FLAG_SPANS_TRUNCATED != 0,
+                        fields = fieldsOf[i]!!,
+                        fieldsOnly = flagsOf[i] and RECORD_FLAG_FIELDS_ONLY != 0,
+                        textTruncated = flagsOf[i] and RECORD_FLAG_TEXT_TRUNCATED != 0,
+                        buffer = flagsOf[i] ushr RECORD_BUFFER_SHIFT,
+                    )
+                )
+            }
+            buf.position(end)
+        }
+        return true
+    }
+
+    /**
+     * Reads a record's field block (FieldBlockHeader + entries, see BatchWriter.hpp).
+     */
+    private fun readFields(buf: ByteBuffer): List<LogField> {
+        val count = buf.short.toInt() and 0xFFFF
+        buf.short // reserved
+        buf.int   // block bytes
+        val fields = ArrayList<LogField>(count)
+        repeat(count) {
+            val type = buf.get().toInt()
+            val rule = buf.get().toInt() and 0xFF
+            val field = buf.get().toInt() and 0xFF
+            buf.get() // reserved
+            val size = buf.int
+            val value: Any = when (type) {
+                FIELD_TYPE_INT -> buf.long
+                FIELD_TYPE_FLOAT -> buf.double
+                else -> ByteArray(size).also { buf.get(it) }.toString(StandardCharsets.UTF_8)
+            }
+            val name = extractFieldNames[rule]?.getOrNull(field) ?: "#$field"
+            fields.add(LogField(rule, name, value))
+        }
+        return fields
+    }
+
+    /**
+     * Converts ascending UTF-8 byte offsets in [offsets] to UTF-16 char offsets in place.
+     * Only needed for non-ASCII records, where byte and char positions diverge.
+     */
+    private fun byteToCharOffsets(buf: ByteBuffer, textStart: Int, length: Int, offsets: IntArray) {
+        val sorted = offsets.copyOf().also { it.sort() }
+        val mapped = HashMap<Int, Int>(sorted.size)
+        var chars = 0
+        var next = 0
+        for (i in 0..length) {
+            while (next < sorted.size && sorted[next] == i) mapped[sorted[next++]] = chars
+            if (i == length || next == sorted.size) break
+            val b = buf.get(textStart + i).toInt() and 0xFF
+            chars += when {
+                b and 0xC0 == 0x80 -> 0 // Continuation byte
+                b >= 0xF0 -> 2          // Supplementary plane: surrogate pair
+                else -> 1
+            }
+        }
+        for (k in offsets.indices) offsets[k] = mapped[offsets[k]] ?: chars
+    }
+
     // --- NATIVE BRIDGES ---
-    private external fun configureAndStart(p: String, t: String, l: String, r: String): Int
+    // Bound in JNI_OnLoad (RegisterNatives): keep in sync with LOG_MANAGER_METHODS in LogEngine_jni.cpp.
+    private external fun configureAndStart(
+        p: String, t: String, l: String, r: String, framed: Boolean,
+        readBufferSize: Int, pollTimeoutMs: Int, pipeSize: Int, accumulatorCap: Int, autoTune: Boolean,
+        inProcess: Boolean, captureStdio: Boolean, logBuffers: String, mergeDelayMs: Int,
+        tailFiles: String, packages: String, format: String, template: String,
+        utf8HexEscape: Boolean,
+    ): Int
+    private external fun decodeTexts(buffer: ByteBuffer, offsets: IntArray, lengths: IntArray, count: Int): Array<String>?
+    private external fun decodeLines(buffer: ByteBuffer, length: Int, last: Boolean, consumed: IntArray): Array<String>?
     private external fun stop()
     private external fun updateRegex(r: String)
     private external fun updateLiteral(t: String)
+    private external fun configureTrigger(dir: String, preSeconds: Int, postSeconds: Int)
+    private external fun setReassemblyWindow(windowMs: Int)
+    private external fun addExtractRule(pattern: String, withLine: Boolean, emitFields: Boolean): Int
+    private external fun getExtractFieldNames(ruleId: Int): Array<String>
+    private external fun clearExtractRules()
+    private external fun getFieldQuantiles(ruleId: Int, field: Int, quantiles: DoubleArray): DoubleArray?
+    private external fun getFieldSummary(ruleId: Int, field: Int): DoubleArray?
+    private external fun resetFieldStats(ruleId: Int)
+    private external fun startExport(path: String)
+    private external fun stopExport()
+    private external fun getTagNames(fromId: Int): Array<String>
+    private external fun getTagLineCounts(): LongArray
+    private external fun getEngineStats(): LongArray
+    private external fun getEngineCounter(index: Int): Long
+    private external fun getTagCount(): Int
+    private external fun setMemoryBudget(bytes: Long)
+    private external fun trimMemory(level: Int)
+    private external fun getMemoryUsage(): LongArray
 }
\ No newline at end of file
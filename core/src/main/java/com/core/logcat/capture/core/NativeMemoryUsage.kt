@@ -0,0 +1,12 @@
+package com.core.logcat.capture.core
+
+/**
+ * NativeMemoryUsage: Size and quota of one native buffer governed by the memory budget.
+ */
+class NativeMemoryUsage(
+    val component: String,
+    val usedBytes: Long,
+    val quotaBytes: Long,
+) {
+    override fun toString(): String = "$component: $usedBytes/$quotaBytes"
+}
@@ -0,0 +1,75 @@
+#include "Arena.hpp"
+#include <algorithm>
+
+thread_local Arena *Arena::t_current = nullptr;
+
+Arena::Arena(size_t chunkSize) : m_chunkSize(chunkSize) {
+    m_chunks.reserve(8);
+}
+
+void Arena::addChunk(size_t minSize) {
+    if (!m_chunks.empty()) m_batchBytes += m_used;
+    size_t size = std::max(m_chunkSize, minSize);
+    m_chunks.push_back({std::unique_ptr<char[]>(new char[size]), size});
+    m_used = 0;
+    m_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * ALLOCATE (HOT PATH)
+ * Aligns the bump pointer; a new chunk is only taken when the current one is exhausted.
+ */
+void *Arena::allocate(size_t size, size_t align) {
+    if (!m_chunks.empty()) {
+        Chunk &c = m_chunks.back();
+        auto base = reinterpret_cast<uintptr_t>(c.data.get());
+        size_t at = ((base + m_used + align - 1) & ~(uintptr_t(align) - 1)) - base;
+        if (at + size <= c.size) {
+            m_used = at + size;
+            return c.data.get() + at;
+        }
+    }
+    addChunk(size + align);
+    return allocate(size, align);
+}
+
+/**
+ * RESET
+ * A batch that spilled over several chunks is a hint for the next one: the chunks are
+ * replaced by a single chunk large enough for the whole batch.
+ */
+void Arena::reset() {
+    size_t batchBytes = m_batchBytes + m_used;
+    if (batchBytes > m_peakBytes.load(std::memory_order_relaxed)) {
+        m_peakBytes.store(batchBytes, std::memory_order_relaxed);
+    }
+
+    if (m_chunks.size() > 1) {
+        size_t total = 0;
+        for (const auto &c: m_chunks) total += c.size;
+        m_chunks.clear();
+        m_chunkSize = std::max(m_chunkSize, total);
+        addChunk(total);
+    }
+    m_used = 0;
+    m_batchBytes = 0;
+}
+
+/**
+ * TRIM
+ * Drops the chunks when they exceed the quota; the next batch starts with a chunk of
+ * at most `maxBytes`.
+ */
+void Arena::trim(size_t maxBytes) {
+    m_chunkSize = std::min(m_chunkSize, maxBytes);
+    if (reservedBytes() > maxBytes) {
+        m_chunks.clear();
+        m_used = 0;
+    }
+}
+
+size_t Arena::reservedBytes() const {
+    size_t total = 0;
+    for (const auto &c: m_chunks) total += c.size;
+    return total;
+}
@@ -0,0 +1,119 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <regex>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Arena: bump allocator for state that lives for one read batch.
+ *
+ * allocate() is a pointer bump; nothing is freed individually. reset() at the end of the
+ * batch rewinds to the start, and if the batch needed more than one chunk the chunks are
+ * merged into one chunk of the combined size. After a few batches the arena fits the
+ * workload and the steady state performs no heap allocation at all.
+ *
+ * Worker-thread only, except the counters which may be read from any thread.
+ */
+class Arena {
+public:
+    explicit Arena(size_t chunkSize = 64 * 1024);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    /**
+     * Invalidates every allocation made since the previous reset.
+     */
+    void reset();
+
+    /**
+     * Caps the memory kept across batches (memory budget). Call right after reset().
+     */
+    void trim(size_t maxBytes);
+
+    /**
+     * Bytes currently held in chunks.
+     */
+    size_t reservedBytes() const;
+
+    /**
+     * Chunks obtained from the heap since creation (the allocation counter in stats).
+     */
+    uint64_t heapAllocations() const { return m_heapAllocations.load(std::memory_order_relaxed); }
+
+    /**
+     * Largest number of bytes used by a single batch.
+     */
+    uint64_t peakBytes() const { return m_peakBytes.load(std::memory_order_relaxed); }
+
+    /**
+     * Arena bound to the calling thread (nullptr if none). Default-constructed
+     * ArenaAllocators use it, which covers containers the standard library creates
+     * internally (e.g. the regex executor's state).
+     */
+    static Arena* current() { return t_current; }
+    static void setCurrent(Arena* arena) { t_current = arena; }
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    void addChunk(size_t minSize);
+
+    std::vector<Chunk> m_chunks;
+    size_t m_chunkSize;
+    size_t m_used = 0;          // Bytes used in the last chunk
+    size_t m_batchBytes = 0;    // Bytes used in full chunks of the current batch
+
+    std::atomic<uint64_t> m_heapAllocations{0};
+    std::atomic<uint64_t> m_peakBytes{0};
+
+    static thread_local Arena* t_current;
+};
+
+/**
+ * STL adapter: lets containers and std::match_results draw from an Arena.
+ * deallocate() is a no-op; memory returns to the arena at reset(). Without an arena
+ * (none bound to the thread) it falls back to the heap.
+ */
+template<typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    ArenaAllocator() noexcept : arena(Arena::current()) {}
+    explicit ArenaAllocator(Arena& arena) noexcept : arena(&arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        if (!arena) return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        if (!arena) ::operator delete(p);
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+
+    Arena* arena;
+};
+
+/**
+ * Match results whose sub-match storage lives in the batch arena.
+ */
+using ArenaMatch = std::match_results<const char*, ArenaAllocator<std::csub_match>>;
+
+#endif // ARENA_HPP
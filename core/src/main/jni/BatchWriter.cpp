@@ -0,0 +1,251 @@
+#include "BatchWriter.hpp"
+#include "FieldExtractor.hpp"
+#include "Utf8.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include <android/log.h>
+
+#define TAG "LogcatEngine-Batch"
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Fallback when F_GETPIPE_SZ is unavailable: the Linux default pipe size.
+ */
+static constexpr int DEFAULT_PIPE_CAPACITY = 64 * 1024;
+
+void BatchWriter::reset(int fd, bool framed) {
+    m_fd = fd;
+    m_framed = framed;
+    m_records = 0;
+    m_failed = false;
+    m_ascii = true;
+    m_buf.clear();
+    m_buf.reserve(BATCH_MAX_FRAME_BYTES * 2);
+    m_textEnds.clear();
+    m_textEnds.reserve(1024);
+    if (m_framed) m_buf.resize(sizeof(BatchHeader)); // Header is patched in flush()
+
+    int cap = fcntl(fd, F_GETPIPE_SZ);
+    m_pipeCapacity = cap > 0 ? cap : DEFAULT_PIPE_CAPACITY;
+}
+
+/**
+ * PIPE SIZE
+ * Requests above pipe-max-size fail with EPERM for apps, so they are clamped first. The
+ * kernel also refuses to shrink below the bytes currently queued (EBUSY); the previous
+ * size is kept then and the next resize retries.
+ */
+int BatchWriter::setPipeSize(int fd, int bytes) {
+    bytes = std::min(bytes, pipeMaxSize());
+    if (fcntl(fd, F_SETPIPE_SZ, bytes) == -1) {
+        __android_log_print(ANDROID_LOG_WARN, TAG, "setPipeSize(): F_SETPIPE_SZ(%d) failed: %s", bytes, strerror(errno));
+    }
+    return fcntl(fd, F_GETPIPE_SZ);
+}
+
+int BatchWriter::pipeMaxSize() {
+    static const int maxSize = [] {
+        int value = 0;
+        int fd = open("/proc/sys/fs/pipe-max-size", O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            char buf[32];
+            ssize_t n = read(fd, buf, sizeof(buf) - 1);
+            if (n > 0) {
+                buf[n] = '\0';
+                value = atoi(buf);
+            }
+            close(fd);
+        }
+        return value > 0 ? value : 1024 * 1024;
+    }();
+    return maxSize;
+}
+
+int BatchWriter::resizePipe(int bytes) {
+    if (m_fd < 0) return m_pipeCapacity;
+    int cap = setPipeSize(m_fd, bytes);
+    if (cap > 0) m_pipeCapacity = cap;
+    return m_pipeCapacity;
+}
+
+bool BatchWriter::appendText(std::string_view event) {
+    if (m_records && m_buf.size() + event.size() > frameLimit() && !flush()) return false;
+    m_buf.insert(m_buf.end(), event.begin(), event.end());
+    m_records++;
+    m_textEnds.push_back(static_cast<uint32_t>(m_buf.size()));
+    return flushIfLarge();
+}
+
+bool BatchWriter::appendRecord(std::string_view text, const MatchSpan *spans, uint16_t spanCount,
+                               uint16_t flags, const FieldValue *fields, size_t fieldCount) {
+    size_t fieldBytes = 0;
+    if (fieldCount) {
+        flags |= RECORD_FLAG_HAS_FIELDS;
+        for (size_t i = 0; i < fieldCount; ++i) {
+            fieldBytes += sizeof(FieldEntryHeader) +
+                          (fields[i].type == FieldType::String ? fields[i].s.size() : 8);
+        }
+    }
+
+    // One record must fit an otherwise empty frame: oversized parts are dropped in order
+    // of size (fields, then spans) before the text is cut
+    const size_t limit = frameLimit() - sizeof(BatchHeader);
+    size_t fixed = sizeof(RecordHeader) + spanCount * sizeof(MatchSpan) +
+                   (fieldCount ? sizeof(FieldBlockHeader) + fieldBytes : 0);
+    uint32_t lastSpanEnd = spanCount ? spans[spanCount - 1].end : 0;
+    if (unlikely(fixed + text.size() > limit)) {
+        if (fixed > limit / 2 && fieldCount) {
+            fieldCount = 0;
+            fieldBytes = 0;
+            flags &= ~RECORD_FLAG_HAS_FIELDS;
+        }
+        const size_t maxSpans = limit / 4 / sizeof(MatchSpan);
+        if (spanCount > maxSpans) {
+            spanCount = static_cast<uint16_t>(maxSpans);
+            flags |= RECORD_FLAG_SPANS_TRUNCATED;
+        }
+        fixed = sizeof(RecordHeader) + spanCount * sizeof(MatchSpan) +
+                (fieldCount ? sizeof(FieldBlockHeader) + fieldBytes : 0);
+        if (fixed + text.size() > limit) {
+            text = text.substr(0, utf8BoundaryPrefix(text.data(), limit - fixed));
+            flags |= RECORD_FLAG_TEXT_TRUNCATED;
+            // Spans are ordered: drop those past the cut, clamp the last one kept
+            const auto cut = static_cast<uint32_t>(text.size());
+            while (spanCount && spans[spanCount - 1].start >= cut) {
+                --spanCount;
+                flags |= RECORD_FLAG_SPANS_TRUNCATED;
+            }
+            fixed = sizeof(RecordHeader) + spanCount * sizeof(MatchSpan) +
+                    (fieldCount ? sizeof(FieldBlockHeader) + fieldBytes : 0);
+            lastSpanEnd = spanCount ? std::min(spans[spanCount - 1].end, cut) : 0;
+        } else if (spanCount) {
+            lastSpanEnd = spans[spanCount - 1].end; // The kept prefix of the span list
+        }
+    }
+
+    // Flush first rather than let this record push the frame past the limit
+    if (m_records && m_buf.size() + fixed + text.size() > limit + sizeof(BatchHeader) && !flush()) return false;
+
+    RecordHeader rh{static_cast<uint32_t>(text.size()), spanCount, flags};
+    size_t at = m_buf.size();
+    m_buf.resize(at + fixed + text.size());
+
+    char *out = m_buf.data() + at;
+    memcpy(out, &rh, sizeof(rh));
+    out += sizeof(rh);
+    if (spanCount) {
+        memcpy(out, spans, spanCount * sizeof(MatchSpan));
+        out += spanCount * sizeof(MatchSpan);
+        memcpy(out - sizeof(uint32_t), &lastSpanEnd, sizeof(lastSpanEnd));
+    }
+    if (fieldCount) {
+        FieldBlockHeader fb{static_cast<uint16_t>(fieldCount), 0, static_cast<uint32_t>(fieldBytes)};
+        memcpy(out, &fb, sizeof(fb));
+        out += sizeof(fb);
+        for (size_t i = 0; i < fieldCount; ++i) {
+            const FieldValue &v = fields[i];
+            bool str = v.type == FieldType::String;
+            FieldEntryHeader eh{static_cast<uint8_t>(v.type), v.rule, v.field, 0,
+                                static_cast<uint32_t>(str ? v.s.size() : 8)};
+            memcpy(out, &eh, sizeof(eh));
+            out += sizeof(eh);
+            if (str) memcpy(out, v.s.data(), v.s.size());
+            else if (v.type == FieldType::Int) memcpy(out, &v.i, 8);
+            else memcpy(out, &v.f, 8);
+            out += eh.size;
+        }
+    }
+    if (!text.empty()) memcpy(out, text.data(), text.size());
+    if (m_ascii) m_ascii = isAscii(text); // Stops scanning at the batch's first non-ASCII record
+    m_records++;
+    return flushIfLarge();
+}
+
+/**
+ * FRAME LIMIT
+ * Half the pipe: with the reader keeping up, a frame never waits for more than one
+ * other frame to drain. Capped at BATCH_MAX_FRAME_BYTES, which bounds the reader's buffer.
+ */
+size_t BatchWriter::frameLimit() const {
+    return std::min(BATCH_MAX_FRAME_BYTES, static_cast<size_t>(m_pipeCapacity) / 2);
+}
+
+bool BatchWriter::flushIfLarge() {
+    return m_buf.size() < frameLimit() || flush();
+}
+
+size_t BatchWriter::pipeFreeSpace() const {
+    int queued = 0;
+    if (ioctl(m_fd, FIONREAD, &queued) == -1) return static_cast<size_t>(m_pipeCapacity);
+    return queued < m_pipeCapacity ? static_cast<size_t>(m_pipeCapacity - queued) : 0;
+}
+
+/**
+ * FLUSH
+ * One write() per batch. Drops (never blocks) when Kotlin is not keeping up.
+ */
+bool BatchWriter::flush() {
+    size_t headerBytes = m_framed ? sizeof(BatchHeader) : 0;
+    if (m_records == 0 || m_fd < 0) return !m_failed;
+
+    size_t len = m_buf.size();
+    if (m_framed) {
+        BatchHeader bh{BATCH_MAGIC, BATCH_VERSION, m_ascii ? BATCH_FLAG_ASCII : uint16_t{0}, m_records,
+                       static_cast<uint32_t>(len - sizeof(BatchHeader))};
+        memcpy(m_buf.data(), &bh, sizeof(bh));
+    }
+
+    size_t free = pipeFreeSpace();
+    size_t toWrite = len;
+    if (unlikely(free < len)) {
+        if (m_framed) {
+            toWrite = 0; // Whole frame or nothing: a partial frame would desync the reader
+        } else {
+            // Cut at the last complete line that fits
+            const void *nl = free ? memrchr(m_buf.data(), '\n', free) : nullptr;
+            toWrite = nl ? static_cast<size_t>(static_cast<const char *>(nl) - m_buf.data()) + 1 : 0;
+        }
+        m_droppedBytes.fetch_add(len - toWrite, std::memory_order_relaxed);
+        m_droppedRecords.fetch_add(recordsPast(toWrite), std::memory_order_relaxed);
+    }
+
+    size_t total = 0;
+    while (total < toWrite) {
+        ssize_t s = write(m_fd, m_buf.data() + total, toWrite - total);
+        if (unlikely(s <= 0)) {
+            if (s < 0 && errno == EINTR) continue;
+            if (s < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // Cannot happen with a single writer, but never block the engine if it does
+                m_droppedBytes.fetch_add(toWrite - total, std::memory_order_relaxed);
+                m_droppedRecords.fetch_add(recordsPast(total) - recordsPast(toWrite), std::memory_order_relaxed);
+                break;
+            }
+            __android_log_print(ANDROID_LOG_WARN, TAG, "flush(): write() severe error: %s", strerror(errno));
+            m_failed = true;
+            break;
+        }
+        total += static_cast<size_t>(s);
+    }
+
+    m_records = 0;
+    m_textEnds.clear();
+    m_ascii = true;
+    m_buf.resize(headerBytes);
+    return !m_failed;
+}
+
+/**
+ * @return the records not complete within the first `written` bytes of the batch; a frame
+ * is only useful whole.
+ */
+uint32_t BatchWriter::recordsPast(size_t written) const {
+    if (m_framed) return written < m_buf.size() ? m_records : 0;
+    return static_cast<uint32_t>(m_textEnds.end() - std::upper_bound(m_textEnds.begin(), m_textEnds.end(), written));
+}
@@ -0,0 +1,181 @@
+#ifndef BATCH_WRITER_HPP
+#define BATCH_WRITER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * FRAMED DELIVERY FORMAT (little-endian, mirrored by LogManager.kt)
+ *
+ *   BatchHeader
+ *   recordCount x {
+ *       RecordHeader,
+ *       spanCount x MatchSpan,
+ *       [FieldBlockHeader, count x { FieldEntryHeader, size bytes }]  if RECORD_FLAG_HAS_FIELDS
+ *       length bytes of UTF-8 text
+ *   }
+ *
+ * Record text carries no trailing '\n'; multi-line events keep their inner newlines.
+ * Text is always valid UTF-8 (repaired by the engine); BATCH_FLAG_ASCII in the batch
+ * header means every record text of the batch is plain ASCII.
+ * Span offsets are byte offsets into the record text.
+ * A frame (header included) never exceeds BATCH_MAX_FRAME_BYTES; a record too large for
+ * one frame has its text cut (RECORD_FLAG_TEXT_TRUNCATED) and its spans clipped. Field payloads are int64, double
+ * or raw UTF-8 depending on FieldEntryHeader::type (see FieldType).
+ */
+static constexpr uint32_t BATCH_MAGIC = 0x3142434C; // "LCB1"
+static constexpr uint16_t BATCH_VERSION = 1;
+static constexpr size_t BATCH_MAX_FRAME_BYTES = 64 * 1024;        // Mirrored by LogManager.kt
+static constexpr size_t BATCH_MIN_PIPE_BYTES = 2 * BATCH_MAX_FRAME_BYTES; // Smallest pipe holding full-size frames
+
+static constexpr uint16_t BATCH_FLAG_ASCII = 1 << 0;            // All record texts are ASCII (Latin-1 decodable)
+
+static constexpr uint16_t RECORD_FLAG_SPANS_TRUNCATED = 1 << 0; // More matches than spans sent
+static constexpr uint16_t RECORD_FLAG_HAS_FIELDS = 1 << 1;      // A field block follows the spans
+static constexpr uint16_t RECORD_FLAG_FIELDS_ONLY = 1 << 2;     // Text omitted: only extraction rules matched
+static constexpr uint16_t RECORD_FLAG_TEXT_TRUNCATED = 1 << 3;  // Text cut to fit a single frame
+static constexpr uint16_t RECORD_BUFFER_SHIFT = 12;             // Flags bits 12-15: logd buffer id (LogBuffer)
+static constexpr uint16_t RECORD_BUFFER_MASK = 0xF000;
+
+struct BatchHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint32_t recordCount;
+    uint32_t payloadBytes;   // Bytes following this header
+};
+
+struct RecordHeader {
+    uint32_t length;
+    uint16_t spanCount;
+    uint16_t flags;
+};
+
+struct MatchSpan {
+    uint32_t start;
+    uint32_t end;            // Exclusive
+};
+
+struct FieldBlockHeader {
+    uint16_t count;
+    uint16_t reserved;
+    uint32_t bytes;          // Size of the entries following this header
+};
+
+struct FieldEntryHeader {
+    uint8_t type;
+    uint8_t rule;
+    uint8_t field;
+    uint8_t reserved;
+    uint32_t size;           // Payload bytes
+};
+
+static_assert(sizeof(BatchHeader) == 16, "BatchHeader layout is part of the wire format");
+static_assert(sizeof(RecordHeader) == 8, "RecordHeader layout is part of the wire format");
+static_assert(sizeof(MatchSpan) == 8, "MatchSpan layout is part of the wire format");
+static_assert(sizeof(FieldBlockHeader) == 8, "FieldBlockHeader layout is part of the wire format");
+static_assert(sizeof(FieldEntryHeader) == 8, "FieldEntryHeader layout is part of the wire format");
+
+struct FieldValue;
+
+/**
+ * BatchWriter: accumulates delivered events for one read batch and hands them to the
+ * Kotlin pipe with a single write.
+ *
+ * Backpressure: before writing, the free pipe space is measured (capacity - FIONREAD).
+ * As the engine is the only writer, free space can only grow during the write, so:
+ *   - text mode writes the longest prefix ending on a '\n' that fits;
+ *   - framed mode writes the whole batch or drops it, never a partial frame.
+ * Frames are therefore kept to half the pipe capacity (at most BATCH_MAX_FRAME_BYTES):
+ * a batch is flushed before the record that would push it past that limit, so a frame
+ * always fits a drained pipe, even when F_SETPIPE_SZ was refused.
+ */
+class BatchWriter {
+public:
+    /**
+     * Binds the writer to the Kotlin pipe for a capture session.
+     */
+    void reset(int fd, bool framed);
+
+    bool framed() const { return m_framed; }
+
+    /**
+     * Text mode: appends an event including its terminating '\n'.
+     * @return false if an early flush hit a severe pipe error.
+     */
+    bool appendText(std::string_view event);
+
+    /**
+     * Text mode: `render(std::string &batch)` appends one event, including its terminating
+     * '\n', straight into the batch (reformatted output without a staging copy).
+     * @return false if an early flush hit a severe pipe error.
+     */
+    template<typename Render>
+    bool appendTextWith(Render &&render) {
+        render(m_buf);
+        m_records++;
+        m_textEnds.push_back(static_cast<uint32_t>(m_buf.size()));
+        return flushIfLarge();
+    }
+
+    /**
+     * Framed mode: appends one record with its match spans and extracted fields.
+     * @return false if an early flush hit a severe pipe error.
+     */
+    bool appendRecord(std::string_view text, const MatchSpan* spans, uint16_t spanCount, uint16_t flags,
+                      const FieldValue* fields = nullptr, size_t fieldCount = 0);
+
+    /**
+     * Writes the pending batch to the pipe.
+     * @return false on a severe pipe error (reader gone).
+     */
+    bool flush();
+
+    /**
+     * Resizes the kernel pipe buffer (memory budget).
+     * @return the capacity actually granted by the kernel.
+     */
+    int resizePipe(int bytes);
+
+    int pipeCapacity() const { return m_pipeCapacity; }
+
+    /**
+     * Sets the kernel buffer of pipe `fd`, clamped to /proc/sys/fs/pipe-max-size (the
+     * ceiling for unprivileged processes).
+     * @return the capacity actually granted, or -1 if it cannot be queried.
+     */
+    static int setPipeSize(int fd, int bytes);
+
+    /**
+     * /proc/sys/fs/pipe-max-size, read once (1MB, the kernel default, if unreadable).
+     */
+    static int pipeMaxSize();
+
+    uint64_t droppedBytes() const { return m_droppedBytes.load(std::memory_order_relaxed); }
+    uint64_t droppedRecords() const { return m_droppedRecords.load(std::memory_order_relaxed); }
+
+private:
+    size_t pipeFreeSpace() const;
+    size_t frameLimit() const;
+    bool flushIfLarge();
+    uint32_t recordsPast(size_t written) const;
+
+    std::string m_buf;
+    uint32_t m_records = 0;
+    std::vector<uint32_t> m_textEnds; // Text mode: end offset of each pending record
+    int m_fd = -1;
+    int m_pipeCapacity = 0;
+    bool m_framed = false;
+    bool m_failed = false;       // Sticky severe error, reported by the next flush()
+    bool m_ascii = true;         // No non-ASCII record text in the pending batch
+
+    // Written by the worker only, read by stats queries
+    std::atomic<uint64_t> m_droppedBytes{0};
+    std::atomic<uint64_t> m_droppedRecords{0};
+};
+
+#endif // BATCH_WRITER_HPP
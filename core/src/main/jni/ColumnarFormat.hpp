@@ -0,0 +1,95 @@
+#ifndef COLUMNAR_FORMAT_HPP
+#define COLUMNAR_FORMAT_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * LOGCOL: columnar log export format (little-endian).
+ *
+ * Shared verbatim by the native writer (ColumnarWriter) and the host-side reader
+ * (tools/logcol), so it must stay free of Android and JNI dependencies.
+ *
+ *   FileHeader
+ *   Block*  where Block = BlockHeader followed by, in this order:
+ *     dict     newTags x { varint length, bytes }   tags first used in this block,
+ *                                                   ids continue the file-wide dictionary
+ *     ts       recordCount x zigzag varint          delta vs previous record (first: vs firstTsNs)
+ *     level    recordCount x uint8                  'V','D','I','W','E','F' or 0
+ *     pid      recordCount x zigzag varint          delta vs previous record
+ *     tid      recordCount x zigzag varint          tid - pid (0 when the format has no tid)
+ *     tag      recordCount x varint                 dictionary id
+ *     msgLen   recordCount x varint                 message byte length
+ *     msg      zlib stream of all messages concatenated (msgRawBytes once inflated)
+ */
+namespace logcol {
+
+static constexpr uint32_t FILE_MAGIC = 0x4C4F434C;  // "LCOL"
+static constexpr uint32_t BLOCK_MAGIC = 0x4B4C424C; // "LBLK"
+static constexpr uint16_t FORMAT_VERSION = 1;
+
+struct FileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    int64_t createdNs;
+};
+
+struct BlockHeader {
+    uint32_t magic;
+    uint32_t recordCount;
+    uint32_t newTags;
+    uint32_t dictBytes;
+    uint32_t tsBytes;
+    uint32_t levelBytes;
+    uint32_t pidBytes;
+    uint32_t tidBytes;
+    uint32_t tagBytes;
+    uint32_t msgLenBytes;
+    uint32_t msgRawBytes;
+    uint32_t msgCompressedBytes;
+    int64_t firstTsNs;
+};
+
+static_assert(sizeof(FileHeader) == 16, "FileHeader layout is part of the file format");
+static_assert(sizeof(BlockHeader) == 56, "BlockHeader layout is part of the file format");
+
+// --- VARINT HELPERS (LEB128, zigzag for signed deltas) ---
+
+inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+/**
+ * Writes `v` at `out` (at least 10 bytes available). @return bytes written.
+ */
+inline size_t putVarint(uint8_t* out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = static_cast<uint8_t>(v) | 0x80;
+        v >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(v);
+    return n;
+}
+
+/**
+ * Reads a varint from [p, end). @return the position after it, or nullptr if truncated.
+ */
+inline const uint8_t* getVarint(const uint8_t* p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t b = *p++;
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return p;
+    }
+    return nullptr;
+}
+
+} // namespace logcol
+
+#endif // COLUMNAR_FORMAT_HPP
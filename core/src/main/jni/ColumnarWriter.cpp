@@ -0,0 +1,270 @@
+#include "ColumnarWriter.hpp"
+#include "TriggerCapture.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <ctime>
+#include <cstring>
+#include <cerrno>
+#include <zlib.h>
+#include <android/log.h>
+
+#define TAG "LogcatEngine-Export"
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * BLOCK LIMITS: ~8K records / 1MB of text compress well while keeping a block small
+ * enough that a reader can decode it in about a millisecond. The byte limit is the
+ * default; the memory budget may lower it.
+ */
+static constexpr uint32_t BLOCK_RECORDS = 8192;
+static constexpr size_t BLOCK_MESSAGE_BYTES = 1024 * 1024;
+static constexpr uint64_t BLOCK_MAX_AGE_MS = 5000;
+
+static inline void appendVarint(std::vector<uint8_t> &col, uint64_t v) {
+    size_t at = col.size();
+    col.resize(at + 10);
+    col.resize(at + logcol::putVarint(col.data() + at, v));
+}
+
+ColumnarWriter::ColumnarWriter() : m_blockBytes(BLOCK_MESSAGE_BYTES) {}
+
+ColumnarWriter::~ColumnarWriter() {
+    closeFile();
+}
+
+void ColumnarWriter::start(const std::string &path) {
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    m_requestPath = path;
+    m_requestDirty.store(true, std::memory_order_release);
+}
+
+void ColumnarWriter::stop() {
+    start(std::string());
+}
+
+void ColumnarWriter::applyRequest() {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        path = m_requestPath;
+        m_requestDirty.store(false, std::memory_order_relaxed);
+    }
+    closeFile();
+    if (!path.empty()) openFile(path);
+}
+
+bool ColumnarWriter::openFile(const std::string &path) {
+    m_fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+    if (unlikely(m_fd < 0)) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "openFile(): open(%s) failed: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    struct timespec now{};
+    clock_gettime(CLOCK_REALTIME, &now);
+    logcol::FileHeader fh{logcol::FILE_MAGIC, logcol::FORMAT_VERSION, 0,
+                          static_cast<int64_t>(now.tv_sec) * 1000000000LL + now.tv_nsec};
+    if (write(m_fd, &fh, sizeof(fh)) != static_cast<ssize_t>(sizeof(fh))) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "openFile(): header write failed: %s", strerror(errno));
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    // Dictionary entries left pending by a dropped block belong to the previous file
+    m_fileTagIds.clear();
+    m_fileTagCount = 0;
+    m_dictCol.clear();
+    m_blockNewTags = 0;
+    m_fileBytes = sizeof(fh);
+    m_blockRecords = 0;
+    m_recordsWritten.store(0, std::memory_order_relaxed);
+    __android_log_print(ANDROID_LOG_INFO, TAG, "Exporting to %s", path.c_str());
+    return true;
+}
+
+void ColumnarWriter::closeFile() {
+    if (m_fd < 0) return;
+    writeBlock();
+    if (m_fd >= 0) { // writeBlock() closes a file it could not repair
+        fdatasync(m_fd);
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_dictCol.clear();
+    m_blockNewTags = 0;
+}
+
+/**
+ * TAG DICTIONARY
+ * The engine already interned the tag, so the file id is one array index away; the name
+ * is only copied the first time a tag appears in this file.
+ */
+uint32_t ColumnarWriter::fileTagId(const LogRecord &rec) {
+    if (unlikely(rec.tagId >= m_fileTagIds.size())) m_fileTagIds.resize(rec.tagId + 1u, 0);
+    uint32_t &slot = m_fileTagIds[rec.tagId];
+    if (likely(slot != 0)) return slot - 1;
+
+    std::string_view tag = rec.tagId == TagTable::OVERFLOW_TAG ? std::string_view("(overflow)") :
+                           rec.valid() ? rec.tag : std::string_view();
+    appendVarint(m_dictCol, tag.size());
+    m_dictCol.insert(m_dictCol.end(), tag.begin(), tag.end());
+    m_blockNewTags++;
+    slot = ++m_fileTagCount;
+    return slot - 1;
+}
+
+/**
+ * ON RECORD (HOT PATH)
+ * Appends the record to each column; all encodings are a handful of byte stores.
+ */
+void ColumnarWriter::onRecord(const LogRecord &rec, std::string_view rawLine) {
+    if (unlikely(m_requestDirty.load(std::memory_order_acquire))) applyRequest();
+    if (likely(m_fd < 0)) return;
+
+    int64_t ts = rec.timeNs ? rec.timeNs : (rec.valid() ? timeFormatToNs(rec.timestamp) : 0);
+    if (ts == 0) ts = m_prevTs; // Headerless lines inherit the previous timestamp
+
+    if (m_blockRecords == 0) {
+        m_blockFirstTs = ts;
+        m_prevTs = ts;
+        m_prevPid = 0;
+        m_blockStartMs = TriggerCapture::monotonicMs();
+    }
+
+    std::string_view msg = rec.valid() ? rec.message : rawLine;
+    appendVarint(m_tsCol, logcol::zigzag(ts - m_prevTs));
+    m_levelCol.push_back(static_cast<uint8_t>(rec.level));
+    appendVarint(m_pidCol, logcol::zigzag(static_cast<int64_t>(rec.pid) - m_prevPid));
+    appendVarint(m_tidCol, logcol::zigzag(rec.tid >= 0 ? static_cast<int64_t>(rec.tid) - rec.pid : 0));
+    appendVarint(m_tagCol, fileTagId(rec));
+    appendVarint(m_msgLenCol, msg.size());
+    m_msgCol.insert(m_msgCol.end(), msg.begin(), msg.end());
+
+    m_prevTs = ts;
+    m_prevPid = rec.pid;
+    m_blockRecords++;
+
+    if (m_blockRecords >= BLOCK_RECORDS || m_msgCol.size() >= m_blockBytes) writeBlock();
+}
+
+void ColumnarWriter::tick(uint64_t nowMs) {
+    if (unlikely(m_requestDirty.load(std::memory_order_acquire))) applyRequest();
+    if (m_fd >= 0 && m_blockRecords && nowMs - m_blockStartMs >= BLOCK_MAX_AGE_MS) writeBlock();
+}
+
+void ColumnarWriter::finish() {
+    closeFile();
+}
+
+/**
+ * WRITE BLOCK
+ * Compresses the message column and writes header + columns with a single writev().
+ * The reader stops at the first incomplete block, so a failed or short write (ENOSPC)
+ * is cut off again: the block is dropped, its new tags stay pending and later blocks
+ * still land in a readable file. If the cut fails too, the export is closed.
+ */
+void ColumnarWriter::writeBlock() {
+    if (m_fd < 0 || m_blockRecords == 0) return;
+
+    uLongf compressedLen = compressBound(static_cast<uLong>(m_msgCol.size()));
+    m_compressed.resize(compressedLen);
+    if (compress2(m_compressed.data(), &compressedLen, reinterpret_cast<const Bytef *>(m_msgCol.data()),
+                  static_cast<uLong>(m_msgCol.size()), Z_BEST_SPEED) != Z_OK) {
+        __android_log_print(ANDROID_LOG_WARN, TAG, "writeBlock(): compress2 failed, block dropped");
+        compressedLen = 0;
+    }
+    bool written = compressedLen > 0;
+
+    logcol::BlockHeader bh{};
+    bh.magic = logcol::BLOCK_MAGIC;
+    bh.recordCount = m_blockRecords;
+    bh.newTags = m_blockNewTags;
+    bh.dictBytes = static_cast<uint32_t>(m_dictCol.size());
+    bh.tsBytes = static_cast<uint32_t>(m_tsCol.size());
+    bh.levelBytes = static_cast<uint32_t>(m_levelCol.size());
+    bh.pidBytes = static_cast<uint32_t>(m_pidCol.size());
+    bh.tidBytes = static_cast<uint32_t>(m_tidCol.size());
+    bh.tagBytes = static_cast<uint32_t>(m_tagCol.size());
+    bh.msgLenBytes = static_cast<uint32_t>(m_msgLenCol.size());
+    bh.msgRawBytes = static_cast<uint32_t>(m_msgCol.size());
+    bh.msgCompressedBytes = static_cast<uint32_t>(compressedLen);
+    bh.firstTsNs = m_blockFirstTs;
+
+    if (written) {
+        struct iovec iov[] = {
+                {&bh,                   sizeof(bh)},
+                {m_dictCol.data(),      m_dictCol.size()},
+                {m_tsCol.data(),        m_tsCol.size()},
+                {m_levelCol.data(),     m_levelCol.size()},
+                {m_pidCol.data(),       m_pidCol.size()},
+                {m_tidCol.data(),       m_tidCol.size()},
+                {m_tagCol.data(),       m_tagCol.size()},
+                {m_msgLenCol.data(),    m_msgLenCol.size()},
+                {m_compressed.data(),   compressedLen},
+        };
+        size_t total = 0;
+        for (const auto &v: iov) total += v.iov_len;
+
+        ssize_t w;
+        do {
+            w = writev(m_fd, iov, sizeof(iov) / sizeof(iov[0]));
+        } while (w < 0 && errno == EINTR);
+        if (likely(w == static_cast<ssize_t>(total))) {
+            m_fileBytes += static_cast<off_t>(total);
+            m_recordsWritten.fetch_add(m_blockRecords, std::memory_order_relaxed);
+        } else {
+            __android_log_print(ANDROID_LOG_ERROR, TAG, "writeBlock(): writev wrote %zd of %zu bytes: %s, block dropped",
+                                w, total, w < 0 ? strerror(errno) : "short write");
+            written = false;
+            if (ftruncate(m_fd, m_fileBytes) != 0 || lseek(m_fd, m_fileBytes, SEEK_SET) != m_fileBytes) {
+                __android_log_print(ANDROID_LOG_ERROR, TAG,
+                                    "writeBlock(): cannot cut the partial block: %s, export closed", strerror(errno));
+                close(m_fd);
+                m_fd = -1;
+            }
+        }
+    }
+
+    if (written) {
+        // A dropped block keeps its new tags pending, so dictionary ids stay in sync for the reader
+        m_dictCol.clear();
+        m_blockNewTags = 0;
+    }
+    m_tsCol.clear();
+    m_levelCol.clear();
+    m_pidCol.clear();
+    m_tidCol.clear();
+    m_tagCol.clear();
+    m_msgLenCol.clear();
+    m_msgCol.clear();
+    m_blockRecords = 0;
+}
+
+/**
+ * SET BLOCK BYTES
+ * A lower limit closes the current block early and releases column capacity grown by
+ * the previous limit.
+ */
+void ColumnarWriter::setBlockBytes(size_t bytes) {
+    m_blockBytes = bytes;
+    if (m_msgCol.size() >= bytes) writeBlock();
+    if (m_msgCol.capacity() > bytes * 2) {
+        for (auto *col: {&m_tsCol, &m_levelCol, &m_pidCol, &m_tidCol, &m_tagCol, &m_msgLenCol, &m_compressed}) {
+            col->shrink_to_fit();
+        }
+        m_msgCol.shrink_to_fit();
+    }
+}
+
+size_t ColumnarWriter::memoryUsage() const {
+    size_t total = m_msgCol.capacity();
+    for (const auto *col: {&m_dictCol, &m_tsCol, &m_levelCol, &m_pidCol, &m_tidCol, &m_tagCol, &m_msgLenCol,
+                           &m_compressed}) {
+        total += col->capacity();
+    }
+    return total;
+}
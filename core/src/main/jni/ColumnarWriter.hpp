@@ -0,0 +1,107 @@
+#ifndef COLUMNAR_WRITER_HPP
+#define COLUMNAR_WRITER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <sys/types.h>
+#include "ColumnarFormat.hpp"
+#include "LogParser.hpp"
+#include "TagTable.hpp"
+
+/**
+ * ColumnarWriter: exports the live stream into a LOGCOL file (see ColumnarFormat.hpp).
+ *
+ * Records are buffered column by column and written as one block every BLOCK_RECORDS
+ * records, blockBytes() of message text or BLOCK_MAX_AGE_MS, whichever comes first.
+ * Only the message column is compressed (zlib, fastest level); the numeric columns are
+ * already a byte or two per record once delta/varint encoded.
+ *
+ * Threading: onRecord()/tick()/finish() run on the engine worker thread; start()/stop()
+ * may be called from any thread and are applied on the next record or tick.
+ */
+class ColumnarWriter {
+public:
+    ColumnarWriter();
+    ~ColumnarWriter();
+
+    /**
+     * Requests a new export into `path` (an export in progress is closed first).
+     */
+    void start(const std::string& path);
+
+    /**
+     * Requests the current export to be flushed and closed.
+     */
+    void stop();
+
+    /**
+     * @return true if records should be parsed and passed to onRecord(). Worker thread only.
+     */
+    bool wantsRecords() const { return m_fd >= 0 || m_requestDirty.load(std::memory_order_relaxed); }
+
+    /**
+     * Appends one parsed record with its interned tag id (invalid records are stored as level 0 / empty tag).
+     */
+    void onRecord(const LogRecord& rec, std::string_view rawLine);
+
+    /**
+     * Writes the current block once it is older than BLOCK_MAX_AGE_MS.
+     */
+    void tick(uint64_t nowMs);
+
+    /**
+     * Flushes and closes the file (engine shutdown).
+     */
+    void finish();
+
+    /**
+     * Message bytes per block (memory budget). Worker thread only.
+     */
+    void setBlockBytes(size_t bytes);
+    size_t blockBytes() const { return m_blockBytes; }
+
+    /**
+     * Bytes held by the column buffers.
+     */
+    size_t memoryUsage() const;
+
+    uint64_t recordsWritten() const { return m_recordsWritten.load(std::memory_order_relaxed); }
+
+private:
+    void applyRequest();
+    bool openFile(const std::string& path);
+    void closeFile();
+    void writeBlock();
+    uint32_t fileTagId(const LogRecord& rec);
+
+    // --- REQUEST HANDOVER (JNI threads -> worker) ---
+    std::mutex m_requestMutex;
+    std::string m_requestPath;           // Empty = stop
+    std::atomic<bool> m_requestDirty{false};
+
+    // --- FILE STATE (worker thread only) ---
+    int m_fd = -1;
+    off_t m_fileBytes = 0;               // End of the last complete block
+    std::vector<uint32_t> m_fileTagIds;  // Interned tag id -> file dictionary id + 1 (0 = not in file yet)
+    uint32_t m_fileTagCount = 0;
+
+    // --- CURRENT BLOCK ---
+    std::vector<uint8_t> m_dictCol, m_tsCol, m_levelCol, m_pidCol, m_tidCol, m_tagCol, m_msgLenCol;
+    std::vector<char> m_msgCol;
+    std::vector<uint8_t> m_compressed;
+    uint32_t m_blockRecords = 0;
+    uint32_t m_blockNewTags = 0;
+    int64_t m_blockFirstTs = 0;
+    int64_t m_prevTs = 0;
+    int32_t m_prevPid = 0;
+    uint64_t m_blockStartMs = 0;
+    size_t m_blockBytes;
+
+    std::atomic<uint64_t> m_recordsWritten{0};
+};
+
+#endif // COLUMNAR_WRITER_HPP
@@ -0,0 +1,88 @@
+#include "EventAssembler.hpp"
+#include <cstring>
+
+/**
+ * EVENT BOUNDS: a deep Java trace with "Caused by" chains is ~200 lines / 20KB.
+ * Anything larger is emitted in several chunks rather than buffered without limit.
+ * MAX_EVENT_BYTES is the default; the memory budget may lower it.
+ */
+static constexpr size_t MAX_EVENT_BYTES = 64 * 1024;
+static constexpr uint32_t MAX_EVENT_LINES = 512;
+
+/**
+ * Message prefixes that only ever appear as the continuation of a previous line.
+ */
+static constexpr std::string_view CONTINUATION_PREFIXES[] = {
+        "\tat ",
+        "\t... ",
+        "Caused by: ",
+        "Suppressed: ",
+        "backtrace:",
+        "stack:",
+};
+
+EventAssembler::EventAssembler() : m_maxBytes(MAX_EVENT_BYTES) {
+    m_buffer.reserve(4096);
+}
+
+void EventAssembler::setMaxBytes(size_t bytes) {
+    m_maxBytes = bytes;
+    // Give back a buffer grown by an earlier, larger bound (pending text is kept)
+    if (m_buffer.capacity() > bytes * 2) m_buffer.shrink_to_fit();
+}
+
+bool EventAssembler::looksLikeContinuation(std::string_view message) {
+    if (message.empty()) return false;
+    // Indented lines: stack frames ("\tat", "    #00 pc ...") and wrapped message bodies
+    if (message[0] == '\t' || message[0] == ' ') return true;
+    for (auto prefix: CONTINUATION_PREFIXES) {
+        if (message.size() >= prefix.size() && memcmp(message.data(), prefix.data(), prefix.size()) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EventAssembler::continues(const LogRecord &rec, uint64_t nowMs) const {
+    if (m_buffer.empty() || !rec.valid() || expired(nowMs)) return false;
+    if (rec.pid != m_pid || rec.level != m_level || rec.tagId != m_tagId || rec.bufferId != m_bufferId) return false;
+
+    // At millisecond precision, a loop logging "item 1", "item 2" shares timestamps too
+    bool sameEntry = m_exactTimestamps && rec.tid >= 0 && rec.tid == m_tid && rec.timeNs == m_timeNs;
+    return sameEntry || looksLikeContinuation(rec.message);
+}
+
+void EventAssembler::append(std::string_view line, const LogRecord &rec, uint64_t nowMs) {
+    if (m_buffer.empty()) {
+        m_pid = rec.pid;
+        m_tid = rec.tid;
+        m_level = rec.level;
+        m_tagId = rec.tagId;
+        m_bufferId = rec.bufferId;
+    }
+    if (rec.valid()) m_timeNs = rec.timeNs;
+
+    m_buffer.append(line.data(), line.size());
+    m_buffer.push_back('\n');
+    m_lines++;
+    m_lastMs = nowMs;
+}
+
+bool EventAssembler::full() const {
+    return m_buffer.size() >= m_maxBytes || m_lines >= MAX_EVENT_LINES;
+}
+
+int EventAssembler::msUntilExpiry(uint64_t nowMs) const {
+    uint64_t deadline = m_lastMs + m_windowMs;
+    return deadline > nowMs ? static_cast<int>(deadline - nowMs) : 0;
+}
+
+void EventAssembler::clear() {
+    m_buffer.clear();
+    m_tagId = 0;
+    m_bufferId = 0;
+    m_pid = -1;
+    m_tid = -1;
+    m_level = 0;
+    m_lines = 0;
+}
@@ -0,0 +1,95 @@
+#ifndef EVENT_ASSEMBLER_HPP
+#define EVENT_ASSEMBLER_HPP
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include "LogParser.hpp"
+
+/**
+ * EventAssembler: groups continuation lines (Java stack traces, tombstone frames,
+ * multi-line messages) into one logical event so filters see the whole event.
+ *
+ * A line continues the pending event when it comes from the same pid/tag id/level within
+ * the time window and looks like a continuation ("\tat ", "Caused by: ", indented
+ * frames, ...). An identical timestamp also joins lines (liblog splits one multi-line
+ * message into entries sharing it), but only when that cannot merge separate log calls:
+ * the format must print the thread id and sub-millisecond time (e.g. "threadtime,usec").
+ *
+ * Worker-thread only; the pending buffer is bounded by maxBytes() / MAX_EVENT_LINES.
+ */
+class EventAssembler {
+public:
+    EventAssembler();
+
+    /**
+     * @return true if `rec` (arriving at nowMs) belongs to the pending event.
+     */
+    bool continues(const LogRecord& rec, uint64_t nowMs) const;
+
+    /**
+     * Starts a new event or appends `line` to the pending one.
+     */
+    void append(std::string_view line, const LogRecord& rec, uint64_t nowMs);
+
+    /**
+     * Pending event text: lines joined and terminated by '\n'.
+     */
+    std::string_view pending() const { return m_buffer; }
+
+    bool hasPending() const { return !m_buffer.empty(); }
+
+    /**
+     * @return true once the event reached its line/byte bound and must be emitted.
+     */
+    bool full() const;
+
+    /**
+     * @return true if no continuation can arrive any more (window elapsed).
+     */
+    bool expired(uint64_t nowMs) const { return nowMs >= m_lastMs + m_windowMs; }
+
+    /**
+     * Milliseconds until the pending event expires; used to shorten the epoll timeout.
+     */
+    int msUntilExpiry(uint64_t nowMs) const;
+
+    void clear();
+
+    static bool looksLikeContinuation(std::string_view message);
+
+    /**
+     * Byte bound of one event (memory budget); larger events are emitted in chunks.
+     */
+    void setMaxBytes(size_t bytes);
+    size_t memoryUsage() const { return m_buffer.capacity(); }
+
+    /**
+     * Buffer of the pending event (all its lines come from one buffer).
+     */
+    uint8_t bufferId() const { return m_bufferId; }
+
+    /**
+     * Enables the same-timestamp rule; only for formats with a tid and usec/nsec stamps.
+     */
+    void setExactTimestamps(bool exact) { m_exactTimestamps = exact; }
+
+    uint32_t windowMs() const { return m_windowMs; }
+    void setWindowMs(uint32_t windowMs) { m_windowMs = windowMs; }
+
+private:
+    std::string m_buffer;     // Joined event text
+    uint16_t m_tagId = 0;     // Key of the pending event (interned tag)
+    int64_t m_timeNs = 0;          // Timestamp of the last line (lines of one entry share it)
+    int32_t m_pid = -1;
+    int32_t m_tid = -1;
+    char m_level = 0;
+    uint8_t m_bufferId = 0;
+    uint32_t m_lines = 0;
+    uint64_t m_lastMs = 0;
+    uint32_t m_windowMs = 0;
+    size_t m_maxBytes;
+    bool m_exactTimestamps = false;
+};
+
+#endif // EVENT_ASSEMBLER_HPP
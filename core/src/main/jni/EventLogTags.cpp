@@ -0,0 +1,145 @@
+#include "EventLogTags.hpp"
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+/**
+ * EVENT PAYLOAD TYPES (liblog's AndroidEventLogType).
+ */
+enum : uint8_t {
+    EVENT_TYPE_INT = 0,
+    EVENT_TYPE_LONG = 1,
+    EVENT_TYPE_STRING = 2,
+    EVENT_TYPE_LIST = 3,
+    EVENT_TYPE_FLOAT = 4,
+};
+
+static constexpr int MAX_LIST_DEPTH = 8;
+
+const EventLogTags &EventLogTags::system() {
+    static const EventLogTags tags = [] {
+        EventLogTags t;
+        t.load(SYSTEM_PATH);
+        return t;
+    }();
+    return tags;
+}
+
+bool EventLogTags::load(const char *path) {
+    FILE *f = fopen(path, "re");
+    if (!f) return false;
+
+    m_names.clear();
+    m_entries.clear();
+    m_slots.assign(1024, 0);
+
+    char line[1024];
+    while (fgets(line, sizeof(line), f)) {
+        const char *p = line;
+        while (*p == ' ' || *p == '\t') ++p;
+        if (*p < '0' || *p > '9') continue; // Comments, option lines, blanks
+
+        char *end;
+        unsigned long tag = strtoul(p, &end, 10);
+        p = end;
+        while (*p == ' ' || *p == '\t') ++p;
+        const char *nameEnd = p;
+        while (*nameEnd && *nameEnd != ' ' && *nameEnd != '\t' && *nameEnd != '\n' && *nameEnd != '\r') ++nameEnd;
+        if (nameEnd > p) insert(static_cast<uint32_t>(tag), std::string_view(p, static_cast<size_t>(nameEnd - p)));
+    }
+    fclose(f);
+    m_names.shrink_to_fit();
+    m_entries.shrink_to_fit();
+    return true;
+}
+
+size_t EventLogTags::slotOf(uint32_t tag) const {
+    return (tag * 0x9E3779B1u) & (m_slots.size() - 1);
+}
+
+void EventLogTags::insert(uint32_t tag, std::string_view name) {
+    // Keep the load factor at or below 1/2
+    if ((m_entries.size() + 1) * 2 > m_slots.size()) {
+        std::vector<uint32_t> old;
+        old.swap(m_slots);
+        m_slots.assign(old.size() * 2, 0);
+        for (uint32_t index: old) {
+            if (!index) continue;
+            size_t s = slotOf(m_entries[index - 1].tag);
+            while (m_slots[s]) s = (s + 1) & (m_slots.size() - 1);
+            m_slots[s] = index;
+        }
+    }
+
+    size_t s = slotOf(tag);
+    while (m_slots[s]) {
+        if (m_entries[m_slots[s] - 1].tag == tag) return; // First definition wins
+        s = (s + 1) & (m_slots.size() - 1);
+    }
+    m_entries.push_back({tag, static_cast<uint32_t>(m_names.size()), static_cast<uint32_t>(name.size())});
+    m_names.append(name);
+    m_slots[s] = static_cast<uint32_t>(m_entries.size());
+}
+
+std::string_view EventLogTags::name(uint32_t tag) const {
+    if (m_slots.empty()) return {};
+    for (size_t s = slotOf(tag); m_slots[s]; s = (s + 1) & (m_slots.size() - 1)) {
+        const Entry &e = m_entries[m_slots[s] - 1];
+        if (e.tag == tag) return std::string_view(m_names.data() + e.nameOffset, e.nameLength);
+    }
+    return {};
+}
+
+template<typename T>
+static inline T readLE(const char *p) {
+    T v;
+    memcpy(&v, p, sizeof(v)); // Android is little-endian, as is the payload
+    return v;
+}
+
+static const char *renderValue(const char *p, const char *end, std::string &out, int depth) {
+    if (p >= end || depth > MAX_LIST_DEPTH) return nullptr;
+    char number[32];
+    switch (static_cast<uint8_t>(*p++)) {
+        case EVENT_TYPE_INT:
+            if (end - p < 4) return nullptr;
+            out.append(number, static_cast<size_t>(snprintf(number, sizeof(number), "%d", readLE<int32_t>(p))));
+            return p + 4;
+        case EVENT_TYPE_LONG:
+            if (end - p < 8) return nullptr;
+            out.append(number, static_cast<size_t>(snprintf(number, sizeof(number), "%lld",
+                                                            static_cast<long long>(readLE<int64_t>(p)))));
+            return p + 8;
+        case EVENT_TYPE_FLOAT:
+            if (end - p < 4) return nullptr;
+            out.append(number, static_cast<size_t>(snprintf(number, sizeof(number), "%f",
+                                                            static_cast<double>(readLE<float>(p)))));
+            return p + 4;
+        case EVENT_TYPE_STRING: {
+            if (end - p < 4) return nullptr;
+            auto length = readLE<uint32_t>(p);
+            p += 4;
+            if (static_cast<size_t>(end - p) < length) return nullptr;
+            out.append(p, length);
+            return p + length;
+        }
+        case EVENT_TYPE_LIST: {
+            if (p >= end) return nullptr;
+            auto count = static_cast<uint8_t>(*p++);
+            out.push_back('[');
+            for (uint8_t i = 0; i < count; ++i) {
+                if (i) out.push_back(',');
+                p = renderValue(p, end, out, depth + 1);
+                if (!p) return nullptr;
+            }
+            out.push_back(']');
+            return p;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+bool EventLogTags::render(const char *payload, size_t length, std::string &out) {
+    return renderValue(payload, payload + length, out, 0) != nullptr;
+}
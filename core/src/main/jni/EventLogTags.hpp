@@ -0,0 +1,61 @@
+#ifndef EVENT_LOG_TAGS_HPP
+#define EVENT_LOG_TAGS_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * EventLogTags: dictionary of the events buffer (`/system/etc/event-log-tags`), mapping
+ * binary tag numbers to names such as am_anr or am_proc_start.
+ *
+ * Stored compactly: all names in one string, entries in one vector, and an open-addressing
+ * table of entry indexes. Read-only after load(), so lookups need no locking.
+ */
+class EventLogTags {
+public:
+    static constexpr const char *SYSTEM_PATH = "/system/etc/event-log-tags";
+
+    /**
+     * Process-wide dictionary from SYSTEM_PATH, loaded on first use.
+     */
+    static const EventLogTags &system();
+
+    /**
+     * Parses a tags file ("<number> <name> [(<field>|<type>[|<unit>]),...]" per line).
+     * @return false if the file cannot be read.
+     */
+    bool load(const char *path);
+
+    size_t size() const { return m_entries.size(); }
+
+    /**
+     * @return the name of `tag`, or an empty view if it is not in the dictionary.
+     */
+    std::string_view name(uint32_t tag) const;
+
+    /**
+     * Renders an event payload (the typed value after the tag number) the way logcat does:
+     * lists as "[a,b,c]", scalars as-is.
+     * @return false if the payload is truncated or malformed.
+     */
+    static bool render(const char *payload, size_t length, std::string &out);
+
+private:
+    struct Entry {
+        uint32_t tag;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+    };
+
+    void insert(uint32_t tag, std::string_view name);
+    size_t slotOf(uint32_t tag) const;
+
+    std::string m_names;
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_slots; // Entry index + 1; 0 = empty. Power-of-two size.
+};
+
+#endif // EVENT_LOG_TAGS_HPP
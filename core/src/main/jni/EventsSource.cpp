@@ -0,0 +1,163 @@
+#include "EventsSource.hpp"
+#include "TriggerCapture.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <sys/wait.h>
+#include <android/log.h>
+
+#define TAG "LogcatEngine-Events"
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * BINARY ENTRY (liblog's struct logger_entry), as written by `logcat -B`:
+ *   uint16 len, uint16 hdr_size, int32 pid, uint32 tid, uint32 sec, uint32 nsec,
+ *   [uint32 lid, [uint32 uid]]  then `len` payload bytes.
+ * hdr_size 0 is the legacy 20-byte header. The events payload is an int32 tag number
+ * followed by one typed value (see EventLogTags::render).
+ */
+static constexpr size_t LEGACY_HEADER_SIZE = 20;
+static constexpr size_t MAX_HEADER_SIZE = 64;
+static constexpr size_t MAX_PAYLOAD_SIZE = 5 * 1024;
+static constexpr size_t EVENTS_READ_SIZE = 64 * 1024;
+static constexpr uint64_t RESPAWN_INTERVAL_MS = 1000;
+
+EventsSource::~EventsSource() {
+    uninstall();
+}
+
+bool EventsSource::install(const EventLogTags &tags, const std::string &pid, const std::string &level,
+                           const std::string &tagFilter) {
+    if (m_child > 0) return false;
+    m_tags = &tags;
+    m_pidArg = pid.empty() ? std::string() : "--pid=" + pid;
+    m_filter.configure(level, tagFilter);
+    if (!m_read) m_read = std::make_unique<char[]>(EVENTS_READ_SIZE);
+    return spawn();
+}
+
+void EventsSource::uninstall() {
+    stopChild();
+    m_accumulator.clear();
+}
+
+/**
+ * SPAWN
+ * argv is built before fork(): the child only calls async-signal-safe functions.
+ */
+bool EventsSource::spawn() {
+    int p[2];
+    if (pipe2(p, O_CLOEXEC) < 0) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "spawn(): pipe2() failed: %s", strerror(errno));
+        return false;
+    }
+    const char *argv[] = {"logcat", "-b", "events", "-B", m_pidArg.empty() ? nullptr : m_pidArg.c_str(), nullptr};
+
+    pid_t child = fork();
+    if (child == 0) {
+        dup2(p[1], STDOUT_FILENO); // dup2() clears O_CLOEXEC on the target
+        execv("/system/bin/logcat", const_cast<char *const *>(argv));
+        _exit(1);
+    }
+    close(p[1]);
+    if (child < 0) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "spawn(): fork() failed: %s", strerror(errno));
+        close(p[0]);
+        return false;
+    }
+
+    fcntl(p[0], F_SETFL, O_NONBLOCK);
+    m_child = child;
+    m_readFd = p[0];
+    m_spawnMs = TriggerCapture::monotonicMs();
+    m_accumulator.clear(); // A new logcat starts on an entry boundary
+    return true;
+}
+
+void EventsSource::stopChild() {
+    if (m_child > 0) {
+        kill(m_child, SIGTERM);
+        waitpid(m_child, nullptr, 0); // ECHILD when SIGCHLD is ignored: already reaped
+        m_child = -1;
+    }
+    if (m_readFd >= 0) {
+        close(m_readFd);
+        m_readFd = -1;
+    }
+}
+
+ssize_t EventsSource::drain(LineSink &sink) {
+    ssize_t bytes = read(m_readFd, m_read.get(), EVENTS_READ_SIZE);
+    if (unlikely(bytes <= 0)) {
+        if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+
+        // logcat went away: restart it, unless it keeps dying right after the start. The old
+        // fd is closed only after the new one exists, so its number cannot be reused.
+        int oldFd = m_readFd;
+        m_readFd = -1;
+        stopChild();
+        bool restarted = TriggerCapture::monotonicMs() - m_spawnMs >= RESPAWN_INTERVAL_MS && spawn();
+        close(oldFd);
+        if (!restarted) {
+            __android_log_print(ANDROID_LOG_WARN, TAG, "drain(): events logcat exited, giving up");
+            return -1;
+        }
+        return 0;
+    }
+
+    m_accumulator.append(m_read.get(), static_cast<size_t>(bytes));
+    size_t used = decode(m_accumulator.data(), m_accumulator.size(), sink);
+    m_accumulator.erase(0, used);
+    return bytes;
+}
+
+size_t EventsSource::decode(const char *data, size_t size, LineSink &sink) {
+    size_t pos = 0;
+    while (size - pos >= 4) {
+        const char *entry = data + pos;
+        uint16_t length, headerSize;
+        memcpy(&length, entry, 2);
+        memcpy(&headerSize, entry + 2, 2);
+        if (headerSize == 0) headerSize = LEGACY_HEADER_SIZE;
+        if (unlikely(headerSize < LEGACY_HEADER_SIZE || headerSize > MAX_HEADER_SIZE || length > MAX_PAYLOAD_SIZE)) {
+            __android_log_print(ANDROID_LOG_WARN, TAG, "decode(): corrupt entry, %zu bytes skipped", size - pos);
+            return size; // Resynchronizing inside a binary stream is guesswork: drop the rest
+        }
+        if (size - pos < static_cast<size_t>(headerSize) + length) break;
+        pos += static_cast<size_t>(headerSize) + length;
+        if (length < 4) continue;
+
+        int32_t pid;
+        uint32_t tid, sec, nsec, tagNumber;
+        memcpy(&pid, entry + 4, 4);
+        memcpy(&tid, entry + 8, 4);
+        memcpy(&sec, entry + 12, 4);
+        memcpy(&nsec, entry + 16, 4);
+        const char *payload = entry + headerSize;
+        memcpy(&tagNumber, payload, 4);
+
+        std::string_view tag = m_tags ? m_tags->name(tagNumber) : std::string_view();
+        char number[16];
+        if (tag.empty()) tag = std::string_view(number, static_cast<size_t>(snprintf(number, sizeof(number), "%u", tagNumber)));
+        if (!m_filter.allows(tag, 'I')) continue;
+
+        m_message.clear();
+        if (!EventLogTags::render(payload + 4, length - 4u, m_message)) m_message.append("[malformed]");
+        for (char &c: m_message) {
+            if (unlikely(c == '\n')) c = ' '; // One entry, one line
+        }
+
+        LogRecord rec;
+        int64_t timeNs = static_cast<int64_t>(sec) * 1000000000LL + nsec;
+        std::string_view line = m_renderer.render(m_line, sink.lineFormat(), timeNs, 'I', tag, pid,
+                                                  static_cast<int32_t>(tid), m_message, rec);
+        rec.bufferId = LOG_BUFFER_EVENTS;
+        if (unlikely(!sink.onSourceLine(line, &rec))) break;
+    }
+    return pos;
+}
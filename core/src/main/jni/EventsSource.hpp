@@ -0,0 +1,68 @@
+#ifndef EVENTS_SOURCE_HPP
+#define EVENTS_SOURCE_HPP
+
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include "LogSource.hpp"
+#include "EventLogTags.hpp"
+
+/**
+ * EVENTS BUFFER, DECODED NATIVELY
+ *
+ * Runs `logcat -b events -B` (binary entries) and decodes each record with the
+ * event-log-tags dictionary into a `-v time` line tagged with the event name, e.g.
+ * "I/am_anr( 1234): [0,5678,com.example,...]". The record goes along pre-parsed with
+ * nanosecond timestamps and LOG_BUFFER_EVENTS, so filters on am_anr / am_proc_start
+ * work like on any other tag and no binary crosses the pipe.
+ *
+ * Restarts its logcat on EOF (at most once per second); pollFd() changes then.
+ */
+class EventsSource : public LogSource {
+public:
+    EventsSource() = default;
+    ~EventsSource() override;
+
+    EventsSource(const EventsSource &) = delete;
+    EventsSource &operator=(const EventsSource &) = delete;
+
+    /**
+     * @param tags Dictionary for tag names (unknown tags render as their number).
+     * @param pid Only events of this pid (logcat --pid), empty for all.
+     */
+    bool install(const EventLogTags &tags, const std::string &pid, const std::string &level,
+                 const std::string &tagFilter);
+
+    void uninstall();
+
+    bool installed() const { return m_child > 0; }
+
+    const char *name() const override { return "events"; }
+    int pollFd() const override { return m_readFd; }
+    ssize_t drain(LineSink &sink) override;
+
+    /**
+     * Decodes complete binary entries at the front of `data` and delivers them.
+     * @return bytes consumed; the remainder is an incomplete entry.
+     */
+    size_t decode(const char *data, size_t size, LineSink &sink);
+
+private:
+    bool spawn();
+    void stopChild();
+
+    const EventLogTags *m_tags = nullptr;
+    std::string m_pidArg;       // "--pid=<pid>" or empty
+    pid_t m_child = -1;
+    int m_readFd = -1;
+    uint64_t m_spawnMs = 0;
+
+    LevelFilter m_filter;
+    std::unique_ptr<char[]> m_read;
+    std::string m_accumulator;
+    std::string m_message;      // Rendered payload of the current entry
+    std::string m_line;
+    TimeLineRenderer m_renderer;
+};
+
+#endif // EVENTS_SOURCE_HPP
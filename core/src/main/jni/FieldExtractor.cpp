@@ -0,0 +1,207 @@
+#include "FieldExtractor.hpp"
+#include "Arena.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <android/log.h>
+
+#define TAG "LogcatEngine-Extract"
+
+/**
+ * NUMBER PARSING: groups are copied into a small stack buffer so strtoll/strtod get a
+ * terminated string without allocating; longer captures are not valid numbers anyway.
+ */
+static constexpr size_t MAX_NUMBER_LEN = 63;
+
+static bool parseType(std::string_view name, FieldType &type) {
+    if (name.empty() || name == "string" || name == "str") type = FieldType::String;
+    else if (name == "int" || name == "long") type = FieldType::Int;
+    else if (name == "float" || name == "double") type = FieldType::Float;
+    else return false;
+    return true;
+}
+
+static inline bool isNameStart(char c) {
+    return c == '_' || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+}
+
+/**
+ * REWRITE NAMED GROUPS
+ * std::regex (ECMAScript) has no named groups, so `(?<name:type>` becomes `(` and the
+ * name/type/group index are kept aside. Escapes and bracket expressions are skipped so
+ * their parentheses do not count as groups. Names start with a letter or '_', which
+ * tells them from the lookbehinds `(?<=` / `(?<!` (std::regex has none).
+ */
+bool FieldExtractor::rewriteNamedGroups(const std::string &pattern, std::string &rewritten,
+                                        std::vector<FieldSpec> &fields, const char **error) {
+    rewritten.clear();
+    rewritten.reserve(pattern.size());
+    uint32_t group = 0;
+    bool inClass = false;
+
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        char c = pattern[i];
+        if (c == '\\' && i + 1 < pattern.size()) {
+            rewritten += c;
+            rewritten += pattern[++i];
+            continue;
+        }
+        if (inClass) {
+            if (c == ']') inClass = false;
+            rewritten += c;
+            continue;
+        }
+        if (c == '[') {
+            inClass = true;
+            rewritten += c;
+            continue;
+        }
+        if (c != '(') {
+            rewritten += c;
+            continue;
+        }
+
+        if (i + 1 < pattern.size() && pattern[i + 1] == '?') {
+            if (i + 2 < pattern.size() && pattern[i + 2] == '<') {
+                const char next = i + 3 < pattern.size() ? pattern[i + 3] : '\0';
+                if (next == '=' || next == '!') {
+                    *error = "lookbehind (?<= / (?<! is not supported";
+                    return false;
+                }
+                if (!isNameStart(next)) {
+                    *error = "a group name must start with a letter or '_'";
+                    return false;
+                }
+                size_t close = pattern.find('>', i + 3);
+                if (close == std::string::npos) {
+                    *error = "unterminated group name";
+                    return false;
+                }
+                std::string_view spec(pattern.data() + i + 3, close - (i + 3));
+                size_t colon = spec.find(':');
+
+                FieldSpec field;
+                field.name = std::string(spec.substr(0, colon));
+                if (!parseType(colon == std::string_view::npos ? std::string_view() : spec.substr(colon + 1),
+                               field.type)) {
+                    *error = "unknown field type (string, int or float)";
+                    return false;
+                }
+                field.group = ++group;
+                fields.push_back(std::move(field));
+
+                rewritten += '(';
+                i = close;
+                continue;
+            }
+            rewritten += c; // (?: (?= (?! are not capturing
+            continue;
+        }
+
+        ++group;
+        rewritten += c;
+    }
+    if (inClass) *error = "unterminated bracket expression";
+    return !inClass;
+}
+
+int FieldExtractor::addRule(const std::string &pattern, bool withLine, bool emitFields) {
+    ExtractRule rule;
+    rule.pattern = pattern;
+    rule.withLine = withLine;
+    rule.emitFields = emitFields;
+
+    std::string rewritten;
+    const char *error = nullptr;
+    if (!rewriteNamedGroups(pattern, rewritten, rule.fields, &error)) {
+        __android_log_print(ANDROID_LOG_WARN, TAG, "addRule(): %s in '%s'", error, pattern.c_str());
+        return -1;
+    }
+    if (rule.fields.empty()) {
+        __android_log_print(ANDROID_LOG_WARN, TAG, "addRule(): no named groups in '%s'", pattern.c_str());
+        return -1;
+    }
+    if (rule.fields.size() > MAX_FIELDS) {
+        __android_log_print(ANDROID_LOG_WARN, TAG, "addRule(): %zu named groups, at most %zu per rule",
+                            rule.fields.size(), MAX_FIELDS);
+        return -1;
+    }
+    try {
+        rule.regex = std::regex(rewritten, std::regex_constants::ECMAScript |
+                                           std::regex_constants::optimize);
+    } catch (...) {
+        __android_log_print(ANDROID_LOG_WARN, TAG, "addRule(): invalid regex '%s'", pattern.c_str());
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    auto current = std::atomic_load(&m_rules);
+    auto next = current ? std::make_shared<ExtractRuleSet>(*current) : std::make_shared<ExtractRuleSet>();
+    if (next->rules.size() >= MAX_RULES) return -1;
+
+    next->rules.push_back(std::move(rule));
+    int id = static_cast<int>(next->rules.size()) - 1;
+    std::atomic_store(&m_rules, std::shared_ptr<const ExtractRuleSet>(std::move(next)));
+    return id;
+}
+
+void FieldExtractor::clearRules() {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    std::atomic_store(&m_rules, std::shared_ptr<const ExtractRuleSet>());
+}
+
+std::vector<std::string> FieldExtractor::fieldNames(int ruleId) const {
+    std::vector<std::string> names;
+    auto rules = snapshot();
+    if (rules && ruleId >= 0 && static_cast<size_t>(ruleId) < rules->rules.size()) {
+        for (const auto &f: rules->rules[ruleId].fields) names.push_back(f.name);
+    }
+    return names;
+}
+
+std::shared_ptr<const ExtractRuleSet> FieldExtractor::snapshot() const {
+    return std::atomic_load(&m_rules);
+}
+
+/**
+ * EXTRACT
+ * One regex_search per rule; numeric groups are converted in place, string groups are
+ * returned as views into the event.
+ */
+uint64_t FieldExtractor::extract(const ExtractRuleSet &rules, std::string_view text, std::vector<FieldValue> &out,
+                                 Arena &arena) {
+    uint64_t matched = 0;
+    ArenaMatch m{ArenaAllocator<std::csub_match>(arena)};
+    const char *begin = text.data(), *end = begin + text.size();
+
+    for (size_t r = 0; r < rules.rules.size(); ++r) {
+        const ExtractRule &rule = rules.rules[r];
+        if (!std::regex_search(begin, end, m, rule.regex)) continue;
+        matched |= 1ULL << r;
+
+        for (size_t f = 0; f < rule.fields.size(); ++f) {
+            const FieldSpec &spec = rule.fields[f];
+            if (spec.group >= m.size() || !m[spec.group].matched) continue;
+
+            FieldValue v;
+            v.rule = static_cast<uint8_t>(r);
+            v.field = static_cast<uint8_t>(f);
+            v.type = spec.type;
+            std::string_view cap(m[spec.group].first, static_cast<size_t>(m[spec.group].length()));
+
+            if (spec.type == FieldType::String) {
+                v.s = cap;
+            } else {
+                if (cap.empty() || cap.size() > MAX_NUMBER_LEN) continue;
+                char num[MAX_NUMBER_LEN + 1];
+                memcpy(num, cap.data(), cap.size());
+                num[cap.size()] = '\0';
+                char *stop = nullptr;
+                if (spec.type == FieldType::Int) v.i = strtoll(num, &stop, 10);
+                else v.f = strtod(num, &stop);
+                if (stop == num) continue; // Not a number: skip the field rather than emit 0
+            }
+            out.push_back(v);
+        }
+    }
+    return matched;
+}
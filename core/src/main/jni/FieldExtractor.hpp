@@ -0,0 +1,109 @@
+#ifndef FIELD_EXTRACTOR_HPP
+#define FIELD_EXTRACTOR_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <regex>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+class Arena;
+
+/**
+ * Type of an extracted field, selected with `(?<name:type>...)` in the rule pattern.
+ */
+enum class FieldType : uint8_t {
+    String = 0,
+    Int = 1,    // int64
+    Float = 2,  // double
+};
+
+struct FieldSpec {
+    std::string name;
+    FieldType type = FieldType::String;
+    uint32_t group = 0;        // Capture group index in the compiled regex
+};
+
+/**
+ * One extraction rule: a regex with named, typed groups, e.g. `took (?<ms:int>\d+)ms`.
+ */
+struct ExtractRule {
+    std::string pattern;       // Original pattern as supplied by the caller
+    std::regex regex;          // Compiled with named groups rewritten to plain groups
+    std::vector<FieldSpec> fields;
+    bool withLine = false;     // Deliver the event text with its fields even if the user filter rejects it
+    bool emitFields = true;    // false: values only feed FieldStats, nothing is sent per event
+};
+
+/**
+ * A field value produced for one event. String values view into the event text.
+ */
+struct FieldValue {
+    uint8_t rule;
+    uint8_t field;
+    FieldType type;
+    int64_t i = 0;
+    double f = 0;
+    std::string_view s;
+};
+
+/**
+ * Immutable rule set; the worker thread takes a snapshot per read batch.
+ */
+struct ExtractRuleSet {
+    std::vector<ExtractRule> rules;
+};
+
+/**
+ * FieldExtractor: owns the extraction rules and runs them against events.
+ *
+ * Rules are replaced copy-on-write through an atomic shared_ptr, so JNI threads never
+ * block the worker thread.
+ */
+class FieldExtractor {
+public:
+    static constexpr size_t MAX_RULES = 64;
+    static constexpr size_t MAX_FIELDS = 255;  // Per rule: FieldValue::field is one byte
+
+    /**
+     * Compiles and appends a rule.
+     * @return the rule id, or -1 if the pattern is invalid or the rule limit is reached.
+     */
+    int addRule(const std::string& pattern, bool withLine, bool emitFields);
+
+    /**
+     * Field names of a rule in wire order (empty for an unknown id).
+     */
+    std::vector<std::string> fieldNames(int ruleId) const;
+
+    void clearRules();
+
+    /**
+     * Current rule set (may be null when no rule was ever added).
+     */
+    std::shared_ptr<const ExtractRuleSet> snapshot() const;
+
+    /**
+     * Runs every rule against `text` and appends the extracted values to `out`.
+     * Match state is allocated from `arena` (the engine's per-batch arena).
+     * @return bitmask of the rules that matched.
+     */
+    static uint64_t extract(const ExtractRuleSet& rules, std::string_view text, std::vector<FieldValue>& out,
+                            Arena& arena);
+
+    /**
+     * Rewrites `(?<name:type>` groups into plain groups and records their specs.
+     * @param error Set to the reason when the syntax is rejected.
+     * @return false on malformed group syntax.
+     */
+    static bool rewriteNamedGroups(const std::string& pattern, std::string& rewritten,
+                                   std::vector<FieldSpec>& fields, const char** error);
+
+private:
+    std::mutex m_writeMutex;   // Serializes writers; readers only use the atomic load
+    std::shared_ptr<const ExtractRuleSet> m_rules;
+};
+
+#endif // FIELD_EXTRACTOR_HPP
@@ -0,0 +1,65 @@
+#include "FieldStats.hpp"
+#include "FieldExtractor.hpp"
+
+/**
+ * SPINLOCK GUARD
+ * Same discipline as the regex hot-swap lock: critical sections are a few bucket updates.
+ */
+namespace {
+    struct SpinGuard {
+        explicit SpinGuard(std::atomic_flag &flag) : m_flag(flag) {
+            while (m_flag.test_and_set(std::memory_order_acquire));
+        }
+        ~SpinGuard() { m_flag.clear(std::memory_order_release); }
+        std::atomic_flag &m_flag;
+    };
+}
+
+void FieldStats::record(const FieldValue *values, size_t count) {
+    SpinGuard guard(m_lock);
+    for (size_t i = 0; i < count; ++i) {
+        const FieldValue &v = values[i];
+        if (v.type == FieldType::String) continue;
+
+        if (v.rule >= m_sketches.size()) m_sketches.resize(v.rule + 1u);
+        auto &fields = m_sketches[v.rule];
+        if (v.field >= fields.size()) fields.resize(v.field + 1u);
+        fields[v.field].add(v.type == FieldType::Int ? static_cast<double>(v.i) : v.f);
+    }
+}
+
+QuantileSketch *FieldStats::find(int rule, int field) {
+    if (rule < 0 || field < 0 || static_cast<size_t>(rule) >= m_sketches.size()) return nullptr;
+    auto &fields = m_sketches[rule];
+    if (static_cast<size_t>(field) >= fields.size()) return nullptr;
+    QuantileSketch *sketch = &fields[field];
+    return sketch->count() ? sketch : nullptr;
+}
+
+bool FieldStats::quantiles(int rule, int field, const double *q, double *out, size_t n) {
+    SpinGuard guard(m_lock);
+    QuantileSketch *sketch = find(rule, field);
+    if (!sketch) return false;
+    for (size_t i = 0; i < n; ++i) out[i] = sketch->quantile(q[i]);
+    return true;
+}
+
+bool FieldStats::summary(int rule, int field, FieldSummary &out) {
+    SpinGuard guard(m_lock);
+    QuantileSketch *sketch = find(rule, field);
+    if (!sketch) return false;
+    out.count = sketch->count();
+    out.min = sketch->min();
+    out.max = sketch->max();
+    out.sum = sketch->sum();
+    return true;
+}
+
+void FieldStats::reset(int rule) {
+    SpinGuard guard(m_lock);
+    if (rule < 0) {
+        m_sketches.clear();
+    } else if (static_cast<size_t>(rule) < m_sketches.size()) {
+        for (auto &sketch: m_sketches[rule]) sketch.clear();
+    }
+}
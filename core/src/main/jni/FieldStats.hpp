@@ -0,0 +1,56 @@
+#ifndef FIELD_STATS_HPP
+#define FIELD_STATS_HPP
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "QuantileSketch.hpp"
+
+struct FieldValue;
+
+/**
+ * Point-in-time summary of one numeric field.
+ */
+struct FieldSummary {
+    uint64_t count = 0;
+    double min = 0;
+    double max = 0;
+    double sum = 0;
+};
+
+/**
+ * FieldStats: streaming quantile sketches for every numeric field of every extraction
+ * rule, keyed by (rule id, field index).
+ *
+ * The worker records one event's values under a single spinlock acquisition; JNI
+ * queries take the same spinlock, so they only ever wait for one event's update.
+ */
+class FieldStats {
+public:
+    /**
+     * Adds the numeric values among `values` (string fields are ignored).
+     */
+    void record(const FieldValue* values, size_t count);
+
+    /**
+     * Fills `out[i]` with the q[i] quantile of the field.
+     * @return false if the field has no samples.
+     */
+    bool quantiles(int rule, int field, const double* q, double* out, size_t n);
+
+    bool summary(int rule, int field, FieldSummary& out);
+
+    /**
+     * Drops the samples of one rule (-1 = all rules).
+     */
+    void reset(int rule);
+
+private:
+    QuantileSketch* find(int rule, int field);
+
+    std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
+    std::vector<std::vector<QuantileSketch>> m_sketches; // [rule][field], grown on first sample
+};
+
+#endif // FIELD_STATS_HPP
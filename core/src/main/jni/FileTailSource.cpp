@@ -0,0 +1,318 @@
+#include "FileTailSource.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <android/log.h>
+
+#define TAG "LogcatEngine-Tail"
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * BUFFERS: appended data is read in 64KB chunks, one read() per chunk rather than per
+ * line; inotify events are only counted, never interpreted beyond "look again".
+ */
+static constexpr size_t FILE_READ_SIZE = 64 * 1024;
+static constexpr size_t INOTIFY_READ_SIZE = 4 * 1024;
+
+// ---------------------------------------------------------------------------------------
+// LineTimeFormat
+// ---------------------------------------------------------------------------------------
+
+bool LineTimeFormat::compile(std::string_view format) {
+    m_fields.clear();
+    m_hasYear = false;
+    m_hourKey = -1;
+    for (size_t i = 0; i < format.size(); ++i) {
+        if (format[i] != '%') {
+            m_fields.push_back({0, format[i]});
+            continue;
+        }
+        if (++i == format.size()) break;
+        switch (format[i]) {
+            case 'Y':
+                m_hasYear = true;
+                m_fields.push_back({'Y', 0});
+                break;
+            case 'm': case 'd': case 'H': case 'M': case 'S': case 'f': case 'L':
+                m_fields.push_back({format[i], 0});
+                break;
+            case '%':
+                m_fields.push_back({0, '%'});
+                break;
+            default:
+                __android_log_print(ANDROID_LOG_WARN, TAG, "compile(): unknown directive %%%c", format[i]);
+                m_fields.clear();
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool parseDigits(std::string_view line, size_t &pos, size_t maxDigits, int &value) {
+    size_t start = pos;
+    value = 0;
+    while (pos < line.size() && pos - start < maxDigits && line[pos] >= '0' && line[pos] <= '9') {
+        value = value * 10 + (line[pos++] - '0');
+    }
+    return pos > start;
+}
+
+/**
+ * LEVEL WORDS: the first letter decides; TRACE maps to V and CRITICAL to F.
+ */
+static char levelOf(char c) {
+    if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    switch (c) {
+        case 'V': case 'D': case 'I': case 'W': case 'E': case 'F': return c;
+        case 'T': return 'V';
+        case 'A': case 'C': return 'F';
+        default: return 'I';
+    }
+}
+
+size_t LineTimeFormat::parse(std::string_view line, int64_t &timeNs, char &level) {
+    int year = 0, month = 1, day = 1, hour = 0, minute = 0, second = 0;
+    int64_t fraction = 0;
+    size_t pos = 0;
+    for (const Field &f: m_fields) {
+        int v;
+        switch (f.kind) {
+            case 0:
+                if (pos >= line.size() || line[pos] != f.literal) return 0;
+                ++pos;
+                break;
+            case 'Y':
+                if (!parseDigits(line, pos, 4, year)) return 0;
+                break;
+            case 'm':
+                if (!parseDigits(line, pos, 2, month) || month < 1 || month > 12) return 0;
+                break;
+            case 'd':
+                if (!parseDigits(line, pos, 2, day) || day < 1 || day > 31) return 0;
+                break;
+            case 'H':
+                if (!parseDigits(line, pos, 2, hour) || hour > 23) return 0;
+                break;
+            case 'M':
+                if (!parseDigits(line, pos, 2, minute) || minute > 59) return 0;
+                break;
+            case 'S':
+                if (!parseDigits(line, pos, 2, second) || second > 60) return 0;
+                break;
+            case 'f': {
+                size_t start = pos;
+                if (!parseDigits(line, pos, 9, v)) return 0;
+                fraction = v;
+                for (size_t digits = pos - start; digits < 9; ++digits) fraction *= 10;
+                break;
+            }
+            case 'L': {
+                size_t start = pos;
+                while (pos < line.size() && ((line[pos] | 0x20) >= 'a' && (line[pos] | 0x20) <= 'z')) ++pos;
+                if (pos == start) return 0;
+                level = levelOf(line[start]);
+                break;
+            }
+        }
+    }
+
+    // mktime() once per local hour; the year of a year-less format is looked up then too
+    const int64_t key = ((static_cast<int64_t>(year) * 13 + month) * 32 + day) * 24 + hour;
+    if (unlikely(key != m_hourKey)) {
+        if (!m_hasYear) {
+            time_t now = time(nullptr);
+            struct tm local{};
+            localtime_r(&now, &local);
+            year = local.tm_year + 1900;
+        }
+        struct tm t{};
+        t.tm_year = year - 1900;
+        t.tm_mon = month - 1;
+        t.tm_mday = day;
+        t.tm_hour = hour;
+        t.tm_isdst = -1;
+        m_hourEpoch = static_cast<int64_t>(mktime(&t));
+        m_hourKey = key;
+    }
+    timeNs = (m_hourEpoch + minute * 60 + second) * 1000000000LL + fraction;
+    return pos;
+}
+
+// ---------------------------------------------------------------------------------------
+// FileTailSource
+// ---------------------------------------------------------------------------------------
+
+FileTailSource::~FileTailSource() {
+    uninstall();
+}
+
+bool FileTailSource::install(const std::string &path, const std::string &timeFormat, const std::string &level,
+                             const std::string &tagFilter, size_t accumulatorCap) {
+    if (m_inotifyFd >= 0) return false;
+
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "install(): inotify_init1() failed: %s", strerror(errno));
+        return false;
+    }
+
+    // The directory tells us when a rotated or not yet existing file (re)appears
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    if (inotify_add_watch(m_inotifyFd, dir.c_str(), IN_CREATE | IN_MOVED_TO) < 0) {
+        __android_log_print(ANDROID_LOG_WARN, TAG, "install(): cannot watch %s: %s", dir.c_str(), strerror(errno));
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+        return false;
+    }
+
+    m_path = path;
+    m_tag = path.substr(slash == std::string::npos ? 0 : slash + 1);
+    size_t dot = m_tag.find('.');
+    if (dot != std::string::npos && dot > 0) m_tag.resize(dot);
+    if (m_tag.empty()) m_tag = "file";
+
+    m_format.compile(timeFormat);
+    m_lastTimeNs = 0;
+    m_filter.configure(level, tagFilter);
+    if (!m_read) m_read = std::make_unique<char[]>(FILE_READ_SIZE);
+    m_accumulatorCap = accumulatorCap;
+    openFile(false); // Like tail -F: only what is written from now on
+    return true;
+}
+
+void FileTailSource::uninstall() {
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    if (m_inotifyFd >= 0) {
+        close(m_inotifyFd); // Drops the watches too
+        m_inotifyFd = -1;
+    }
+    m_fileWatch = -1;
+    m_accumulator.clear();
+}
+
+/**
+ * OPEN
+ * The watch is added by path right after the open, so it lands on the same inode.
+ */
+bool FileTailSource::openFile(bool fromStart) {
+    int fd = open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st{};
+    fstat(fd, &st);
+
+    if (m_fileWatch >= 0) inotify_rm_watch(m_inotifyFd, m_fileWatch); // Gone already if deleted
+    m_fileWatch = inotify_add_watch(m_inotifyFd, m_path.c_str(),
+                                    IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+    m_fd = fd;
+    m_inode = st.st_ino;
+    m_offset = fromStart ? 0 : lseek(fd, 0, SEEK_END);
+    m_accumulator.clear();
+    return true;
+}
+
+/**
+ * DRAIN
+ * Reads to the end of the file every time: inotify only reports new writes, so data left
+ * unread now would wait for the next one. Then checks the path: another inode there means
+ * the file was rotated, and the new one is read from its start.
+ */
+ssize_t FileTailSource::drain(LineSink &sink) {
+    char events[INOTIFY_READ_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+        ssize_t n = read(m_inotifyFd, events, sizeof(events));
+        if (n > 0) continue;
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        __android_log_print(ANDROID_LOG_WARN, TAG, "drain(%s): inotify read failed: %s", m_tag.c_str(),
+                            strerror(errno));
+        return -1;
+    }
+
+    ssize_t total = m_fd >= 0 ? readAppended(sink) : 0;
+
+    struct stat st{};
+    if (stat(m_path.c_str(), &st) == 0 && (m_fd < 0 || st.st_ino != m_inode)) {
+        if (m_fd >= 0) {
+            __android_log_print(ANDROID_LOG_INFO, TAG, "drain(%s): file rotated", m_tag.c_str());
+            // Unterminated last line of the old file; on an output error the rotation waits
+            if (!m_accumulator.empty() && unlikely(!emit(sink, m_accumulator))) return total;
+            close(m_fd);
+            m_fd = -1;
+        }
+        if (openFile(true)) total += readAppended(sink);
+    }
+    return total;
+}
+
+ssize_t FileTailSource::readAppended(LineSink &sink) {
+    struct stat st{};
+    if (fstat(m_fd, &st) == 0 && st.st_size < m_offset) {
+        __android_log_print(ANDROID_LOG_INFO, TAG, "readAppended(%s): file truncated", m_tag.c_str());
+        lseek(m_fd, 0, SEEK_SET);
+        m_offset = 0;
+        m_accumulator.clear();
+    }
+
+    ssize_t total = 0;
+    for (;;) {
+        ssize_t bytes = read(m_fd, m_read.get(), FILE_READ_SIZE);
+        if (bytes < 0 && errno == EINTR) continue;
+        if (bytes <= 0) break;
+        total += bytes;
+        m_offset += bytes;
+
+        m_accumulator.append(m_read.get(), static_cast<size_t>(bytes));
+        size_t pos = 0, next;
+        bool ok = true;
+        while ((next = m_accumulator.find('\n', pos)) != std::string::npos) {
+            ok = emit(sink, std::string_view(&m_accumulator[pos], next - pos));
+            pos = next + 1;
+            if (unlikely(!ok)) break;
+        }
+        m_accumulator.erase(0, pos);
+        if (unlikely(!ok)) break; // The rest stays buffered for the next drain
+
+        // A line that never ends is delivered in pieces rather than dropped
+        if (unlikely(m_accumulator.size() > m_accumulatorCap)) {
+            ok = emit(sink, m_accumulator);
+            m_accumulator.clear();
+            if (unlikely(!ok)) break;
+        }
+    }
+    return total;
+}
+
+bool FileTailSource::emit(LineSink &sink, std::string_view text) {
+    if (!text.empty() && text.back() == '\r') text.remove_suffix(1);
+
+    // Lines without a timestamp (stack traces, wrapped text) stay with the previous one
+    char level = 'I';
+    int64_t timeNs = 0;
+    size_t consumed = m_format.empty() ? 0 : m_format.parse(text, timeNs, level);
+    if (consumed > 0) {
+        text.remove_prefix(consumed);
+        while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+        m_lastTimeNs = timeNs;
+        m_lastLevel = level;
+    } else if (!m_format.empty() && m_lastTimeNs != 0) {
+        timeNs = m_lastTimeNs;
+        level = m_lastLevel;
+    } else {
+        timeNs = TimeLineRenderer::nowNs();
+    }
+    if (!m_filter.allows(m_tag, level)) return true;
+
+    LogRecord rec;
+    std::string_view line = m_renderer.render(m_line, sink.lineFormat(), timeNs, level, m_tag, 0, -1, text, rec);
+    return sink.onSourceLine(line, &rec);
+}
@@ -0,0 +1,109 @@
+#ifndef FILE_TAIL_SOURCE_HPP
+#define FILE_TAIL_SOURCE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include "LogSource.hpp"
+
+/**
+ * LINE TIMESTAMP FORMAT
+ *
+ * strptime-like pattern matched at the start of each line of a tailed file. Compiled once
+ * into fields; parsing is a single pass without allocations, and the local-time
+ * conversion (mktime) runs once per hour of log time.
+ *
+ *   %Y year  %m month  %d day  %H hour  %M minute  %S second
+ *   %f fraction (1-9 digits)   %L level word (V/D/I/W/E/F or DEBUG, INFO, WARN, ...)
+ *   %% literal '%'             anything else: literal character
+ *
+ * A missing %Y means the current year.
+ */
+class LineTimeFormat {
+public:
+    /**
+     * @return false on an unknown directive; the format is then empty (no timestamps).
+     */
+    bool compile(std::string_view format);
+
+    bool empty() const { return m_fields.empty(); }
+
+    /**
+     * Matches the format at the start of `line`.
+     * @param level Set when the format has %L, untouched otherwise.
+     * @return bytes consumed (0 if the line does not match).
+     */
+    size_t parse(std::string_view line, int64_t &timeNs, char &level);
+
+private:
+    struct Field {
+        char kind;    // Directive letter, or 0 for a literal
+        char literal;
+    };
+
+    std::vector<Field> m_fields;
+    bool m_hasYear = false;
+    int64_t m_hourKey = -1;   // year/month/day/hour of m_hourEpoch
+    int64_t m_hourEpoch = 0;  // Epoch seconds of that local hour
+};
+
+/**
+ * TAILED LOG FILE
+ *
+ * Follows a text file written by some SDK like `tail -F`: starts at its current end,
+ * reads appended data in large chunks when inotify reports a change, reopens the path
+ * when the file is rotated (renamed/deleted and recreated) and restarts from the top
+ * when it is truncated. Lines become `-v time` records tagged with the file's base name;
+ * the timestamp and level come from the line itself (LineTimeFormat) when a format is
+ * given, and lines without one (stack traces) keep the previous line's time.
+ *
+ * pollFd() is the inotify descriptor, which stays the same across rotations.
+ */
+class FileTailSource : public LogSource {
+public:
+    FileTailSource() = default;
+    ~FileTailSource() override;
+
+    FileTailSource(const FileTailSource &) = delete;
+    FileTailSource &operator=(const FileTailSource &) = delete;
+
+    /**
+     * @param path File to follow; it may not exist yet.
+     * @param timeFormat LineTimeFormat pattern, empty to stamp lines when they are read.
+     * @param accumulatorCap A longer unterminated line is delivered in pieces of this size.
+     */
+    bool install(const std::string &path, const std::string &timeFormat, const std::string &level,
+                 const std::string &tagFilter, size_t accumulatorCap);
+
+    void uninstall();
+
+    const char *name() const override { return m_tag.c_str(); }
+    int pollFd() const override { return m_inotifyFd; }
+    ssize_t drain(LineSink &sink) override;
+
+private:
+    bool openFile(bool fromStart);
+    ssize_t readAppended(LineSink &sink);
+    bool emit(LineSink &sink, std::string_view text);
+
+    std::string m_path;
+    std::string m_tag;          // Base name of the file, without extension
+    int m_inotifyFd = -1;
+    int m_fileWatch = -1;
+    int m_fd = -1;
+    ino_t m_inode = 0;
+    off_t m_offset = 0;
+
+    LineTimeFormat m_format;
+    int64_t m_lastTimeNs = 0;
+    char m_lastLevel = 'I';
+    LevelFilter m_filter;
+    std::unique_ptr<char[]> m_read;
+    std::string m_accumulator;
+    size_t m_accumulatorCap = 0;
+    std::string m_line;
+    TimeLineRenderer m_renderer;
+};
+
+#endif // FILE_TAIL_SOURCE_HPP
@@ -0,0 +1,185 @@
+#include "KmsgSource.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <android/log.h>
+
+#define TAG "LogcatEngine-Kmsg"
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * BUFFERS: /dev/kmsg returns exactly one record per read() and fails with EINVAL if it
+ * does not fit, so a read covers the largest record (CONSOLE_EXT_LOG_MAX, 8KB). A batch
+ * is a handful of reads, enough for a dmesg burst without starving the other inputs.
+ */
+static constexpr size_t KMSG_READ_SIZE = 8 * 1024;
+static constexpr size_t KMSG_BATCH_BYTES = 64 * 1024;
+static constexpr size_t KMSG_MAX_TAG = 32;
+
+KmsgSource::~KmsgSource() {
+    uninstall();
+}
+
+bool KmsgSource::install(const std::string &path, const std::string &level, const std::string &tagFilter) {
+    if (m_fd >= 0) return false;
+
+    int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        __android_log_print(ANDROID_LOG_INFO, TAG, "install(): %s not readable: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    // epoll refuses regular files: they are always readable, and so is this eventfd
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        m_readyFd = eventfd(1, EFD_CLOEXEC);
+        if (m_readyFd < 0) {
+            __android_log_print(ANDROID_LOG_ERROR, TAG, "install(): eventfd() failed: %s", strerror(errno));
+            close(fd);
+            return false;
+        }
+    }
+
+    m_fd = fd;
+    m_lastSeq = 0;
+    m_filter.configure(level, tagFilter);
+    if (!m_read) m_read = std::make_unique<char[]>(KMSG_READ_SIZE);
+    return true;
+}
+
+void KmsgSource::uninstall() {
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    if (m_readyFd >= 0) {
+        close(m_readyFd);
+        m_readyFd = -1;
+    }
+    m_accumulator.clear();
+}
+
+/**
+ * DRAIN
+ * Records are '\n'-terminated and dictionary lines start with a space, so the device
+ * (one record per read) and a FIFO or file (arbitrary chunks) share one line splitter.
+ */
+ssize_t KmsgSource::drain(LineSink &sink) {
+    // printk stamps are CLOCK_MONOTONIC; sampled per batch so a clock step is picked up
+    const int64_t bootToRealtimeNs = monotonicToRealtimeNs();
+
+    size_t total = 0;
+    bool ended = false;
+    while (total < KMSG_BATCH_BYTES) {
+        ssize_t bytes = read(m_fd, m_read.get(), KMSG_READ_SIZE);
+        if (bytes < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EPIPE) continue; // Overwritten before we got there; the seq gap counts it
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                __android_log_print(ANDROID_LOG_WARN, TAG, "drain(): read() failed: %s", strerror(errno));
+                ended = true;
+            }
+            break;
+        }
+        if (bytes == 0) { // End of a file, or the FIFO writer went away
+            ended = true;
+            break;
+        }
+        total += static_cast<size_t>(bytes);
+
+        m_accumulator.append(m_read.get(), static_cast<size_t>(bytes));
+        size_t pos = 0, next;
+        bool ok = true;
+        while ((next = m_accumulator.find('\n', pos)) != std::string::npos) {
+            if (m_accumulator[pos] != ' ') ok = emit(sink, std::string_view(&m_accumulator[pos], next - pos), bootToRealtimeNs);
+            pos = next + 1;
+            if (unlikely(!ok)) break;
+        }
+        m_accumulator.erase(0, pos);
+        if (unlikely(!ok)) break;
+        if (unlikely(m_accumulator.size() > KMSG_READ_SIZE)) m_accumulator.clear(); // Not kmsg format
+    }
+
+    if (unlikely(ended)) {
+        if (!m_accumulator.empty()) { // Unterminated last record of a file
+            m_accumulator.push_back('\n');
+            emit(sink, std::string_view(m_accumulator.data(), m_accumulator.size() - 1), bootToRealtimeNs);
+            m_accumulator.clear();
+        }
+        return -1;
+    }
+    return static_cast<ssize_t>(total);
+}
+
+static uint64_t parseNumber(std::string_view &field) {
+    uint64_t v = 0;
+    size_t i = 0;
+    while (i < field.size() && field[i] >= '0' && field[i] <= '9') v = v * 10 + static_cast<uint64_t>(field[i++] - '0');
+    field.remove_prefix(i);
+    return v;
+}
+
+/**
+ * KERNEL LEVELS: emerg/alert/crit -> F, err -> E, warning -> W, notice/info -> I,
+ * debug -> D (the mapping logd uses for its kernel buffer).
+ */
+static char kernelLevel(uint64_t priority) {
+    static constexpr char LEVELS[8] = {'F', 'F', 'F', 'E', 'W', 'I', 'I', 'D'};
+    return LEVELS[priority & 7];
+}
+
+bool KmsgSource::emit(LineSink &sink, std::string_view record, int64_t bootToRealtimeNs) {
+    size_t semicolon = record.find(';');
+    if (unlikely(semicolon == std::string_view::npos)) return true;
+    std::string_view prefix = record.substr(0, semicolon);
+    std::string_view message = record.substr(semicolon + 1);
+
+    // "<prio>,<seq>,<usec>,<flags>[,caller=T<tid>]..."
+    uint64_t priority = parseNumber(prefix);
+    if (!prefix.empty()) prefix.remove_prefix(1);
+    uint64_t seq = parseNumber(prefix);
+    if (!prefix.empty()) prefix.remove_prefix(1);
+    uint64_t usec = parseNumber(prefix);
+    int32_t tid = 0;
+    size_t caller = prefix.find(",caller=T");
+    if (caller != std::string_view::npos) {
+        std::string_view id = prefix.substr(caller + 9);
+        tid = static_cast<int32_t>(parseNumber(id));
+    }
+
+    if (m_lastSeq != 0 && seq > m_lastSeq + 1) {
+        m_dropped.fetch_add(seq - m_lastSeq - 1, std::memory_order_relaxed);
+    }
+    m_lastSeq = seq;
+
+    // "lowmemorykiller: Killing ..." is tagged lowmemorykiller
+    std::string_view tag = "kernel";
+    size_t colon = message.find(": ");
+    if (colon != std::string_view::npos && colon > 0 && colon <= KMSG_MAX_TAG) {
+        std::string_view word = message.substr(0, colon);
+        bool identifier = true;
+        for (char c: word) {
+            if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                  c == '_' || c == '-' || c == '.')) {
+                identifier = false;
+                break;
+            }
+        }
+        if (identifier) tag = word;
+    }
+
+    const char level = kernelLevel(priority);
+    if (!m_filter.allows(tag, level)) return true;
+
+    LogRecord rec;
+    const int64_t timeNs = static_cast<int64_t>(usec) * 1000 + bootToRealtimeNs;
+    std::string_view line = m_renderer.render(m_line, sink.lineFormat(), timeNs, level, tag, tid, tid, message,
+                                              rec);
+    rec.bufferId = LOG_BUFFER_KERNEL;
+    return sink.onSourceLine(line, &rec);
+}
@@ -0,0 +1,66 @@
+#ifndef KMSG_SOURCE_HPP
+#define KMSG_SOURCE_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include "LogSource.hpp"
+
+/**
+ * KERNEL LOG, READ FROM /dev/kmsg
+ *
+ * Low-memory kills, OOM reports and thermal throttling are only ever written to the
+ * kernel ring buffer. Each structured kmsg record
+ *     "<prio>,<seq>,<usec since boot>,<flags>[,caller=T<tid>,...];<message>\n"
+ *     " KEY=value\n" ...            (device dictionary, skipped)
+ * becomes a `-v time` line with LOG_BUFFER_KERNEL, a wall-clock timestamp and the
+ * message's "subsystem: " prefix as tag (e.g. lowmemorykiller), "kernel" otherwise.
+ *
+ * Any path with the same format works: a FIFO is followed like the device, a regular
+ * file is read once to its end (host tests, captured dumps).
+ */
+class KmsgSource : public LogSource {
+public:
+    static constexpr const char *DEVICE_PATH = "/dev/kmsg";
+
+    KmsgSource() = default;
+    ~KmsgSource() override;
+
+    KmsgSource(const KmsgSource &) = delete;
+    KmsgSource &operator=(const KmsgSource &) = delete;
+
+    /**
+     * Opens `path` (usually DEVICE_PATH; unreadable for most apps under SELinux).
+     * Kernel records belong to no app process, so there is no pid filter.
+     */
+    bool install(const std::string &path, const std::string &level, const std::string &tagFilter);
+
+    void uninstall();
+
+    bool installed() const { return m_fd >= 0; }
+
+    /**
+     * Records overwritten in the ring buffer before they were read (sequence gaps).
+     */
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    const char *name() const override { return "kmsg"; }
+    int pollFd() const override { return m_readyFd >= 0 ? m_readyFd : m_fd; }
+    ssize_t drain(LineSink &sink) override;
+
+private:
+    bool emit(LineSink &sink, std::string_view record, int64_t bootToRealtimeNs);
+
+    int m_fd = -1;
+    int m_readyFd = -1;         // Always-readable eventfd standing in for a regular file
+    uint64_t m_lastSeq = 0;     // 0 = nothing read yet
+    std::atomic<uint64_t> m_dropped{0};
+
+    LevelFilter m_filter;
+    std::unique_ptr<char[]> m_read;
+    std::string m_accumulator;
+    std::string m_line;
+    TimeLineRenderer m_renderer;
+};
+
+#endif // KMSG_SOURCE_HPP
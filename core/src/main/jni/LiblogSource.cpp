@@ -0,0 +1,292 @@
+#include "LiblogSource.hpp"
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <android/log.h>
+
+#define TAG "LogcatEngine-Liblog"
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * RECORD LIMITS: liblog itself truncates a message to LOGGER_ENTRY_MAX_PAYLOAD (4068
+ * bytes including tag), so a record never spans more than ~17 slots.
+ */
+static constexpr size_t MAX_TAG_LEN = 255;
+static constexpr size_t MAX_MESSAGE_LEN = 4068;
+static constexpr char OWN_TAG_PREFIX[] = "LogcatEngine";
+
+/**
+ * Serialized record: header, tag bytes, message bytes (no terminators).
+ */
+struct RecordHeader {
+    int64_t timeNs;
+    int32_t pid;
+    int32_t tid;
+    uint16_t tagLen;
+    uint16_t msgLen;
+    uint8_t priority;
+    uint8_t bufferId;
+    uint16_t reserved;
+};
+
+using LoggerFn = void (*)(const LiblogMessage *);
+using SetLoggerFn = void (*)(LoggerFn);
+
+/**
+ * LIBLOG API (API 30+), resolved once at runtime so the library still loads on API 24.
+ */
+struct LiblogApi {
+    SetLoggerFn setLogger = nullptr;
+    LoggerFn defaultLogger = nullptr; // __android_log_logd_logger: what liblog uses without a hook
+};
+
+static const LiblogApi &liblogApi() {
+    static const LiblogApi api = [] {
+        LiblogApi a;
+        a.setLogger = reinterpret_cast<SetLoggerFn>(dlsym(RTLD_DEFAULT, "__android_log_set_logger"));
+        a.defaultLogger = reinterpret_cast<LoggerFn>(dlsym(RTLD_DEFAULT, "__android_log_logd_logger"));
+        if (!a.setLogger || !a.defaultLogger) a = LiblogApi{};
+        return a;
+    }();
+    return api;
+}
+
+/**
+ * HOOK STATE
+ * The logger is a plain function pointer, so the installed source is global. Hook calls
+ * register in s_writers before reading s_active; uninstall() clears s_active and then
+ * waits for s_writers to drain, so no push() outlives the queue (Dekker, seq_cst).
+ */
+static std::atomic<LiblogSource *> s_active{nullptr};
+static std::atomic<uint32_t> s_writers{0};
+static thread_local bool t_inHook = false;
+
+bool LiblogSource::available() {
+    return liblogApi().setLogger != nullptr;
+}
+
+LiblogSource::~LiblogSource() {
+    uninstall();
+}
+
+/**
+ * INSTALL
+ * Called before the worker starts: the queue is (re)initialized without concurrency.
+ */
+bool LiblogSource::install(const std::string &level, const std::string &tagFilter, uint32_t bufferMask) {
+    const LiblogApi &api = liblogApi();
+    if (!api.setLogger || m_efd >= 0 || s_active.load() != nullptr) return false;
+
+    m_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_efd < 0) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "install(): eventfd() failed: %s", strerror(errno));
+        return false;
+    }
+
+    if (!m_slots) m_slots = std::make_unique<Slot[]>(SLOT_COUNT);
+    for (size_t i = 0; i < SLOT_COUNT; ++i) m_slots[i].seq.store(i, std::memory_order_relaxed);
+    m_enqueue.store(0, std::memory_order_relaxed);
+    m_dequeue = 0;
+    m_armed.store(true, std::memory_order_relaxed);
+    m_filter.configure(level, tagFilter);
+    m_bufferMask = bufferMask;
+
+    s_active.store(this);
+    api.setLogger(hookLogger);
+    __android_log_print(ANDROID_LOG_INFO, TAG, "install(): capturing in-process logs (%zu slot queue)", SLOT_COUNT);
+    return true;
+}
+
+void LiblogSource::uninstall() {
+    if (m_efd < 0) return;
+    liblogApi().setLogger(liblogApi().defaultLogger);
+    s_active.store(nullptr);
+    while (s_writers.load() != 0) sched_yield(); // Threads still inside push()
+    close(m_efd);
+    m_efd = -1;
+}
+
+/**
+ * HOOK (any app thread)
+ * Chains to logd first so the system log is unaffected, then queues a copy.
+ */
+void LiblogSource::hookLogger(const LiblogMessage *msg) {
+    liblogApi().defaultLogger(msg);
+    if (unlikely(t_inHook || !msg)) return;
+    if (msg->tag && strncmp(msg->tag, OWN_TAG_PREFIX, sizeof(OWN_TAG_PREFIX) - 1) == 0) return;
+
+    t_inHook = true;
+    s_writers.fetch_add(1);
+    LiblogSource *source = s_active.load();
+    if (likely(source)) source->push(msg);
+    s_writers.fetch_sub(1, std::memory_order_release);
+    t_inHook = false;
+}
+
+/**
+ * PUSH (MPSC producer)
+ * Reserves all slots of the record with one CAS, fills them and publishes the first slot
+ * last, so the consumer never sees a partially written record. A full queue drops the
+ * record: the app's logging thread must never wait on the engine.
+ */
+void LiblogSource::push(const LiblogMessage *msg) {
+    const char *tag = msg->tag ? msg->tag : "";
+    const char *text = msg->message ? msg->message : "";
+
+    RecordHeader h{};
+    h.timeNs = TimeLineRenderer::nowNs();
+    h.pid = getpid();
+    h.tid = gettid();
+    h.tagLen = static_cast<uint16_t>(strnlen(tag, MAX_TAG_LEN));
+    h.msgLen = static_cast<uint16_t>(strnlen(text, MAX_MESSAGE_LEN));
+    h.priority = static_cast<uint8_t>(msg->priority);
+    h.bufferId = static_cast<uint8_t>(msg->buffer_id);
+
+    constexpr size_t dataBytes = sizeof(Slot::data);
+    const size_t bytes = sizeof(h) + h.tagLen + h.msgLen;
+    const uint64_t count = (bytes + dataBytes - 1) / dataBytes;
+    constexpr uint64_t mask = SLOT_COUNT - 1;
+
+    uint64_t pos = m_enqueue.load(std::memory_order_relaxed);
+    while (true) {
+        uint64_t seq = m_slots[(pos + count - 1) & mask].seq.load(std::memory_order_acquire);
+        auto dif = static_cast<int64_t>(seq - (pos + count - 1));
+        if (dif == 0) {
+            if (m_enqueue.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = m_enqueue.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Scatter header, tag and message over the reserved slots
+    size_t offset = 0;
+    auto put = [&](const void *src, size_t n) {
+        auto p = static_cast<const char *>(src);
+        while (n) {
+            Slot &slot = m_slots[(pos + offset / dataBytes) & mask];
+            size_t at = offset % dataBytes, chunk = std::min(n, dataBytes - at);
+            memcpy(slot.data + at, p, chunk);
+            p += chunk;
+            n -= chunk;
+            offset += chunk;
+        }
+    };
+    put(&h, sizeof(h));
+    put(tag, h.tagLen);
+    put(text, h.msgLen);
+
+    Slot &first = m_slots[pos & mask];
+    first.count = static_cast<uint32_t>(count);
+    first.bytes = static_cast<uint32_t>(bytes);
+    for (uint64_t i = 1; i < count; ++i) {
+        m_slots[(pos + i) & mask].seq.store(pos + i + 1, std::memory_order_release);
+    }
+    first.seq.store(pos + 1, std::memory_order_release);
+    signal();
+}
+
+/**
+ * WAKE-UP
+ * Only the first record after the worker armed the eventfd pays for the write() syscall.
+ */
+void LiblogSource::signal() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_armed.load(std::memory_order_relaxed) && m_armed.exchange(false)) {
+        uint64_t one = 1;
+        (void) write(m_efd, &one, sizeof(one));
+    }
+}
+
+bool LiblogSource::pop() {
+    constexpr uint64_t mask = SLOT_COUNT - 1;
+    Slot &first = m_slots[m_dequeue & mask];
+    if (first.seq.load(std::memory_order_acquire) != m_dequeue + 1) return false;
+
+    const uint32_t count = first.count;
+    constexpr size_t dataBytes = sizeof(Slot::data);
+    m_record.resize(first.bytes);
+    for (size_t offset = 0; offset < m_record.size(); offset += dataBytes) {
+        const Slot &slot = m_slots[(m_dequeue + offset / dataBytes) & mask];
+        memcpy(&m_record[offset], slot.data, std::min(dataBytes, m_record.size() - offset));
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        m_slots[(m_dequeue + i) & mask].seq.store(m_dequeue + i + SLOT_COUNT, std::memory_order_release);
+    }
+    m_dequeue += count;
+    return true;
+}
+
+/**
+ * DRAIN (worker)
+ * Bounded to one queue's worth of slots per call so a flood cannot starve the other
+ * epoll sources; the eventfd is re-signalled when records are left behind.
+ */
+ssize_t LiblogSource::drain(LineSink &sink) {
+    if (m_efd < 0) return -1;
+    uint64_t counter;
+    (void) read(m_efd, &counter, sizeof(counter));
+
+    ssize_t bytes = 0;
+    bool ok = true;
+    for (size_t n = 0; ok && n < SLOT_COUNT; ++n) {
+        if (!pop()) {
+            m_armed.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_slots[m_dequeue & (SLOT_COUNT - 1)].seq.load(std::memory_order_acquire) != m_dequeue + 1) {
+                return bytes; // Empty: the next push() signals
+            }
+            m_armed.store(false);
+            continue;
+        }
+        bytes += static_cast<ssize_t>(m_record.size());
+        emit(sink, ok);
+    }
+
+    uint64_t one = 1; // Records left: come back after the other sources had their turn
+    (void) write(m_efd, &one, sizeof(one));
+    return bytes;
+}
+
+static inline char levelChar(int priority) {
+    static constexpr char LEVELS[] = "VDIWEF";
+    if (priority < ANDROID_LOG_VERBOSE) return 'V';
+    if (priority > ANDROID_LOG_FATAL) return 'F';
+    return LEVELS[priority - ANDROID_LOG_VERBOSE];
+}
+
+/**
+ * EMIT
+ * Renders the record as `-v time` lines (one per message line, like logcat) so the text
+ * output is identical to the fork path; the fields go along pre-parsed.
+ */
+void LiblogSource::emit(LineSink &sink, bool &ok) {
+    RecordHeader h;
+    memcpy(&h, m_record.data(), sizeof(h));
+    std::string_view tag(m_record.data() + sizeof(h), h.tagLen);
+    std::string_view message(tag.data() + h.tagLen, h.msgLen);
+    const char level = levelChar(h.priority);
+    if (h.bufferId >= 32 || !(m_bufferMask & (1u << h.bufferId)) || !m_filter.allows(tag, level)) return;
+
+    size_t pos = 0;
+    do {
+        size_t nl = message.find('\n', pos);
+        if (nl == std::string_view::npos) nl = message.size();
+        std::string_view part = message.substr(pos, nl - pos);
+        pos = nl + 1;
+
+        LogRecord rec;
+        std::string_view line = m_renderer.render(m_line, sink.lineFormat(), h.timeNs, level, tag, h.pid, h.tid,
+                                                  part, rec);
+        rec.bufferId = h.bufferId;
+        ok = sink.onSourceLine(line, &rec) && ok;
+    } while (pos < message.size()); // A trailing '\n' does not produce an empty line
+}
@@ -0,0 +1,116 @@
+#ifndef LIBLOG_SOURCE_HPP
+#define LIBLOG_SOURCE_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "LogSource.hpp"
+
+/**
+ * Layout of liblog's `struct __android_log_message` (API 30). Mirrored here because the
+ * hook is resolved at runtime (minSdk 24) and older NDK headers do not declare it.
+ */
+struct LiblogMessage {
+    size_t struct_size;
+    int32_t buffer_id;
+    int32_t priority;
+    const char *tag;
+    const char *file;
+    uint32_t line;
+    const char *message;
+};
+
+/**
+ * IN-PROCESS CAPTURE through `__android_log_set_logger` (Android 11+).
+ *
+ * Every log call of the app (Java Log.*, native __android_log_*) reaches the hook on the
+ * calling thread. The hook forwards it to liblog's default logger, so logd/logcat still
+ * see everything, then copies it into a bounded lock-free MPSC queue and wakes the worker
+ * through an eventfd. Compared with forking logcat there is no process, no logd round trip
+ * and no text parsing: records arrive with their fields.
+ *
+ * Lines of the engine's own "LogcatEngine-*" tags are never queued: the worker logs while
+ * processing, and capturing that would feed itself.
+ */
+class LiblogSource : public LogSource {
+public:
+    LiblogSource() = default;
+    ~LiblogSource() override;
+
+    LiblogSource(const LiblogSource &) = delete;
+    LiblogSource &operator=(const LiblogSource &) = delete;
+
+    /**
+     * Whether this device's liblog exports the logger hook (resolved once).
+     */
+    static bool available();
+
+    /**
+     * Buffers the hook can supply for this process: the text buffers its own liblog writes
+     * to. Binary events, the kernel log and entries written by other processes (which
+     * `--pid` would drop anyway) only come through logcat or their own sources.
+     */
+    static constexpr uint32_t SUPPLIED_BUFFERS = (1u << LOG_BUFFER_MAIN) | (1u << LOG_BUFFER_RADIO) |
+                                                 (1u << LOG_BUFFER_SYSTEM) | (1u << LOG_BUFFER_CRASH);
+
+    /**
+     * Installs the hook. Lines are filtered like `logcat <tagFilter>` / `*:<level>`.
+     * @param bufferMask Bit per LogBuffer id to keep (crash buffer entries of the app, ...).
+     * @return false if the hook is unavailable or another instance is installed.
+     */
+    bool install(const std::string &level, const std::string &tagFilter, uint32_t bufferMask);
+
+    /**
+     * Restores liblog's default logger; waits for hook calls in flight to leave the queue.
+     */
+    void uninstall();
+
+    bool installed() const { return m_efd >= 0; }
+
+    /**
+     * Records lost because the queue was full (log calls never block on the engine).
+     */
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    const char *name() const override { return "liblog"; }
+    int pollFd() const override { return m_efd; }
+    ssize_t drain(LineSink &sink) override;
+
+private:
+    /**
+     * QUEUE SLOT
+     * A record (header + tag + message) spans one or more consecutive slots. `seq` follows
+     * Vyukov's bounded queue: pos when free, pos + 1 when published.
+     */
+    static constexpr size_t SLOT_BYTES = 256;
+    static constexpr size_t SLOT_COUNT = 2048; // 512KB, allocated on install
+    struct Slot {
+        std::atomic<uint64_t> seq;
+        uint32_t count;  // Slots of the record (first slot only)
+        uint32_t bytes;  // Serialized record size (first slot only)
+        char data[SLOT_BYTES - 16];
+    };
+    static_assert(sizeof(Slot) == SLOT_BYTES, "Slot must stay a power of two");
+
+    static void hookLogger(const LiblogMessage *msg);
+    void push(const LiblogMessage *msg);
+    bool pop(); // Next record into m_record; false if none is published
+    void signal();
+    void emit(LineSink &sink, bool &ok);
+
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<uint64_t> m_enqueue{0};
+    alignas(64) uint64_t m_dequeue = 0;         // Worker only
+    std::atomic<bool> m_armed{true};            // Worker is (about to be) waiting on the eventfd
+    std::atomic<uint64_t> m_dropped{0};
+    int m_efd = -1;
+
+    LevelFilter m_filter;
+    uint32_t m_bufferMask = 0;
+    std::string m_record;       // Dequeued record, contiguous
+    std::string m_line;         // Rendered `-v time` line of the record being emitted
+    TimeLineRenderer m_renderer;
+};
+
+#endif // LIBLOG_SOURCE_HPP
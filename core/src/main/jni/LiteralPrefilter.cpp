@@ -0,0 +1,247 @@
+#include "LiteralPrefilter.hpp"
+#include <vector>
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+static inline char foldAscii(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c | 0x20) : c;
+}
+
+static inline bool isAsciiLetter(char c) {
+    const char lower = static_cast<char>(c | 0x20);
+    return lower >= 'a' && lower <= 'z';
+}
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * PATTERN WALK
+ * One ECMAScript sequence, up to the ')' closing it or the end of the pattern. Literal
+ * characters accumulate into the current run; any other atom ends it. Groups contribute
+ * their own runs when they are mandatory (no quantifier allowing zero repetitions, not a
+ * lookahead, no '|' inside).
+ * @return false if the sequence contains a top-level '|' (nothing in it is required).
+ */
+static bool walkSequence(std::string_view p, size_t &i, std::vector<std::string> &out, bool &ok) {
+    std::string run;
+    bool alternation = false;
+    auto endRun = [&]() {
+        if (!run.empty()) out.push_back(run);
+        run.clear();
+    };
+
+    while (ok && i < p.size() && p[i] != ')') {
+        const char c = p[i];
+        int literal = -1;     // Byte of a literal atom, -1 for any other atom
+        bool group = false;
+        bool groupRequired = false;
+        std::vector<std::string> inner;
+
+        if (c == '|') {
+            alternation = true;
+            endRun();
+            ++i;
+            continue;
+        } else if (c == '\\') {
+            if (unlikely(i + 1 >= p.size())) {
+                ok = false;
+                break;
+            }
+            const char e = p[i + 1];
+            i += 2;
+            switch (e) {
+                case 'n': literal = '\n'; break;
+                case 't': literal = '\t'; break;
+                case 'r': literal = '\r'; break;
+                case 'f': literal = '\f'; break;
+                case 'v': literal = '\v'; break;
+                case 'x': i += 2; break;                         // \xHH
+                case 'u': i += 4; break;                         // \uHHHH
+                case 'c': i += 1; break;                         // \cX
+                default:
+                    if (isDigit(e)) {
+                        while (i < p.size() && isDigit(p[i])) ++i; // \0 or a back-reference
+                    } else if (!isAsciiLetter(e)) {
+                        literal = static_cast<unsigned char>(e);  // Escaped punctuation
+                    }                                             // \d \w \s \b ...: not a literal
+            }
+        } else if (c == '[') {
+            // Classes are skipped whole; ']' right after '[' or "[^" closes an empty class
+            ++i;
+            if (i < p.size() && p[i] == '^') ++i;
+            while (i < p.size() && p[i] != ']') i += p[i] == '\\' ? 2 : 1;
+            if (unlikely(i >= p.size())) {
+                ok = false;
+                break;
+            }
+            ++i;
+        } else if (c == '(') {
+            ++i;
+            bool lookahead = false;
+            if (p.compare(i, 2, "?:") == 0) {
+                i += 2;
+            } else if (i < p.size() && p[i] == '?') {
+                lookahead = true;
+                i += 2;
+            }
+            const bool sequence = walkSequence(p, i, inner, ok);
+            if (unlikely(i >= p.size())) { // Unbalanced
+                ok = false;
+                break;
+            }
+            ++i;
+            group = true;
+            groupRequired = sequence && !lookahead;
+        } else if (c == '*' || c == '+' || c == '?') {
+            ok = false; // Nothing to repeat: std::regex rejects it too
+            break;
+        } else if (c == '.' || c == '^' || c == '$' || c == '{' || c == '}' || c == ']') {
+            ++i;
+        } else {
+            literal = static_cast<unsigned char>(c);
+            ++i;
+        }
+
+        // Quantifier of the atom
+        size_t minRepeat = 1;
+        bool quantified = false;
+        if (i < p.size()) {
+            const char q = p[i];
+            if (q == '*' || q == '?') {
+                minRepeat = 0;
+                quantified = true;
+                ++i;
+            } else if (q == '+') {
+                quantified = true;
+                ++i;
+            } else if (q == '{' && i + 1 < p.size() && isDigit(p[i + 1])) {
+                minRepeat = 0;
+                for (++i; i < p.size() && isDigit(p[i]); ++i) {
+                    minRepeat = std::min<size_t>(minRepeat * 10 + (p[i] - '0'), 1000);
+                }
+                while (i < p.size() && p[i] != '}') ++i;
+                if (i < p.size()) ++i;
+                quantified = true;
+            }
+            if (quantified && i < p.size() && p[i] == '?') ++i; // Lazy
+        }
+
+        if (literal >= 0) {
+            if (minRepeat == 0) {
+                endRun();
+            } else {
+                run.push_back(foldAscii(static_cast<char>(literal)));
+                if (quantified) endRun(); // Repetitions break contiguity with what follows
+            }
+        } else {
+            endRun();
+            if (group && groupRequired && minRepeat > 0) out.insert(out.end(), inner.begin(), inner.end());
+        }
+    }
+    endRun();
+    return !alternation;
+}
+
+bool LiteralPrefilter::compile(std::string_view pattern) {
+    m_count = 0;
+    std::vector<std::string> runs;
+    size_t i = 0;
+    bool ok = true;
+    const bool sequence = walkSequence(pattern, i, runs, ok);
+    if (!ok || !sequence || i != pattern.size()) return false; // Top-level '|' or stray ')'
+
+    // Longest first; a run contained in a kept one adds nothing. Single characters are
+    // too common to pay for a scan of their own.
+    std::stable_sort(runs.begin(), runs.end(),
+                     [](const std::string &a, const std::string &b) { return a.size() > b.size(); });
+    for (const std::string &run: runs) {
+        if (run.size() < 2 || m_count == MAX_LITERALS) break;
+        bool redundant = false;
+        for (size_t k = 0; k < m_count && !redundant; ++k) {
+            redundant = m_literals[k].find(run) != std::string::npos;
+        }
+        if (!redundant) m_literals[m_count++] = run;
+    }
+    return m_count > 0;
+}
+
+bool LiteralPrefilter::mayMatch(std::string_view text) const {
+    for (size_t k = 0; k < m_count; ++k) {
+        if (findFolded(text, m_literals[k]) == std::string_view::npos) return false;
+    }
+    return true;
+}
+
+static inline bool equalsFolded(const char *h, const char *needle, size_t n) {
+    for (size_t k = 0; k < n; ++k) {
+        if (foldAscii(h[k]) != needle[k]) return false;
+    }
+    return true;
+}
+
+/**
+ * SUBSTRING SEARCH
+ * Compares the needle's first and last bytes against 16 haystack positions per step and
+ * verifies only where both agree. For a letter, OR-ing 0x20 into the haystack folds
+ * exactly its two cases onto the needle byte; other bytes compare as they are.
+ */
+size_t findFolded(std::string_view haystack, std::string_view needle) {
+    const size_t n = needle.size(), size = haystack.size();
+    if (unlikely(n == 0)) return 0;
+    if (n > size) return std::string_view::npos;
+    const char *h = haystack.data();
+    const char first = needle[0], last = needle[n - 1];
+    const uint8_t firstFold = isAsciiLetter(first) ? 0x20 : 0;
+    const uint8_t lastFold = isAsciiLetter(last) ? 0x20 : 0;
+    size_t i = 0;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const uint8x16_t vFirst = vdupq_n_u8(static_cast<uint8_t>(first)), vLast = vdupq_n_u8(static_cast<uint8_t>(last));
+    const uint8x16_t vFirstFold = vdupq_n_u8(firstFold), vLastFold = vdupq_n_u8(lastFold);
+    for (; i + n - 1 + 16 <= size; i += 16) {
+        const uint8x16_t a = vorrq_u8(vld1q_u8(reinterpret_cast<const uint8_t *>(h + i)), vFirstFold);
+        const uint8x16_t b = vorrq_u8(vld1q_u8(reinterpret_cast<const uint8_t *>(h + i + n - 1)), vLastFold);
+        const uint8x16_t eq = vandq_u8(vceqq_u8(a, vFirst), vceqq_u8(b, vLast));
+        // 4 bits per byte: no movemask on NEON
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        while (mask) {
+            const unsigned bit = static_cast<unsigned>(__builtin_ctzll(mask)) & ~3u;
+            if (equalsFolded(h + i + (bit >> 2) + 1, needle.data() + 1, n < 2 ? 0 : n - 2)) return i + (bit >> 2);
+            mask &= ~(0xFULL << bit);
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i vFirst = _mm_set1_epi8(first), vLast = _mm_set1_epi8(last);
+    const __m128i vFirstFold = _mm_set1_epi8(static_cast<char>(firstFold));
+    const __m128i vLastFold = _mm_set1_epi8(static_cast<char>(lastFold));
+    for (; i + n - 1 + 16 <= size; i += 16) {
+        const __m128i a = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(h + i)), vFirstFold);
+        const __m128i b = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(h + i + n - 1)), vLastFold);
+        uint32_t mask = static_cast<uint32_t>(
+                _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, vFirst), _mm_cmpeq_epi8(b, vLast))));
+        while (mask) {
+            const unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (equalsFolded(h + i + bit + 1, needle.data() + 1, n < 2 ? 0 : n - 2)) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i + n <= size; ++i) {
+        if (static_cast<char>(h[i] | firstFold) == first && static_cast<char>(h[i + n - 1] | lastFold) == last &&
+            equalsFolded(h + i + 1, needle.data() + 1, n < 2 ? 0 : n - 2)) {
+            return i;
+        }
+    }
+    return std::string_view::npos;
+}
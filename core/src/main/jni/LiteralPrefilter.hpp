@@ -0,0 +1,62 @@
+#ifndef LITERAL_PREFILTER_HPP
+#define LITERAL_PREFILTER_HPP
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * REQUIRED-LITERAL PREFILTER
+ *
+ * Most filters contain substrings every match must include: "Http.*timeout" cannot match
+ * a line without both "http" and "timeout". compile() walks the ECMAScript pattern once
+ * and keeps such literals; mayMatch() looks for them with a vectorized case-insensitive
+ * search, so lines that cannot match never reach std::regex.
+ *
+ * The analysis is conservative: anything it does not fully understand (classes, '.',
+ * escapes like \d, alternation, optional atoms and groups, lookarounds) ends the current
+ * literal rather than guessing, so a rejected line is always a line the regex rejects.
+ * A top-level '|' disables the prefilter.
+ *
+ * Matching follows the filter's icase flag: ASCII letters are folded, other bytes
+ * (UTF-8 included) compare exactly, as std::regex<char> does under the "C" locale.
+ */
+class LiteralPrefilter {
+public:
+    static constexpr size_t MAX_LITERALS = 4;
+
+    /**
+     * Extracts the required literals of `pattern` (replacing the previous ones).
+     * @return true if at least one was found, i.e. the prefilter is active.
+     */
+    bool compile(std::string_view pattern);
+
+    void clear() { m_count = 0; }
+
+    bool active() const { return m_count > 0; }
+
+    /**
+     * @return false only if `text` lacks a required literal (the regex cannot match).
+     */
+    bool mayMatch(std::string_view text) const;
+
+    /**
+     * Literal i, lower-cased; ordered longest first (the most selective is tried first).
+     */
+    const std::string &literal(size_t i) const { return m_literals[i]; }
+    size_t count() const { return m_count; }
+
+private:
+    std::string m_literals[MAX_LITERALS];
+    size_t m_count = 0;
+};
+
+/**
+ * ASCII case-insensitive substring search.
+ * @param needle Lower-cased, non-empty.
+ * @return the offset of the first occurrence, or std::string_view::npos.
+ */
+size_t findFolded(std::string_view haystack, std::string_view needle);
+
+#endif // LITERAL_PREFILTER_HPP
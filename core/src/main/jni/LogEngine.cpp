@@ -11,6 +11,7 @@
 #include <string_view>
 #include <memory>
 #include <string>
+#include <algorithm>
 #include <android/log.h>
 
 /**
@@ -26,16 +27,27 @@
 #define unlikely(x)     __builtin_expect(!!(x), 0)
 
 /**
- * READ BUFFER: 128KB provides a good balance between memory usage and
- * throughput for heavy I/O operations.
+ * BUFFER LIMITS for LogConfig values. The defaults (128KB reads, 200ms epoll timeout)
+ * balance memory against throughput; these bounds only reject unusable settings.
  */
-static constexpr size_t READ_BUFFER_SIZE = 128 * 1024;
+static constexpr uint32_t MAX_READ_BUFFER_SIZE = 4 * 1024 * 1024;
+static constexpr uint32_t MIN_POLL_TIMEOUT_MS = 10;
+static constexpr uint32_t MAX_POLL_TIMEOUT_MS = 5000;
 
 /**
- * EPOLL TIMEOUT: 200ms ensures we don't hog the CPU while staying
- * responsive to thread stop signals.
+ * AUTO-TUNE: a read that fills the whole buffer means more data was already waiting.
+ * After AUTO_TUNE_FULL_READS such reads in a row the read buffer doubles (up to its
+ * quota); a drop towards Kotlin doubles the pipe. After AUTO_TUNE_IDLE_MS without data
+ * both halve again, down to their floors.
  */
-static constexpr int EPOLL_TIMEOUT_MS = 200;
+static constexpr uint32_t AUTO_TUNE_FULL_READS = 8;
+static constexpr uint32_t AUTO_TUNE_IDLE_MS = 10000;
+
+/**
+ * MATCH SPANS: highlight ranges reported per record in framed mode; further matches
+ * only set RECORD_FLAG_SPANS_TRUNCATED.
+ */
+static constexpr uint16_t MAX_MATCH_SPANS = 32;
 
 LogEngine::LogEngine() {
     /**
@@ -69,21 +81,172 @@ int LogEngine::start(const LogConfig &cfg) {
         return -1;
     }
 
+    m_config = cfg;
+    m_config.readBufferSize = std::clamp<uint32_t>(cfg.readBufferSize,
+                                                   MemoryBudget::minSize(MemComponent::ReadBuffer),
+                                                   MAX_READ_BUFFER_SIZE);
+    m_config.pollTimeoutMs = std::clamp(cfg.pollTimeoutMs, MIN_POLL_TIMEOUT_MS, MAX_POLL_TIMEOUT_MS);
+    m_config.pipeSize = std::min<uint32_t>(cfg.pipeSize, BatchWriter::pipeMaxSize());
+    m_config.accumulatorCap = std::max(cfg.accumulatorCap, m_config.readBufferSize);
+
     /**
      * PIPE CAPACITY OPTIMIZATION
-     * Set buffer to 1MB to handle high-velocity logs without blocking the producer.
+     * A large buffer (1MB by default) absorbs log bursts without blocking the producer.
+     * Not fatal if refused: the default pipe size still works.
      */
-    if (fcntl(p_kt[1], F_SETPIPE_SZ, 1024 * 1024) == -1) {
-        __android_log_print(ANDROID_LOG_WARN, TAG,
-                            "start(): F_SETPIPE_SZ failed: %s", strerror(errno));
-        // Not fatal, continue with default pipe size
-    }
+    int pipeSize = BatchWriter::setPipeSize(p_kt[1], static_cast<int>(m_config.pipeSize));
+    __android_log_print(ANDROID_LOG_INFO, TAG, "start(): pipe %d bytes (requested %u, max %d), read %u bytes",
+                        pipeSize, m_config.pipeSize, BatchWriter::pipeMaxSize(), m_config.readBufferSize);
+
+    m_memory.setBaseSize(MemComponent::Pipe, m_config.pipeSize);
+    m_memory.setBaseSize(MemComponent::ReadBuffer, m_config.readBufferSize);
+    m_memory.setBaseSize(MemComponent::Accumulator, m_config.accumulatorCap);
 
-    m_config = cfg;
     if (!cfg.customRegex.empty()) updateRegex(cfg.customRegex);
+    setReassemblyWindow(cfg.reassemblyWindowMs);
+
+    /**
+     * LINE FORMAT
+     * logcat prints the configured -v options and the sources render the same layout, so
+     * one parser handles every input and the UI sees a single format.
+     */
+    if (!m_line_format.configure(m_config.format)) {
+        __android_log_print(ANDROID_LOG_WARN, TAG, "start(): unknown option in format '%s'", m_config.format.c_str());
+    }
+
+    m_assembler.setExactTimestamps(m_line_format.layout == LineFormat::THREADTIME &&
+                                   m_line_format.fractionDigits > 3);
+
+    m_utf8_repair = m_config.utf8HexEscape ? Utf8Repair::HEX : Utf8Repair::REPLACE;
+
+    // Output template: compiled once; an invalid one leaves the lines as they are
+    if (!m_formatter.compile(m_config.outputTemplate)) {
+        __android_log_print(ANDROID_LOG_WARN, TAG, "start(): invalid output template '%s'",
+                            m_config.outputTemplate.c_str());
+    }
+
+    /**
+     * BUFFERS
+     * One `-b` per requested buffer: logcat merges them itself and marks every switch
+     * ("--------- switch to crash"), which is how lines get their buffer id.
+     * The events buffer is read in binary and decoded natively when the event-log-tags
+     * dictionary is available (EventsSource); logcat's text rendering is the fallback.
+     * The kernel buffer is read from /dev/kmsg where the process may (KmsgSource), and
+     * from logd's `-b kernel` otherwise.
+     */
+    uint32_t bufferMask = 0;  // Requested buffers
+    uint32_t logcatMask = 0;  // Of those, the ones left to a logcat child
+    std::string bufferArgs;
+    bool nativeEvents = false;
+    bool nativeKernel = false;
+    for (size_t pos = 0; pos < m_config.logBuffers.size();) {
+        size_t end = std::min(m_config.logBuffers.find(',', pos), m_config.logBuffers.size());
+        std::string name = m_config.logBuffers.substr(pos, end - pos);
+        name.erase(std::remove(name.begin(), name.end(), ' '), name.end());
+        pos = end + 1;
+        int id = logBufferId(name);
+        if (id < 0) {
+            if (!name.empty()) __android_log_print(ANDROID_LOG_WARN, TAG, "start(): unknown buffer '%s'", name.c_str());
+            continue;
+        }
+        bufferMask |= 1u << id;
+        if (id == LOG_BUFFER_EVENTS && EventLogTags::system().size() > 0) nativeEvents = true;
+        else if (id == LOG_BUFFER_KERNEL) nativeKernel = true;
+        else logcatMask |= 1u << id;
+    }
+    const bool defaultBuffers = bufferMask == 0; // logcat's own default: main, system, crash
+    if (defaultBuffers) {
+        bufferMask = (1u << LOG_BUFFER_MAIN) | (1u << LOG_BUFFER_SYSTEM) | (1u << LOG_BUFFER_CRASH);
+        logcatMask = bufferMask;
+    }
+
+    m_sources.clear();
+
+    /**
+     * IN-PROCESS CAPTURE
+     * Capturing our own pid with logcat costs a process and a logd round trip per line;
+     * the liblog hook delivers the same lines directly. Older devices keep the fork path.
+     * The hook only replaces logcat for the buffers it can supply (see below).
+     */
+    uint32_t hookMask = 0;
+    if (m_config.inProcess && m_config.pid == std::to_string(getpid()) &&
+        m_liblog.install(m_config.level, m_config.tagFilter, bufferMask)) {
+        m_sources.push_back(&m_liblog);
+        hookMask = LiblogSource::SUPPLIED_BUFFERS;
+    }
+    if (m_config.captureStdio) {
+        for (StdioSource *stdio: {&m_stdout, &m_stderr}) {
+            if (stdio->install(m_config.level, m_config.tagFilter, m_config.accumulatorCap)) m_sources.push_back(stdio);
+        }
+    }
+    if (nativeEvents) {
+        if (m_events.install(EventLogTags::system(), m_config.pid, m_config.level, m_config.tagFilter)) {
+            m_sources.push_back(&m_events);
+        } else {
+            logcatMask |= 1u << LOG_BUFFER_EVENTS; // Text rendering by logcat instead
+        }
+    }
+    if (nativeKernel) {
+        if (m_kmsg.install(m_config.kernelLogPath, m_config.level, m_config.tagFilter)) {
+            m_sources.push_back(&m_kmsg);
+        } else {
+            logcatMask |= 1u << LOG_BUFFER_KERNEL; // logd's copy instead of /dev/kmsg
+        }
+    }
+
+    /**
+     * LOGCAT CHILD
+     * Decided once every source is known: logcat runs for the buffers no in-process
+     * source supplies, and is asked for those only (the hook's buffers would arrive twice).
+     */
+    const uint32_t logcatNeeded = logcatMask & ~hookMask;
+    m_use_logcat = logcatNeeded != 0;
+    if (!(defaultBuffers && logcatNeeded == logcatMask)) {
+        for (uint8_t id = 0; id <= LOG_BUFFER_KERNEL; ++id) {
+            if (logcatNeeded & (1u << id)) bufferArgs += " -b " + std::string(logBufferName(id));
+        }
+    }
+
+    /**
+     * PACKAGE FILTER
+     * Like --pid, but by name and surviving restarts of the app: records are matched on
+     * the package of their pid (ProcessNames), so other processes can be captured too.
+     */
+    m_packages.clear();
+    for (size_t pos = 0; pos < m_config.packageFilter.size();) {
+        size_t end = std::min(m_config.packageFilter.find(',', pos), m_config.packageFilter.size());
+        std::string name = m_config.packageFilter.substr(pos, end - pos);
+        name.erase(std::remove(name.begin(), name.end(), ' '), name.end());
+        pos = end + 1;
+        if (!name.empty()) m_packages.push_back(name);
+    }
+    m_resolve_names = !m_packages.empty() || m_formatter.usesNames();
+    m_names.clear();
+
+    // Files written by SDKs: "path[|timestamp format]" entries separated by ';'
+    m_tails.clear();
+    for (size_t pos = 0; pos < m_config.tailFiles.size();) {
+        size_t end = std::min(m_config.tailFiles.find(';', pos), m_config.tailFiles.size());
+        std::string entry = m_config.tailFiles.substr(pos, end - pos);
+        pos = end + 1;
+        if (entry.empty()) continue;
+        size_t bar = entry.find('|');
+        std::string format = bar == std::string::npos ? std::string() : entry.substr(bar + 1);
+        if (bar != std::string::npos) entry.resize(bar);
+
+        auto tail = std::make_unique<FileTailSource>();
+        if (tail->install(entry, format, m_config.level, m_config.tagFilter, m_config.accumulatorCap)) {
+            m_sources.push_back(tail.get());
+            m_tails.push_back(std::move(tail));
+        }
+    }
+
+    // Several inputs are merged by timestamp; a single one passes straight through
+    m_source_base = m_use_logcat ? 1 : 0;
+    m_merger.configure(m_source_base + m_sources.size(), m_config.mergeDelayMs);
 
     // Build the logcat shell command
-    std::string cmd = "/system/bin/logcat -v time";
+    std::string cmd = "/system/bin/logcat" + m_line_format.logcatArgs() + bufferArgs;
     if (!m_config.pid.empty()) cmd += " --pid=" + m_config.pid;
     cmd += (m_config.tagFilter.empty()) ? " *:" + m_config.level : " " + m_config.tagFilter;
 
@@ -94,6 +257,12 @@ int LogEngine::start(const LogConfig &cfg) {
         close(p_kt[0]);
         close(p_kt[1]);
         delete args;
+        m_liblog.uninstall();
+        m_stdout.uninstall();
+        m_stderr.uninstall();
+        m_events.uninstall();
+        m_kmsg.uninstall();
+        m_tails.clear();
         m_running.store(false);
         return -1;
     }
@@ -115,6 +284,12 @@ void LogEngine::stop() {
         pthread_join(m_thread, nullptr);
         m_thread = 0;
     }
+    m_liblog.uninstall();
+    m_stdout.uninstall();
+    m_stderr.uninstall();
+    m_events.uninstall();
+    m_kmsg.uninstall();
+    m_tails.clear();
 }
 
 /**
@@ -127,13 +302,16 @@ void *LogEngine::workerRoutine(void *arg) {
     LogEngine *engine = tArgs->engine;
 
     while (likely(engine->m_running.load(std::memory_order_acquire))) {
-        engine->runLogcatIteration(tArgs->cmd, tArgs->kotlin_write_fd);
+        if (engine->m_use_logcat) engine->runLogcatIteration(tArgs->cmd, tArgs->kotlin_write_fd);
+        else engine->processLogStream(0, -1, tArgs->kotlin_write_fd);
 
         // If engine is still running but iteration stopped, it's a crash; restart.
         if (!engine->m_running.load(std::memory_order_acquire)) break;
         usleep(500000); // Prevent CPU spin in case of persistent command failure
     }
 
+    engine->m_trigger.finish(); // A bundle in flight is finalized with what we have
+    engine->m_export.finish();
     close(tArgs->kotlin_write_fd);
     return nullptr;
 }
@@ -213,22 +391,60 @@ void LogEngine::processLogStream(pid_t child_pid, int read_fd, int kotlin_fd) {
         return;
     }
 
-    struct epoll_event ev{}, events[1];
+    // data.ptr: nullptr for the logcat pipe, the LogSource otherwise
+    struct epoll_event ev{}, events[8];
     ev.events = EPOLLIN;
-    ev.data.fd = read_fd;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, read_fd, &ev) == -1) {
+    ev.data.ptr = nullptr;
+    if (read_fd >= 0 && epoll_ctl(epoll_fd, EPOLL_CTL_ADD, read_fd, &ev) == -1) {
         __android_log_print(ANDROID_LOG_ERROR, TAG,
                             "processLogStream(): epoll_ctl(ADD) failed: %s", strerror(errno));
         close(epoll_fd);
         return;
     }
+    size_t liveSources = 0;
+    std::vector<int> polled(m_sources.size(), -1); // Registered fd per source
+    for (size_t i = 0; i < m_sources.size(); ++i) {
+        LogSource *source = m_sources[i];
+        ev.data.ptr = source;
+        if (source->pollFd() >= 0 && epoll_ctl(epoll_fd, EPOLL_CTL_ADD, source->pollFd(), &ev) == 0) {
+            polled[i] = source->pollFd();
+            liveSources++;
+        } else {
+            __android_log_print(ANDROID_LOG_WARN, TAG, "processLogStream(): source %s not polled: %s",
+                                source->name(), strerror(errno));
+        }
+    }
+    if (read_fd < 0 && liveSources == 0) {
+        close(epoll_fd);
+        return;
+    }
+
+    m_output.reset(kotlin_fd, m_config.framed);
+    Arena::setCurrent(&m_batch_arena);
 
-    auto read_buf = std::make_unique<char[]>(READ_BUFFER_SIZE);
-    std::string accumulator;
-    accumulator.reserve(READ_BUFFER_SIZE * 2);
+    StreamBuffers buffers;
+    if (read_fd >= 0) buffers.resizeRead(m_config.readBufferSize); // Sources bring their own buffers
+    buffers.accumulatorCap = m_config.accumulatorCap;
+    buffers.accumulator.reserve(std::min<size_t>(buffers.readSize * 2, buffers.accumulatorCap));
+    std::string &accumulator = buffers.accumulator;
+    m_memory_generation = 0; // Quotas are (re)applied to every new stream
+    m_tune_full_reads = m_tune_idle_ms = 0;
+    m_tune_dropped = m_output.droppedRecords();
+    m_logcat_buffer = LOG_BUFFER_MAIN; // A new logcat announces its buffers again
+    for (size_t i = 0; i < m_source_base + m_sources.size(); ++i) m_merger.setLive(i, true);
 
-    while (likely(m_running.load(std::memory_order_acquire))) {
-        int nfds = epoll_wait(epoll_fd, events, 1, EPOLL_TIMEOUT_MS);
+    bool streaming = true;
+    while (likely(streaming && m_running.load(std::memory_order_acquire))) {
+        if (unlikely(m_memory.generation() != m_memory_generation)) applyMemoryBudget(buffers);
+
+        // A pending multi-line event must not wait longer than its window
+        int timeout = static_cast<int>(m_config.pollTimeoutMs);
+        if (m_assembler.hasPending()) {
+            timeout = std::min(timeout, m_assembler.msUntilExpiry(TriggerCapture::monotonicMs()));
+        }
+        int mergeWait = m_merger.msUntilRelease(TriggerCapture::monotonicMs());
+        if (mergeWait >= 0) timeout = std::min(timeout, mergeWait);
+        int nfds = epoll_wait(epoll_fd, events, 8, timeout);
 
         if (unlikely(nfds < 0)) {
             if (errno == EINTR) continue;
@@ -238,6 +454,21 @@ void LogEngine::processLogStream(pid_t child_pid, int read_fd, int kotlin_fd) {
         }
 
         if (nfds == 0) { // Timeout: Check if child is still alive
+            const uint64_t nowMs = TriggerCapture::monotonicMs();
+            if (m_config.autoTune && read_fd >= 0) tuneWhileIdle(buffers, static_cast<uint32_t>(timeout));
+            m_trigger.tick(nowMs);
+            m_export.tick(nowMs);
+            if (m_merger.msUntilRelease(nowMs) == 0) { // Merged lines whose delay ran out
+                beginBatch();
+                endBatch(0);
+            }
+            if (m_assembler.hasPending() && m_assembler.expired(nowMs)) {
+                flushPendingEvent();
+                m_output.flush();
+                m_batch_arena.reset();
+            }
+            if (child_pid <= 0) continue; // Sources only: nothing to watch
+
             int status;
             pid_t r = waitpid(child_pid, &status, WNOHANG);
             if (r == -1 && errno != ECHILD) {
@@ -248,87 +479,448 @@ void LogEngine::processLogStream(pid_t child_pid, int read_fd, int kotlin_fd) {
             continue;
         }
 
-        ssize_t bytes = read(read_fd, read_buf.get(), READ_BUFFER_SIZE);
-        if (unlikely(bytes <= 0)) {
-            if (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
-                __android_log_print(ANDROID_LOG_WARN, TAG,
-                                    "processLogStream(): read() failed: %s", strerror(errno));
+        for (int i = 0; i < nfds; ++i) {
+            if (events[i].data.ptr) {
+                auto *source = static_cast<LogSource *>(events[i].data.ptr);
+                const size_t index = std::find(m_sources.begin(), m_sources.end(), source) - m_sources.begin();
+                m_batch_input = m_source_base + index;
+                beginBatch();
+                ssize_t consumed = source->drain(*this);
+                endBatch(consumed > 0 ? static_cast<size_t>(consumed) : 0);
+                if (unlikely(consumed < 0)) {
+                    __android_log_print(ANDROID_LOG_INFO, TAG, "processLogStream(): source %s ended",
+                                        source->name());
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, polled[index], nullptr);
+                    polled[index] = -1;
+                    m_merger.setLive(m_batch_input, false);
+                    if (--liveSources == 0 && read_fd < 0) streaming = false;
+                } else if (unlikely(source->pollFd() != polled[index])) {
+                    // The source reopened (restarted child, rotated file): follow its new fd
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, polled[index], nullptr); // Fails if already closed
+                    polled[index] = source->pollFd();
+                    ev.data.ptr = source;
+                    if (polled[index] >= 0) epoll_ctl(epoll_fd, EPOLL_CTL_ADD, polled[index], &ev);
+                }
+                continue;
             }
-            break;
+
+            ssize_t bytes = read(read_fd, buffers.read.get(), buffers.readSize);
+            if (unlikely(bytes <= 0)) {
+                if (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    __android_log_print(ANDROID_LOG_WARN, TAG,
+                                        "processLogStream(): read() failed: %s", strerror(errno));
+                }
+                streaming = false;
+                break;
+            }
+
+            accumulator.append(buffers.read.get(), static_cast<size_t>(bytes));
+            m_batch_input = 0;
+            beginBatch();
+
+            /**
+             * FAST PARSING
+             * Scanning for newlines and using string_view to avoid allocations.
+             */
+            size_t pos = 0, next;
+            while ((next = accumulator.find('\n', pos)) != std::string::npos) {
+                bool ok = acceptLine(std::string_view(&accumulator[pos], next - pos), nullptr);
+                pos = next + 1;
+                if (unlikely(!ok)) break;
+            }
+            accumulator.erase(0, pos);
+            endBatch(static_cast<size_t>(bytes));
+            if (m_config.autoTune) tuneAfterBatch(buffers, static_cast<size_t>(bytes));
+            reportMemoryUsage(buffers);
+
+            // Safety: Prevent memory leak if log stream has no newlines
+            if (unlikely(accumulator.size() > buffers.accumulatorCap)) accumulator.clear();
         }
+    }
 
-        accumulator.append(read_buf.get(), static_cast<size_t>(bytes));
+    // Whatever was being merged or assembled is complete now that the stream ended
+    if (!m_merger.empty()) {
+        beginBatch();
+        releaseMerged(m_batch_ms, true);
+    }
+    if (m_assembler.hasPending()) flushPendingEvent();
+    m_output.flush();
+    m_batch_arena.reset();
+    Arena::setCurrent(nullptr);
+    close(epoll_fd);
+}
 
-        /**
-         * FAST PARSING
-         * Scanning for newlines and using string_view to avoid allocations.
-         */
-        size_t pos = 0, next;
-        while ((next = accumulator.find('\n', pos)) != std::string::npos) {
-            std::string_view line(&accumulator[pos], next - pos);
+void LogEngine::beginBatch() {
+    m_batch_ms = TriggerCapture::monotonicMs();
+    m_batch_rules = m_extractor.snapshot(); // One atomic load per batch
+    m_batch_lines = 0;
+    m_batch_filter_checks = 0;
+    m_batch_prefilter_skips = 0;
 
-            bool match = true;
-            // Hot-path Regex filtering with Spinlock protection
-            if (m_regex_ready.load(std::memory_order_acquire)) {
+    // Window changes apply between batches; disabling reassembly releases a pending event
+    m_batch_window = m_reassembly_window_ms.load(std::memory_order_relaxed);
+    if (unlikely(m_batch_window != m_assembler.windowMs())) {
+        if (m_batch_window == 0) flushPendingEvent();
+        m_assembler.setWindowMs(m_batch_window);
+    }
+}
+
+void LogEngine::endBatch(size_t bytes) {
+    if (m_merger.enabled()) releaseMerged(m_batch_ms, false);
+    m_output.flush(); // One pipe write per read batch
+    m_batch_arena.reset();
+    m_bytes_read.fetch_add(bytes, std::memory_order_relaxed);
+    m_lines_read.fetch_add(m_batch_lines, std::memory_order_relaxed);
+    m_batches.fetch_add(1, std::memory_order_relaxed);
+    m_filter_checks.fetch_add(m_batch_filter_checks, std::memory_order_relaxed);
+    m_prefilter_skips.fetch_add(m_batch_prefilter_skips, std::memory_order_relaxed);
+    m_trigger.tick(m_batch_ms);
+    m_export.tick(m_batch_ms);
+}
+
+/**
+ * PROCESS LINE
+ * Every source ends up here, so trigger capture, tag ids, export and filtering behave
+ * the same whether a line came from logcat or was handed over pre-parsed.
+ */
+bool LogEngine::processLine(std::string_view line, const LogRecord *structured) {
+    m_batch_lines++;
+
+    LogRecord rec;
+    if (structured) rec = *structured;
+    else parseLogcatLine(line, rec);
+
+    // Names come from a cache; the package filter acts like --pid, before anything else
+    if (m_resolve_names && rec.valid()) {
+        m_names.resolve(rec.pid, rec.tid, m_batch_ms, rec.process, rec.thread);
+        if (!m_packages.empty() && !packageAllowed(rec.process)) return true;
+    }
+
+    // Trigger capture sees every line, independent of the user filter
+    m_trigger.onLine(line, m_batch_ms);
+
+    // Tags are interned once here; downstream stages compare 16-bit ids
+    if (rec.valid()) rec.tagId = m_tags.intern(rec.tag);
+    m_tags.countLine(rec.tagId);
+    if (m_export.wantsRecords()) m_export.onRecord(rec, line);
+
+    if (m_batch_window == 0) {
+        // No reassembly: the line (with its '\n') is the event, no copy needed
+        return deliverEvent(std::string_view(line.data(), line.size() + 1), rec.bufferId);
+    }
+    bool ok = true;
+    if (m_assembler.hasPending() && !m_assembler.continues(rec, m_batch_ms)) {
+        ok = flushPendingEvent();
+    }
+    m_assembler.append(line, rec, m_batch_ms);
+    if (unlikely(m_assembler.full())) ok = flushPendingEvent() && ok;
+    return ok;
+}
+
+bool LogEngine::packageAllowed(std::string_view process) const {
+    std::string_view package = ProcessNames::packageOf(process);
+    for (const std::string &allowed: m_packages) {
+        if (package == allowed) return true;
+    }
+    return false;
+}
+
+bool LogEngine::acceptLine(std::string_view line, const LogRecord *structured) {
+    if (likely(!m_merger.enabled())) return processLine(line, structured);
+
+    // The merge needs the timestamp now; the parsed record travels along, no second parse
+    LogRecord rec;
+    if (structured) rec = *structured;
+    else parseLogcatLine(line, rec);
+    m_merger.push(m_batch_input, line, rec, m_batch_ms);
+    return true;
+}
+
+void LogEngine::parseLogcatLine(std::string_view line, LogRecord &rec) {
+    if (unlikely(!parseLine(m_line_format, line, rec))) {
+        int buffer = parseBufferMarker(line);
+        if (buffer >= 0) m_logcat_buffer = static_cast<uint8_t>(buffer);
+    }
+    rec.bufferId = m_logcat_buffer;
+}
+
+bool LogEngine::releaseMerged(uint64_t nowMs, bool flushAll) {
+    return m_merger.release(nowMs, flushAll, [this](std::string_view line, const LogRecord &rec) {
+        return processLine(line, &rec);
+    });
+}
+
+/**
+ * DELIVER EVENT
+ * Applies the user filter to a whole event (one or more '\n'-terminated lines) and
+ * queues it in the output batch. In framed mode every match is reported as a span so
+ * the UI can highlight without re-running the regex.
+ * With an output template the filter still decides on the event as read, while spans
+ * refer to the reformatted text that is actually delivered.
+ * @return false on a severe pipe error.
+ */
+bool LogEngine::deliverEvent(std::string_view event, uint8_t bufferId) {
+    std::string_view text = event.substr(0, event.size() - 1); // Without the final '\n'
+
+    // Kotlin decodes UTF-8: invalid bytes are repaired here once, so filter, spans and
+    // templates all see the text that is delivered. Pure ASCII costs one vector scan.
+    const size_t invalid = utf8InvalidOffset(text);
+    if (unlikely(invalid != std::string_view::npos)) {
+        m_utf8_scratch.clear();
+        utf8Repair(text, invalid, m_utf8_repair, m_utf8_scratch);
+        m_utf8_scratch.push_back('\n');
+        event = m_utf8_scratch;
+        text = event.substr(0, event.size() - 1);
+        m_utf8_repaired.fetch_add(1, std::memory_order_relaxed);
+    }
+    const bool framed = m_output.framed();
+    const bool formatted = m_formatter.active();
+
+    // Sub-match storage comes from the batch arena: no heap traffic per event
+    ArenaMatch m{ArenaAllocator<std::csub_match>(m_batch_arena)};
+    MatchSpan spans[MAX_MATCH_SPANS];
+    uint16_t spanCount = 0;
+    uint16_t flags = static_cast<uint16_t>(bufferId << RECORD_BUFFER_SHIFT) & RECORD_BUFFER_MASK;
+    bool filterPass = true;
+    // Hot-path Regex filtering with Spinlock protection
+    if (m_regex_ready.load(std::memory_order_acquire)) {
+        while (m_regex_lock.test_and_set(std::memory_order_acquire));
+        ++m_batch_filter_checks;
+        if (m_prefilter.active() && !m_prefilter.mayMatch(text)) {
+            filterPass = false; // A required literal is missing: the regex cannot match
+            ++m_batch_prefilter_skips;
+        } else if (!framed || formatted) {
+            filterPass = m_short_matcher.active()
+                         ? m_short_matcher.find(text) != std::string_view::npos
+                         : std::regex_search(text.data(), text.data() + text.size(), m, m_regex);
+        } else {
+            spanCount = collectSpans(text, m, spans, flags);
+            filterPass = spanCount > 0;
+        }
+        m_regex_lock.clear(std::memory_order_release);
+    }
+
+    // Extraction rules run on every event: their fields are wanted even when the UI filter is narrow
+    bool withLine = false;
+    uint64_t matchedRules = 0;
+    m_field_scratch.clear();
+    if (m_batch_rules) {
+        const auto &rules = m_batch_rules->rules;
+        matchedRules = FieldExtractor::extract(*m_batch_rules, text, m_field_scratch, m_batch_arena);
+        for (uint64_t matched = matchedRules, r = 0; matched; ++r, matched >>= 1) {
+            if ((matched & 1) && rules[r].withLine) withLine = true;
+        }
+        if (!m_field_scratch.empty()) {
+            m_field_stats.record(m_field_scratch.data(), m_field_scratch.size());
+            // Stats-only rules are aggregated here and never cross the pipe
+            auto keep = std::remove_if(m_field_scratch.begin(), m_field_scratch.end(),
+                                       [&rules](const FieldValue &v) { return !rules[v.rule].emitFields; });
+            m_field_scratch.erase(keep, m_field_scratch.end());
+        }
+    }
+
+    if (!framed) {
+        if (!(filterPass || withLine)) return true;
+        if (likely(!formatted)) return m_output.appendText(event);
+        // Rendered in place at the end of the batch
+        return m_output.appendTextWith([&](std::string &batch) {
+            formatEvent(batch, text, bufferId, matchedRules);
+            batch.push_back('\n');
+        });
+    }
+
+    if (filterPass || withLine) {
+        if (formatted) {
+            m_format_scratch.clear();
+            formatEvent(m_format_scratch, text, bufferId, matchedRules);
+            text = m_format_scratch;
+            if (filterPass && m_regex_ready.load(std::memory_order_acquire)) {
                 while (m_regex_lock.test_and_set(std::memory_order_acquire));
-                match = std::regex_search(line.begin(), line.end(), m_regex);
+                spanCount = collectSpans(text, m, spans, flags);
                 m_regex_lock.clear(std::memory_order_release);
             }
+        }
+        return m_output.appendRecord(text, spans, spanCount, flags,
+                                     m_field_scratch.data(), m_field_scratch.size());
+    }
+    if (!m_field_scratch.empty()) {
+        // "Instead of the line": fields only, no text
+        return m_output.appendRecord(std::string_view(), nullptr, 0, flags | RECORD_FLAG_FIELDS_ONLY,
+                                     m_field_scratch.data(), m_field_scratch.size());
+    }
+    return true;
+}
 
-            if (match) {
-                // BACKPRESSURE HANDLING: If Kotlin is slow, safeWrite will drop the frame
-                ssize_t written = safeWrite(kotlin_fd, &accumulator[pos], (next - pos) + 1);
-                if (unlikely(written < 0)) {
-                    __android_log_print(ANDROID_LOG_WARN, TAG,
-                                        "processLogStream(): safeWrite() severe error: %s", strerror(errno));
-                    break;
-                }
-                // written >= 0 but < len means frame was partially/fully dropped due to EAGAIN.
-                // This is intentional; we prefer dropping logs over blocking.
+uint16_t LogEngine::collectSpans(std::string_view text, ArenaMatch &m, MatchSpan *spans, uint16_t &flags) {
+    uint16_t spanCount = 0;
+    if (m_short_matcher.active()) {
+        // Every match has the same non-zero length: the next search starts where one ends
+        const size_t length = m_short_matcher.length();
+        for (size_t at = 0; (at = m_short_matcher.find(text, at)) != std::string_view::npos; at += length) {
+            if (spanCount == MAX_MATCH_SPANS) {
+                flags |= RECORD_FLAG_SPANS_TRUNCATED;
+                break;
             }
-            pos = next + 1;
+            spans[spanCount++] = {static_cast<uint32_t>(at), static_cast<uint32_t>(at + length)};
         }
-        accumulator.erase(0, pos);
+        return spanCount;
+    }
+    const char *begin = text.data(), *end = begin + text.size(), *cur = begin;
+    auto searchFlags = std::regex_constants::match_default;
+    while (std::regex_search(cur, end, m, m_regex, searchFlags)) {
+        if (spanCount == MAX_MATCH_SPANS) {
+            flags |= RECORD_FLAG_SPANS_TRUNCATED;
+            break;
+        }
+        spans[spanCount++] = {static_cast<uint32_t>(m[0].first - begin),
+                              static_cast<uint32_t>(m[0].second - begin)};
+        cur = m[0].second;
+        if (m.length(0) == 0) { // Empty match: step forward to guarantee progress
+            if (cur == end) break;
+            ++cur;
+        }
+        searchFlags = std::regex_constants::match_prev_avail;
+    }
+    return spanCount;
+}
 
-        // Safety: Prevent memory leak if log stream has no newlines
-        if (unlikely(accumulator.size() > READ_BUFFER_SIZE * 4)) accumulator.clear();
+/**
+ * FORMAT EVENT
+ * The event's first line is parsed again rather than carried from processLine(): the
+ * assembler only keeps text, and the parse is cheap next to the regex.
+ */
+void LogEngine::formatEvent(std::string &out, std::string_view text, uint8_t bufferId, uint64_t matchedRules) {
+    std::string_view first = text.substr(0, text.find('\n'));
+    LogRecord rec;
+    parseLine(m_line_format, first, rec);
+    rec.bufferId = bufferId;
+    if (m_formatter.usesNames() && rec.valid()) {
+        m_names.resolve(rec.pid, rec.tid, m_batch_ms, rec.process, rec.thread);
     }
-    close(epoll_fd);
+    m_formatter.render(out, m_line_format, text, rec, matchedRules);
+}
+
+bool LogEngine::flushPendingEvent() {
+    bool ok = deliverEvent(m_assembler.pending(), m_assembler.bufferId());
+    m_assembler.clear();
+    return ok;
+}
+
+void LogEngine::StreamBuffers::resizeRead(size_t bytes) {
+    if (bytes == readSize && read) return;
+    read = std::make_unique<char[]>(bytes);
+    readSize = bytes;
 }
 
 /**
- * SAFE WRITE
- * Non-blocking write to the Kotlin pipe. Handles EAGAIN to prevent blocking the engine.
+ * APPLY MEMORY BUDGET
+ * Runs on the worker between batches, so no buffer is resized while a view into it is live.
+ * With auto-tune the quotas are ceilings: buffers already tuned below them stay as they are.
  */
-ssize_t LogEngine::safeWrite(int fd, const char *buf, size_t len) {
-    size_t total = 0;
-    while (total < len) {
-        ssize_t s = write(fd, buf + total, len - total);
-        if (unlikely(s <= 0)) {
-            if (errno == EINTR) continue;
-            // EAGAIN means the 1MB buffer is full. We return to avoid blocking.
-            if (errno == EAGAIN || errno == EWOULDBLOCK) return (ssize_t) total;
-            return -1; // Severe pipe error
-        }
-        total += s;
+void LogEngine::applyMemoryBudget(StreamBuffers &buffers) {
+    m_memory_generation = m_memory.generation();
+
+    int pipeQuota = static_cast<int>(m_memory.quota(MemComponent::Pipe));
+    if (m_config.autoTune) pipeQuota = std::min(pipeQuota, m_output.pipeCapacity());
+    if (pipeQuota != m_output.pipeCapacity()) m_output.resizePipe(pipeQuota);
+
+    size_t readQuota = m_memory.quota(MemComponent::ReadBuffer);
+    if (buffers.read) buffers.resizeRead(m_config.autoTune ? std::min(readQuota, buffers.readSize) : readQuota);
+
+    buffers.accumulatorCap = m_memory.quota(MemComponent::Accumulator);
+    std::string &accumulator = buffers.accumulator;
+    if (accumulator.capacity() > buffers.accumulatorCap) {
+        std::string shrunk;
+        shrunk.reserve(std::max(accumulator.size(), std::min(buffers.readSize * 2, buffers.accumulatorCap)));
+        shrunk.append(accumulator);
+        accumulator.swap(shrunk);
+    }
+
+    m_trigger.setRingCapacity(m_memory.quota(MemComponent::TriggerRing));
+    m_assembler.setMaxBytes(m_memory.quota(MemComponent::Assembler));
+    m_batch_arena.trim(m_memory.quota(MemComponent::Arena));
+    m_export.setBlockBytes(m_memory.quota(MemComponent::Export));
+    reportMemoryUsage(buffers);
+
+    __android_log_print(ANDROID_LOG_INFO, TAG, "Memory budget applied: %zu bytes, trim level %d, pipe %d bytes",
+                        m_memory.budget(), m_memory.trimLevel(), m_output.pipeCapacity());
+}
+
+/**
+ * AUTO-TUNE (GROW)
+ * Growth is bounded by the memory quotas, so auto-tune never exceeds the budget.
+ */
+void LogEngine::tuneAfterBatch(StreamBuffers &buffers, size_t bytesRead) {
+    m_tune_idle_ms = 0;
+    m_tune_full_reads = bytesRead == buffers.readSize ? m_tune_full_reads + 1 : 0;
+
+    if (m_tune_full_reads >= AUTO_TUNE_FULL_READS) {
+        m_tune_full_reads = 0;
+        size_t grown = std::min(buffers.readSize * 2, m_memory.quota(MemComponent::ReadBuffer));
+        if (grown > buffers.readSize) buffers.resizeRead(grown);
+    }
+
+    uint64_t dropped = m_output.droppedRecords();
+    if (unlikely(dropped != m_tune_dropped)) {
+        m_tune_dropped = dropped;
+        int quota = static_cast<int>(m_memory.quota(MemComponent::Pipe));
+        if (m_output.pipeCapacity() < quota) m_output.resizePipe(std::min(m_output.pipeCapacity() * 2, quota));
     }
-    return (ssize_t) total;
+}
+
+/**
+ * AUTO-TUNE (SHRINK)
+ * Each AUTO_TUNE_IDLE_MS of silence halves the read buffer and the pipe once more.
+ */
+void LogEngine::tuneWhileIdle(StreamBuffers &buffers, uint32_t waitedMs) {
+    m_tune_full_reads = 0;
+    m_tune_idle_ms += waitedMs;
+    if (m_tune_idle_ms < AUTO_TUNE_IDLE_MS) return;
+    m_tune_idle_ms = 0;
+
+    size_t readFloor = MemoryBudget::minSize(MemComponent::ReadBuffer);
+    if (buffers.readSize > readFloor) buffers.resizeRead(std::max(buffers.readSize / 2, readFloor));
+
+    // The floor holds two full frames: framed batches keep their size after an idle period
+    const size_t pipeFloor = MemoryBudget::minSize(MemComponent::Pipe);
+    const auto pipeCapacity = static_cast<size_t>(m_output.pipeCapacity());
+    if (pipeCapacity > pipeFloor) m_output.resizePipe(static_cast<int>(std::max(pipeCapacity / 2, pipeFloor)));
+
+    if (buffers.accumulator.empty()) buffers.accumulator.shrink_to_fit();
+    reportMemoryUsage(buffers);
+}
+
+void LogEngine::reportMemoryUsage(const StreamBuffers &buffers) {
+    m_memory.setUsage(MemComponent::Pipe, static_cast<size_t>(m_output.pipeCapacity()));
+    m_memory.setUsage(MemComponent::ReadBuffer, buffers.readSize);
+    m_memory.setUsage(MemComponent::Accumulator, buffers.accumulator.capacity());
+    m_memory.setUsage(MemComponent::TriggerRing, m_trigger.memoryUsage());
+    m_memory.setUsage(MemComponent::Assembler, m_assembler.memoryUsage());
+    m_memory.setUsage(MemComponent::Arena, m_batch_arena.reservedBytes());
+    m_memory.setUsage(MemComponent::Export, m_export.memoryUsage());
 }
 
 /**
  * SET REGEX PATTERN
- * Thread-safe regex compilation using a spinlock.
+ * Thread-safe regex compilation using a spinlock. The pattern's required literals and,
+ * for short fixed-length patterns, the bit-parallel matcher are built at the same time,
+ * so regex, prefilter and matcher always swap together. std::regex is still compiled:
+ * it validates the pattern.
  */
 void LogEngine::setPattern(const std::string &pattern) {
     while (m_regex_lock.test_and_set(std::memory_order_acquire));
     try {
         if (pattern.empty()) {
+            m_prefilter.clear();
+            m_short_matcher.clear();
             m_regex_ready.store(false, std::memory_order_release);
         } else {
             // C++17 'optimize' flag improves matching speed for high-volume logs
             m_regex = std::regex(pattern, std::regex_constants::ECMAScript |
                                           std::regex_constants::icase |
                                           std::regex_constants::optimize);
+            m_prefilter.compile(pattern);
+            m_short_matcher.compile(pattern, true);
             m_regex_ready.store(true, std::memory_order_release);
         }
     } catch (...) {
@@ -352,4 +944,124 @@ void LogEngine::updateLiteral(const std::string &t) {
         esc += c;
     }
     setPattern(esc);
+}
+
+/**
+ * CONFIGURE TRIGGER
+ * Forwards to TriggerCapture; the worker applies it before processing the next line.
+ */
+void LogEngine::configureTrigger(const TriggerConfig &config) {
+    m_trigger.configure(config);
+}
+
+/**
+ * SET REASSEMBLY WINDOW
+ * 0 disables multi-line grouping; applied by the worker at the next read batch.
+ */
+void LogEngine::setReassemblyWindow(uint32_t windowMs) {
+    m_reassembly_window_ms.store(windowMs, std::memory_order_relaxed);
+}
+
+/**
+ * ADD EXTRACT RULE
+ * Rules apply from the next read batch; only framed delivery carries fields, while
+ * numeric fields feed the in-engine histograms in both modes.
+ */
+int LogEngine::addExtractRule(const std::string &pattern, bool withLine, bool emitFields) {
+    return m_extractor.addRule(pattern, withLine, emitFields);
+}
+
+std::vector<std::string> LogEngine::extractFieldNames(int ruleId) const {
+    return m_extractor.fieldNames(ruleId);
+}
+
+void LogEngine::clearExtractRules() {
+    m_extractor.clearRules();
+    m_field_stats.reset(-1);
+}
+
+bool LogEngine::fieldQuantiles(int ruleId, int field, const double *q, double *out, size_t n) {
+    return m_field_stats.quantiles(ruleId, field, q, out, n);
+}
+
+bool LogEngine::fieldSummary(int ruleId, int field, FieldSummary &out) {
+    return m_field_stats.summary(ruleId, field, out);
+}
+
+void LogEngine::resetFieldStats(int ruleId) {
+    m_field_stats.reset(ruleId);
+}
+
+/**
+ * START / STOP EXPORT
+ * The worker opens or closes the file at its next record or tick.
+ */
+void LogEngine::startExport(const std::string &path) {
+    m_export.start(path);
+}
+
+void LogEngine::stopExport() {
+    m_export.stop();
+}
+
+/**
+ * STATS
+ * Relaxed loads: each counter is exact, the snapshot as a whole is not atomic.
+ */
+EngineStats LogEngine::stats() const {
+    EngineStats s;
+    s.bytesRead = m_bytes_read.load(std::memory_order_relaxed);
+    s.linesRead = m_lines_read.load(std::memory_order_relaxed);
+    s.batches = m_batches.load(std::memory_order_relaxed);
+    s.droppedBytes = m_output.droppedBytes();
+    s.droppedRecords = m_output.droppedRecords();
+    s.arenaAllocations = m_batch_arena.heapAllocations();
+    s.arenaPeakBytes = m_batch_arena.peakBytes();
+    s.rssBytes = MemoryBudget::residentBytes();
+    s.nativeBytes = m_memory.totalUsage();
+    s.memoryBudget = m_memory.budget();
+    s.trimLevel = m_memory.trimLevel();
+    s.pipeCapacity = m_memory.usage(MemComponent::Pipe);
+    s.readBufferSize = m_memory.usage(MemComponent::ReadBuffer);
+    s.sourceDropped = m_liblog.dropped() + m_kmsg.dropped();
+    s.utf8Repaired = m_utf8_repaired.load(std::memory_order_relaxed);
+    s.filterChecks = m_filter_checks.load(std::memory_order_relaxed);
+    s.prefilterSkips = m_prefilter_skips.load(std::memory_order_relaxed);
+    return s;
+}
+
+uint64_t LogEngine::counter(uint32_t index) const {
+    switch (index) {
+        case 0: return m_bytes_read.load(std::memory_order_relaxed);
+        case 1: return m_lines_read.load(std::memory_order_relaxed);
+        case 2: return m_batches.load(std::memory_order_relaxed);
+        case 3: return m_output.droppedBytes();
+        case 4: return m_output.droppedRecords();
+        case 5: return m_batch_arena.heapAllocations();
+        case 6: return m_batch_arena.peakBytes();
+        case 7: return MemoryBudget::residentBytes();
+        case 8: return m_memory.totalUsage();
+        case 9: return m_memory.budget();
+        case 10: return static_cast<uint64_t>(m_memory.trimLevel());
+        case 11: return m_memory.usage(MemComponent::Pipe);
+        case 12: return m_memory.usage(MemComponent::ReadBuffer);
+        case 13: return m_liblog.dropped() + m_kmsg.dropped();
+        case 14: return m_utf8_repaired.load(std::memory_order_relaxed);
+        case 15: return m_filter_checks.load(std::memory_order_relaxed);
+        case 16: return m_prefilter_skips.load(std::memory_order_relaxed);
+        default: return 0;
+    }
+}
+
+/**
+ * MEMORY BUDGET / TRIM
+ * Only bump the budget generation; the worker resizes at its next loop iteration
+ * (at most LogConfig::pollTimeoutMs later when the stream is idle).
+ */
+void LogEngine::setMemoryBudget(size_t bytes) {
+    m_memory.setBudget(bytes);
+}
+
+void LogEngine::onTrimMemory(int level) {
+    m_memory.setTrimLevel(level);
 }
\ No newline at end of file
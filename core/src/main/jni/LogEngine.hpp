@@ -2,11 +2,35 @@
 #define LOG_ENGINE_HPP
 
 #include <string>
+#include <string_view>
 #include <atomic>
 #include <regex>
 #include <pthread.h>
+#include <unistd.h>
 #include <mutex>
 #include <vector>
+#include <memory>
+#include "TriggerCapture.hpp"
+#include "EventAssembler.hpp"
+#include "BatchWriter.hpp"
+#include "FieldExtractor.hpp"
+#include "FieldStats.hpp"
+#include "ColumnarWriter.hpp"
+#include "TagTable.hpp"
+#include "Arena.hpp"
+#include "MemoryBudget.hpp"
+#include "LogSource.hpp"
+#include "LiblogSource.hpp"
+#include "StdioSource.hpp"
+#include "LogMerger.hpp"
+#include "EventsSource.hpp"
+#include "KmsgSource.hpp"
+#include "FileTailSource.hpp"
+#include "ProcessNames.hpp"
+#include "OutputFormatter.hpp"
+#include "Utf8.hpp"
+#include "LiteralPrefilter.hpp"
+#include "ShiftAndMatcher.hpp"
 
 /**
  * Logcat execution configuration structure.
@@ -16,13 +40,55 @@ struct LogConfig {
     std::string pid;           // Target Process ID to filter
     std::string level = "D";   // Minimum log level (V, D, I, W, E, F)
     std::string tagFilter;     // Tag-specific filters (e.g., "MyApp:V *:S")
-    std::string customRegex;   // Initial regex pattern for line-by-line filtering
+    std::string customRegex;   // Initial regex pattern for event filtering
+    uint32_t reassemblyWindowMs = 50; // Multi-line event grouping window (0 = line by line)
+    bool framed = false;       // Deliver framed batches with match spans instead of plain text
+    bool inProcess = true;     // pid == own process: hook liblog (Android 11+) instead of forking logcat
+    bool captureStdio = false; // Also capture the app's stdout/stderr (tags "stdout"/"stderr")
+    std::string logBuffers;    // logcat -b list, e.g. "main,system,crash,events" (empty = main,system,crash)
+    std::string kernelLogPath = KmsgSource::DEVICE_PATH; // Kernel buffer source; a file or FIFO in host tests
+    std::string tailFiles;     // Text log files to follow: "path[|timestamp format]" entries separated by ';'
+    std::string packageFilter; // Only lines of these packages (comma-separated); resolves process names
+    std::string format;        // logcat -v options, e.g. "threadtime,usec" (empty = time); see LineFormat
+    bool utf8HexEscape = false; // Invalid UTF-8 bytes become "\xNN" instead of U+FFFD
+    std::string outputTemplate; // Reformat delivered events: OutputFormatter template or preset (empty = as read)
+    uint32_t mergeDelayMs = 100; // Reordering delay of the timestamp merge of several inputs (0 = arrival order)
+
+    // --- BUFFERS (clamped in start(); scaled further by the memory budget) ---
+    uint32_t readBufferSize = 128 * 1024; // Bytes per read() from logcat
+    uint32_t pollTimeoutMs = 200;         // epoll timeout: stop/child-exit latency while idle
+    uint32_t pipeSize = 1024 * 1024;      // Kotlin pipe buffer (capped by /proc/sys/fs/pipe-max-size)
+    uint32_t accumulatorCap = 512 * 1024; // Partial-line bytes kept before they are discarded
+    bool autoTune = false;     // Grow read buffer/pipe under backlog, shrink them when idle
+};
+
+/**
+ * Engine counters, readable from any thread while capture runs.
+ */
+struct EngineStats {
+    uint64_t bytesRead = 0;        // Raw bytes read from logcat
+    uint64_t linesRead = 0;
+    uint64_t batches = 0;          // Read batches (one pipe write each)
+    uint64_t droppedBytes = 0;     // Output dropped because the Kotlin pipe was full
+    uint64_t droppedRecords = 0;
+    uint64_t arenaAllocations = 0; // Heap allocations made by the per-batch arena
+    uint64_t arenaPeakBytes = 0;   // Largest per-batch arena usage
+    uint64_t rssBytes = 0;         // Resident set size of the whole process
+    uint64_t nativeBytes = 0;      // Native buffers governed by the memory budget
+    uint64_t memoryBudget = 0;
+    int32_t trimLevel = 0;         // Last onTrimMemory level (0 = no pressure)
+    uint64_t pipeCapacity = 0;     // Kotlin pipe size granted by the kernel
+    uint64_t readBufferSize = 0;   // Current read size (changes with auto-tune)
+    uint64_t sourceDropped = 0;    // Records lost by in-process sources (queue full, kmsg overruns)
+    uint64_t utf8Repaired = 0;     // Events whose invalid UTF-8 was repaired before delivery
+    uint64_t filterChecks = 0;     // Events tested against the filter regex
+    uint64_t prefilterSkips = 0;   // Of those, rejected by the literal prefilter without running the regex
 };
 
-class LogEngine {
+class LogEngine : private LineSink {
 public:
     LogEngine();
-    ~LogEngine();
+    ~LogEngine() override;
 
     /**
      * Starts the log collection engine.
@@ -49,7 +115,107 @@ public:
      */
     void updateLiteral(const std::string& text);
 
+    /**
+     * Configures crash/ANR trigger capture (pre/post-event bundles written natively).
+     * May be called before or during capture; an empty directory disables it.
+     */
+    void configureTrigger(const TriggerConfig& config);
+
+    /**
+     * Sets the window used to group continuation lines (stack traces) into one event.
+     * 0 delivers and filters every line on its own.
+     */
+    void setReassemblyWindow(uint32_t windowMs);
+
+    /**
+     * Adds a field extraction rule with named, typed groups, e.g. `took (?<ms:int>\d+)ms`.
+     * Matching events carry the values as typed fields (framed mode).
+     * @param withLine Also deliver the event text when the user filter rejects it.
+     * @param emitFields Deliver the fields; false keeps them in the histograms only.
+     * @return rule id, or -1 if the pattern is invalid.
+     */
+    int addExtractRule(const std::string& pattern, bool withLine, bool emitFields);
+
+    /**
+     * Field names of an extraction rule, in the order used on the wire.
+     */
+    std::vector<std::string> extractFieldNames(int ruleId) const;
+
+    /**
+     * Removes all extraction rules and their histograms; rule ids restart from 0.
+     */
+    void clearExtractRules();
+
+    /**
+     * Quantiles of a numeric field (DDSketch, 1% relative error).
+     * @return false if the field has no samples yet.
+     */
+    bool fieldQuantiles(int ruleId, int field, const double* q, double* out, size_t n);
+
+    /**
+     * Count/min/max/sum of a numeric field.
+     */
+    bool fieldSummary(int ruleId, int field, FieldSummary& out);
+
+    /**
+     * Clears the histograms of one rule (-1 = all) without removing the rule.
+     */
+    void resetFieldStats(int ruleId);
+
+    /**
+     * Starts exporting every captured line (before filtering) into a LOGCOL columnar file.
+     */
+    void startExport(const std::string& path);
+
+    /**
+     * Flushes and closes the current columnar export.
+     */
+    void stopExport();
+
+    /**
+     * Number of distinct tags seen so far (tag ids are dense: [0, tagCount())).
+     */
+    uint32_t tagCount() const { return m_tags.size(); }
+
+    /**
+     * Name of an interned tag id (empty for id 0, headerless lines).
+     */
+    std::string_view tagName(uint16_t id) const { return m_tags.name(id); }
+
+    /**
+     * Lines captured per tag id since the engine was created.
+     */
+    uint64_t tagLines(uint16_t id) const { return m_tags.lines(id); }
+
+    /**
+     * Snapshot of the engine counters.
+     */
+    EngineStats stats() const;
+
+    /**
+     * One counter of stats() by field index (declaration order), without sampling the
+     * others: only the rss index reads /proc. Unknown indices return 0.
+     */
+    uint64_t counter(uint32_t index) const;
+
+    /**
+     * Sets the global budget for native buffers (0 = default); quotas are re-applied
+     * by the worker between read batches.
+     */
+    void setMemoryBudget(size_t bytes);
+
+    /**
+     * Reacts to Android onTrimMemory: shrinks pipe, rings and buffers according to the level.
+     * Level 0 restores the full budget.
+     */
+    void onTrimMemory(int level);
+
+    size_t memoryUsage(MemComponent c) const { return m_memory.usage(c); }
+    size_t memoryQuota(MemComponent c) const { return m_memory.quota(c); }
+
 private:
+    friend class HotPathHarness; // tools/enginetest: drives read batches on the host
+
     /**
      * Wrapper for arguments passed to the pthread worker routine.
      */
@@ -73,13 +239,105 @@ private:
 
     /**
      * Core I/O loop: Reads raw stream, applies regex filtering, and writes to output pipe.
+     * Additional sources (m_sources) share the epoll set; read_fd -1 runs them alone.
      */
     void processLogStream(pid_t child_pid, int read_fd, int kotlin_fd);
 
     /**
-     * Performs a guaranteed write to a file descriptor, handling EINTR and partial writes.
+     * Starts a batch: timestamp, extraction rule snapshot and reassembly window.
+     */
+    void beginBatch();
+
+    /**
+     * Ends a batch: one pipe write, arena rewind, counters.
+     */
+    void endBatch(size_t bytes);
+
+    /**
+     * Runs one line ('\n' must follow it in memory) through trigger, tag table, export
+     * and filtering. `structured` carries fields already known to the source.
+     * @return false on a severe pipe error.
+     */
+    bool processLine(std::string_view line, const LogRecord *structured);
+
+    /**
+     * Entry point of every input line: straight to processLine(), or into the timestamp
+     * merge when several inputs are active (m_batch_input names the input).
+     */
+    bool acceptLine(std::string_view line, const LogRecord *structured);
+
+    bool packageAllowed(std::string_view process) const;
+
+    bool onSourceLine(std::string_view line, const LogRecord *rec) override {
+        return acceptLine(line, rec);
+    }
+
+    const LineFormat &lineFormat() const override { return m_line_format; }
+
+    /**
+     * Parses a logcat line and tags it with the buffer of the last "--------- switch to" marker.
+     */
+    void parseLogcatLine(std::string_view line, LogRecord &rec);
+
+    /**
+     * Hands merged lines that are due to processLine().
+     */
+    bool releaseMerged(uint64_t nowMs, bool flushAll);
+
+    /**
+     * Filters a complete event ('\n'-terminated lines) and queues it in the output batch.
+     * @return false on a severe pipe error.
+     */
+    bool deliverEvent(std::string_view event, uint8_t bufferId);
+
+    /**
+     * Appends a span for every match of the user regex in `text` (caller holds m_regex_lock).
+     * @return the number of spans; RECORD_FLAG_SPANS_TRUNCATED is set in `flags` on overflow.
+     */
+    uint16_t collectSpans(std::string_view text, ArenaMatch &m, MatchSpan *spans, uint16_t &flags);
+
+    /**
+     * Renders an event (without its final '\n') through the output template into `out`.
+     * @param matchedRules Extraction rules that matched the event (bit per rule id).
+     */
+    void formatEvent(std::string &out, std::string_view text, uint8_t bufferId, uint64_t matchedRules);
+
+    /**
+     * Delivers and clears the event held by the assembler.
+     */
+    bool flushPendingEvent();
+
+    /**
+     * Read-side buffers of one processLogStream() run.
+     */
+    struct StreamBuffers {
+        std::unique_ptr<char[]> read;
+        size_t readSize = 0;
+        std::string accumulator;
+        size_t accumulatorCap = 0;
+
+        void resizeRead(size_t bytes);
+    };
+
+    /**
+     * Resizes the native buffers to the current memory quotas (worker thread).
+     */
+    void applyMemoryBudget(StreamBuffers& buffers);
+
+    /**
+     * Auto-tune after a read batch: grows read buffer / pipe under sustained backlog.
+     */
+    void tuneAfterBatch(StreamBuffers& buffers, size_t bytesRead);
+
+    /**
+     * Auto-tune on an epoll timeout: shrinks read buffer / pipe once the stream is idle.
+     */
+    void tuneWhileIdle(StreamBuffers& buffers, uint32_t waitedMs);
+
+    /**
+     * Publishes the current size of the dynamically sized buffers.
      */
-    static ssize_t safeWrite(int fd, const char* buf, size_t len);
+    void reportMemoryUsage(const StreamBuffers& buffers);
 
     /**
      * Internally compiles and sets the regex pattern using an atomic lock-free mechanism.
@@ -95,11 +353,90 @@ private:
     // Spinlock: High-performance synchronization for hot-swapping regex patterns
     std::atomic_flag m_regex_lock = ATOMIC_FLAG_INIT;
     std::regex m_regex;                 // Compiled regex object
+    LiteralPrefilter m_prefilter;       // Literals every match of m_regex contains, checked first
+    ShiftAndMatcher m_short_matcher;    // Replaces m_regex for short fixed-length patterns
     std::atomic<bool> m_regex_ready{false}; // Flag indicating if regex filtering is active
 
     // Internal management for rapid shutdown and pipe flushing
     std::atomic<int> m_internal_raw_read_fd{-1}; // Current logcat output file descriptor
     std::atomic<bool> m_should_flush_accumulator{false}; // Signal to clear buffer on filter change
+
+    // Crash/ANR trigger capture: sees every raw line before the user filter
+    TriggerCapture m_trigger;
+
+    // Multi-line event reassembly (worker thread only, window hot-swappable)
+    EventAssembler m_assembler;
+    std::atomic<uint32_t> m_reassembly_window_ms{50};
+
+    // Output batching towards Kotlin (text or framed), one write per read batch
+    BatchWriter m_output;
+
+    // Capture-group extraction: rules swapped copy-on-write, snapshotted once per batch
+    FieldExtractor m_extractor;
+    std::shared_ptr<const ExtractRuleSet> m_batch_rules;
+    std::vector<FieldValue> m_field_scratch;
+    FieldStats m_field_stats;
+
+    // Per-batch scratch memory (match state, ...), rewound after every read batch
+    Arena m_batch_arena;
+
+    // Counters reported by stats(); written by the worker once per batch
+    std::atomic<uint64_t> m_bytes_read{0};
+    std::atomic<uint64_t> m_lines_read{0};
+    std::atomic<uint64_t> m_batches{0};
+    std::atomic<uint64_t> m_filter_checks{0};
+    std::atomic<uint64_t> m_prefilter_skips{0};
+
+    // Memory governor: quotas change on JNI threads, buffers are resized by the worker
+    MemoryBudget m_memory;
+    uint32_t m_memory_generation = 0; // Last applied MemoryBudget::generation() (worker only)
+
+    // Auto-tune state (worker only)
+    uint32_t m_tune_full_reads = 0;  // Consecutive reads that filled the whole buffer
+    uint32_t m_tune_idle_ms = 0;     // Time since the last data
+    uint64_t m_tune_dropped = 0;     // Dropped records seen at the last check
+
+    // Tag intern table: every parsed line carries a 16-bit tag id (lock-free lookups)
+    TagTable m_tags;
+
+    // Columnar export of the raw stream (worker thread only, start/stop handed over)
+    ColumnarWriter m_export;
+
+    // Line sources next to logcat; the list is fixed while the worker runs
+    LiblogSource m_liblog;
+    StdioSource m_stdout{STDOUT_FILENO, "stdout", 'I'};
+    StdioSource m_stderr{STDERR_FILENO, "stderr", 'W'};
+    EventsSource m_events;
+    KmsgSource m_kmsg;
+    std::vector<std::unique_ptr<FileTailSource>> m_tails;
+    std::vector<LogSource *> m_sources;
+    bool m_use_logcat = true;        // false: sources only, no logcat child
+    uint64_t m_batch_ms = 0;         // beginBatch() timestamp (worker only)
+    uint32_t m_batch_window = 0;     // Reassembly window of the current batch
+    uint32_t m_batch_lines = 0;
+    uint32_t m_batch_filter_checks = 0;
+    uint32_t m_batch_prefilter_skips = 0;
+
+    // Timestamp merge of logcat and the sources (input 0 = logcat when it runs)
+    LogMerger m_merger;
+    size_t m_batch_input = 0;        // Input whose lines are being accepted
+    size_t m_source_base = 0;        // Merge input of m_sources[0]
+    uint8_t m_logcat_buffer = LOG_BUFFER_MAIN; // Buffer of the current logcat section
+    LineFormat m_line_format;        // Format of logcat's lines and of rendered source lines
+
+    // pid/tid -> process/thread names, resolved per record when something needs them
+    ProcessNames m_names;
+    std::vector<std::string> m_packages; // Allowed packages; empty = all
+    bool m_resolve_names = false;
+
+    // Output template (fixed while the worker runs); framed records are rendered into the scratch
+    OutputFormatter m_formatter;
+    std::string m_format_scratch;
+
+    // Invalid UTF-8 is repaired into this scratch before delivery (worker only)
+    std::string m_utf8_scratch;
+    Utf8Repair m_utf8_repair = Utf8Repair::REPLACE;
+    std::atomic<uint64_t> m_utf8_repaired{0};
 };
 
 #endif // LOG_ENGINE_HPP
@@ -1,7 +1,10 @@
 #include <jni.h>
 #include <string>
 #include <cstring>
+#include <vector>
+#include <algorithm>
 #include "LogEngine.hpp"
+#include "Utf8.hpp"
 #include <android/log.h>
 
 /**
@@ -25,26 +28,60 @@
 static LogEngine g_logEngine;
 
 /**
- * HELPER: Safe JNI String to Std::String Conversion
- * @param env JNI interface pointer.
- * @param jstr The Java string to convert.
- * @return C++ string copy. Returns empty string on NULL input or allocation failure.
+ * java.lang.String, resolved once in JNI_OnLoad (FindClass per call is a lookup by name).
  */
-std::string jstringToStdString(JNIEnv *env, jstring jstr) {
+static jclass g_stringClass = nullptr;
+
+/**
+ * HELPER: Java String to std::string (standard UTF-8)
+ * The UTF-16 chars are copied with GetStringRegion into a buffer reused by the calling
+ * thread: no modified-UTF-8 copy per call (GetStringUTFChars), and characters outside
+ * the BMP come out as proper 4-byte sequences.
+ * @return empty string on NULL input.
+ */
+static std::string jstringToStdString(JNIEnv *env, jstring jstr) {
     if (unlikely(!jstr)) return "";
 
-    // GetStringUTFChars creates a modified UTF-8 copy of the java string
-    const char *chars = env->GetStringUTFChars(jstr, nullptr);
-    if (unlikely(!chars)) {
-        // Log error if JNI fails to allocate memory for the string chars
-        __android_log_print(ANDROID_LOG_ERROR, TAG, "jstringToStdString: GetStringUTFChars failed (OOM?)");
-        return "";
-    }
+    thread_local std::vector<jchar> chars;
+    const jsize length = env->GetStringLength(jstr);
+    chars.resize(static_cast<size_t>(length));
+    env->GetStringRegion(jstr, 0, length, chars.data());
 
-    std::string result(chars);
+    std::string result;
+    utf16ToUtf8(reinterpret_cast<const char16_t *>(chars.data()), chars.size(), result);
+    return result;
+}
+
+/**
+ * STRING CONSTRUCTION
+ * Strings are built from standard UTF-8, never through NewStringUTF (modified UTF-8,
+ * which aborts under CheckJNI on 4-byte sequences). UTF-8 is transcoded to UTF-16
+ * (Utf8.hpp) into a scratch buffer reused by the calling thread, and NewString copies it
+ * without decoding again; the capture jobs get a whole batch's strings from one call.
+ * Local refs are dropped per element, so a batch is not bounded by the local reference
+ * table.
+ */
+struct TextRange {
+    uint32_t offset;
+    uint32_t length;
+};
 
-    // Immediate release to prevent JNI local reference table overflow
-    env->ReleaseStringUTFChars(jstr, chars);
+static jstring newString(JNIEnv *env, const char *utf8, size_t length) {
+    thread_local std::vector<char16_t> scratch;
+    if (scratch.size() < length) scratch.resize(length);
+    size_t units = utf8ToUtf16(utf8, length, scratch.data());
+    return env->NewString(reinterpret_cast<const jchar *>(scratch.data()), static_cast<jsize>(units));
+}
+
+static jobjectArray newStrings(JNIEnv *env, const char *base, const std::vector<TextRange> &ranges) {
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(ranges.size()), g_stringClass, nullptr);
+    if (unlikely(!result)) return nullptr;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        jstring s = newString(env, base + ranges[i].offset, ranges[i].length);
+        if (unlikely(!s)) return nullptr; // OutOfMemoryError pending
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), s);
+        env->DeleteLocalRef(s);
+    }
     return result;
 }
 
@@ -53,9 +90,12 @@ std::string jstringToStdString(JNIEnv *env, jstring jstr) {
  * Configures the LogEngine with provided filters and returns a pipe File Descriptor.
  * * @return jint: A valid File Descriptor (read-end) on success, or -1 on failure.
  */
-extern "C" JNIEXPORT jint JNICALL
-Java_com_core_logcat_capture_core_LogManager_configureAndStart(
-        JNIEnv *env, jobject thiz, jstring pid, jstring tags, jstring level, jstring regex
+static jint nativeConfigureAndStart(
+        JNIEnv *env, jobject thiz, jstring pid, jstring tags, jstring level, jstring regex, jboolean framed,
+        jint readBufferSize, jint pollTimeoutMs, jint pipeSize, jint accumulatorCap, jboolean autoTune,
+        jboolean inProcess, jboolean captureStdio, jstring logBuffers, jint mergeDelayMs,
+        jstring tailFiles, jstring packages, jstring format, jstring outputTemplate,
+        jboolean utf8HexEscape
 ) {
     LogConfig config;
 
@@ -63,6 +103,22 @@ Java_com_core_logcat_capture_core_LogManager_configureAndStart(
     config.tagFilter = jstringToStdString(env, tags);
     config.level = jstringToStdString(env, level);
     config.customRegex = jstringToStdString(env, regex);
+    config.framed = framed == JNI_TRUE;
+    // Non-positive values keep the LogConfig defaults
+    if (readBufferSize > 0) config.readBufferSize = static_cast<uint32_t>(readBufferSize);
+    if (pollTimeoutMs > 0) config.pollTimeoutMs = static_cast<uint32_t>(pollTimeoutMs);
+    if (pipeSize > 0) config.pipeSize = static_cast<uint32_t>(pipeSize);
+    if (accumulatorCap > 0) config.accumulatorCap = static_cast<uint32_t>(accumulatorCap);
+    config.autoTune = autoTune == JNI_TRUE;
+    config.inProcess = inProcess == JNI_TRUE;
+    config.captureStdio = captureStdio == JNI_TRUE;
+    config.logBuffers = jstringToStdString(env, logBuffers);
+    if (mergeDelayMs >= 0) config.mergeDelayMs = static_cast<uint32_t>(mergeDelayMs);
+    config.tailFiles = jstringToStdString(env, tailFiles);
+    config.packageFilter = jstringToStdString(env, packages);
+    config.format = jstringToStdString(env, format);
+    config.outputTemplate = jstringToStdString(env, outputTemplate);
+    config.utf8HexEscape = utf8HexEscape == JNI_TRUE;
 
     jint fd = g_logEngine.start(config);
 
@@ -79,8 +135,7 @@ Java_com_core_logcat_capture_core_LogManager_configureAndStart(
  * JNI BRIDGE: stop
  * Triggers the shutdown sequence for the background thread and its child processes.
  */
-extern "C" JNIEXPORT void JNICALL
-Java_com_core_logcat_capture_core_LogManager_stop(JNIEnv *env, jobject thiz) {
+static void nativeStop(JNIEnv *env, jobject thiz) {
     __android_log_print(ANDROID_LOG_INFO, TAG, "Initiating Engine shutdown...");
     g_logEngine.stop();
 }
@@ -89,38 +144,368 @@ Java_com_core_logcat_capture_core_LogManager_stop(JNIEnv *env, jobject thiz) {
  * JNI BRIDGE: updateRegex
  * Hot-swaps the current regex filter pattern without interrupting the capture stream.
  */
-extern "C" JNIEXPORT void JNICALL
-Java_com_core_logcat_capture_core_LogManager_updateRegex(JNIEnv *env, jobject thiz, jstring regex) {
-    if (unlikely(!regex)) {
-        g_logEngine.updateRegex("");
-        return;
+static void nativeUpdateRegex(JNIEnv *env, jobject thiz, jstring regex) {
+    g_logEngine.updateRegex(jstringToStdString(env, regex));
+}
+
+/**
+ * JNI BRIDGE: updateLiteral
+ * Hot-swaps the filter with a literal string. Characters are escaped internally for safety.
+ */
+static void nativeUpdateLiteral(JNIEnv *env, jobject thiz, jstring text) {
+    g_logEngine.updateLiteral(jstringToStdString(env, text));
+}
+
+/**
+ * JNI BRIDGE: configureTrigger
+ * Enables crash/ANR bundle capture into `dir` (empty string disables it).
+ * Bundles are written by the native worker, so they survive a dying Kotlin layer.
+ */
+static void nativeConfigureTrigger(
+        JNIEnv *env, jobject thiz, jstring dir, jint preSeconds, jint postSeconds
+) {
+    TriggerConfig config;
+    config.directory = jstringToStdString(env, dir);
+    config.preSeconds = preSeconds;
+    config.postSeconds = postSeconds;
+    g_logEngine.configureTrigger(config);
+}
+
+/**
+ * JNI BRIDGE: setReassemblyWindow
+ * Sets the multi-line event grouping window in milliseconds (0 = line by line).
+ */
+static void nativeSetReassemblyWindow(JNIEnv *env, jobject thiz, jint windowMs) {
+    g_logEngine.setReassemblyWindow(windowMs > 0 ? static_cast<uint32_t>(windowMs) : 0);
+}
+
+/**
+ * JNI BRIDGE: addExtractRule
+ * Registers a capture-group extraction rule. @return rule id, or -1 if invalid.
+ */
+static jint nativeAddExtractRule(
+        JNIEnv *env, jobject thiz, jstring pattern, jboolean withLine, jboolean emitFields
+) {
+    return g_logEngine.addExtractRule(jstringToStdString(env, pattern), withLine == JNI_TRUE,
+                                      emitFields == JNI_TRUE);
+}
+
+/**
+ * JNI BRIDGE: getExtractFieldNames
+ * @return the field names of a rule in wire order (empty array for an unknown id).
+ */
+static jobjectArray nativeGetExtractFieldNames(JNIEnv *env, jobject thiz, jint ruleId) {
+    std::vector<std::string> names = g_logEngine.extractFieldNames(ruleId);
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(names.size()), g_stringClass, nullptr);
+    if (unlikely(!result)) return nullptr;
+    for (size_t i = 0; i < names.size(); ++i) {
+        jstring name = newString(env, names[i].data(), names[i].size());
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), name);
+        env->DeleteLocalRef(name);
     }
+    return result;
+}
 
-    const char *cRegex = env->GetStringUTFChars(regex, nullptr);
-    if (likely(cRegex)) {
-        g_logEngine.updateRegex(cRegex);
-        env->ReleaseStringUTFChars(regex, cRegex);
-    } else {
-        __android_log_print(ANDROID_LOG_WARN, TAG, "updateRegex: Failed to extract JNI string chars");
+/**
+ * JNI BRIDGE: clearExtractRules
+ */
+static void nativeClearExtractRules(JNIEnv *env, jobject thiz) {
+    g_logEngine.clearExtractRules();
+}
+
+/**
+ * JNI BRIDGE: getFieldQuantiles
+ * Reads quantiles of a numeric field from the in-engine sketch.
+ * @return one value per requested quantile, or null if the field has no samples.
+ */
+static jdoubleArray nativeGetFieldQuantiles(
+        JNIEnv *env, jobject thiz, jint ruleId, jint field, jdoubleArray quantiles
+) {
+    if (unlikely(!quantiles)) return nullptr;
+    jsize n = env->GetArrayLength(quantiles);
+    std::vector<double> q(static_cast<size_t>(n)), values(static_cast<size_t>(n));
+    env->GetDoubleArrayRegion(quantiles, 0, n, q.data());
+
+    if (!g_logEngine.fieldQuantiles(ruleId, field, q.data(), values.data(), values.size())) return nullptr;
+
+    jdoubleArray result = env->NewDoubleArray(n);
+    if (likely(result)) env->SetDoubleArrayRegion(result, 0, n, values.data());
+    return result;
+}
+
+/**
+ * JNI BRIDGE: getFieldSummary
+ * @return [count, min, max, sum] of a numeric field, or null if it has no samples.
+ */
+static jdoubleArray nativeGetFieldSummary(JNIEnv *env, jobject thiz, jint ruleId, jint field) {
+    FieldSummary summary;
+    if (!g_logEngine.fieldSummary(ruleId, field, summary)) return nullptr;
+
+    const jdouble values[4] = {static_cast<double>(summary.count), summary.min, summary.max, summary.sum};
+    jdoubleArray result = env->NewDoubleArray(4);
+    if (likely(result)) env->SetDoubleArrayRegion(result, 0, 4, values);
+    return result;
+}
+
+/**
+ * JNI BRIDGE: resetFieldStats
+ * Clears the histograms of one rule (-1 = all rules).
+ */
+static void nativeResetFieldStats(JNIEnv *env, jobject thiz, jint ruleId) {
+    g_logEngine.resetFieldStats(ruleId);
+}
+
+/**
+ * JNI BRIDGE: startExport
+ * Exports every captured line into a LOGCOL columnar file at `path`.
+ */
+static void nativeStartExport(JNIEnv *env, jobject thiz, jstring path) {
+    g_logEngine.startExport(jstringToStdString(env, path));
+}
+
+/**
+ * JNI BRIDGE: stopExport
+ */
+static void nativeStopExport(JNIEnv *env, jobject thiz) {
+    g_logEngine.stopExport();
+}
+
+/**
+ * JNI BRIDGE: getTagNames
+ * @return names of tag ids [fromId, tagCount()); ids are append-only, so callers cache them.
+ */
+static jobjectArray nativeGetTagNames(JNIEnv *env, jobject thiz, jint fromId) {
+    uint32_t count = g_logEngine.tagCount();
+    uint32_t from = fromId > 0 ? std::min(static_cast<uint32_t>(fromId), count) : 0;
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(count - from), g_stringClass, nullptr);
+    if (unlikely(!result)) return nullptr;
+    for (uint32_t id = from; id < count; ++id) {
+        std::string_view tag = g_logEngine.tagName(static_cast<uint16_t>(id));
+        jstring name = newString(env, tag.data(), tag.size());
+        env->SetObjectArrayElement(result, static_cast<jsize>(id - from), name);
+        env->DeleteLocalRef(name);
     }
+    return result;
 }
 
 /**
- * JNI BRIDGE: updateLiteral
- * Hot-swaps the filter with a literal string. Characters are escaped internally for safety.
+ * JNI BRIDGE: getTagLineCounts
+ * @return lines captured per tag id (index = id).
  */
-extern "C" JNIEXPORT void JNICALL
-Java_com_core_logcat_capture_core_LogManager_updateLiteral(JNIEnv *env, jobject thiz, jstring text) {
-    if (unlikely(!text)) {
-        g_logEngine.updateLiteral("");
-        return;
+static jlongArray nativeGetTagLineCounts(JNIEnv *env, jobject thiz) {
+    uint32_t count = g_logEngine.tagCount();
+    std::vector<jlong> lines(count);
+    for (uint32_t id = 0; id < count; ++id) {
+        lines[id] = static_cast<jlong>(g_logEngine.tagLines(static_cast<uint16_t>(id)));
     }
+    jlongArray result = env->NewLongArray(static_cast<jsize>(count));
+    if (likely(result)) env->SetLongArrayRegion(result, 0, static_cast<jsize>(count), lines.data());
+    return result;
+}
 
-    const char *cText = env->GetStringUTFChars(text, nullptr);
-    if (likely(cText)) {
-        g_logEngine.updateLiteral(cText);
-        env->ReleaseStringUTFChars(text, cText);
-    } else {
-        __android_log_print(ANDROID_LOG_WARN, TAG, "updateLiteral: Failed to extract JNI string chars");
+/**
+ * JNI BRIDGE: getEngineStats
+ * @return [bytesRead, linesRead, batches, droppedBytes, droppedRecords, arenaAllocations,
+ * arenaPeakBytes, rssBytes, nativeBytes, memoryBudget, trimLevel, pipeCapacity, readBufferSize,
+ * sourceDropped, utf8Repaired, filterChecks, prefilterSkips];
+ * the order is mirrored by LogManager.engineStats().
+ */
+static jlongArray nativeGetEngineStats(JNIEnv *env, jobject thiz) {
+    EngineStats s = g_logEngine.stats();
+    const jlong values[] = {
+            static_cast<jlong>(s.bytesRead), static_cast<jlong>(s.linesRead), static_cast<jlong>(s.batches),
+            static_cast<jlong>(s.droppedBytes), static_cast<jlong>(s.droppedRecords),
+            static_cast<jlong>(s.arenaAllocations), static_cast<jlong>(s.arenaPeakBytes),
+            static_cast<jlong>(s.rssBytes), static_cast<jlong>(s.nativeBytes), static_cast<jlong>(s.memoryBudget),
+            static_cast<jlong>(s.trimLevel), static_cast<jlong>(s.pipeCapacity),
+            static_cast<jlong>(s.readBufferSize), static_cast<jlong>(s.sourceDropped),
+            static_cast<jlong>(s.utf8Repaired), static_cast<jlong>(s.filterChecks),
+            static_cast<jlong>(s.prefilterSkips),
+    };
+    constexpr jsize n = sizeof(values) / sizeof(values[0]);
+    jlongArray result = env->NewLongArray(n);
+    if (likely(result)) env->SetLongArrayRegion(result, 0, n, values);
+    return result;
+}
+
+/**
+ * FAST NATIVES
+ * Polled calls take and return primitives only, allocate nothing and never block, which
+ * is what @FastNative requires (and @CriticalNative too, minus the env/this arguments).
+ */
+
+/**
+ * JNI BRIDGE: getEngineCounter
+ * @return one value of getEngineStats() by index, without building the array.
+ */
+static jlong nativeGetEngineCounter(JNIEnv *env, jobject thiz, jint index) {
+    return index >= 0 ? static_cast<jlong>(g_logEngine.counter(static_cast<uint32_t>(index))) : 0;
+}
+
+/**
+ * JNI BRIDGE: getTagCount
+ * @return the number of interned tags: the id the next new tag will get.
+ */
+static jint nativeGetTagCount(JNIEnv *env, jobject thiz) {
+    return static_cast<jint>(g_logEngine.tagCount());
+}
+
+/**
+ * JNI BRIDGE: setMemoryBudget
+ * Global budget for native buffers in bytes (0 = default).
+ */
+static void nativeSetMemoryBudget(JNIEnv *env, jobject thiz, jlong bytes) {
+    g_logEngine.setMemoryBudget(bytes > 0 ? static_cast<size_t>(bytes) : 0);
+}
+
+/**
+ * JNI BRIDGE: trimMemory
+ * Forwards ComponentCallbacks2.onTrimMemory levels to the memory governor.
+ */
+static void nativeTrimMemory(JNIEnv *env, jobject thiz, jint level) {
+    g_logEngine.onTrimMemory(level);
+}
+
+/**
+ * JNI BRIDGE: getMemoryUsage
+ * @return [used, quota] byte pairs per component, in MemComponent order.
+ */
+static jlongArray nativeGetMemoryUsage(JNIEnv *env, jobject thiz) {
+    constexpr size_t n = MemoryBudget::COMPONENT_COUNT;
+    jlong values[n * 2];
+    for (size_t i = 0; i < n; ++i) {
+        auto c = static_cast<MemComponent>(i);
+        values[i * 2] = static_cast<jlong>(g_logEngine.memoryUsage(c));
+        values[i * 2 + 1] = static_cast<jlong>(g_logEngine.memoryQuota(c));
+    }
+    jlongArray result = env->NewLongArray(static_cast<jsize>(n * 2));
+    if (likely(result)) env->SetLongArrayRegion(result, 0, static_cast<jsize>(n * 2), values);
+    return result;
+}
+
+/**
+ * JNI BRIDGE: decodeTexts
+ * Framed batches: strings for `count` record texts of a direct buffer.
+ * @return the strings, or null if a range lies outside the buffer.
+ */
+static jobjectArray nativeDecodeTexts(JNIEnv *env, jobject thiz, jobject buffer, jintArray offsets,
+                                      jintArray lengths, jint count) {
+    const char *base = static_cast<const char *>(env->GetDirectBufferAddress(buffer));
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (unlikely(!base || count < 0)) return nullptr;
+
+    thread_local std::vector<jint> offs, lens;
+    thread_local std::vector<TextRange> ranges;
+    offs.resize(static_cast<size_t>(count));
+    lens.resize(static_cast<size_t>(count));
+    env->GetIntArrayRegion(offsets, 0, count, offs.data());
+    env->GetIntArrayRegion(lengths, 0, count, lens.data());
+    if (unlikely(env->ExceptionCheck())) return nullptr;
+
+    ranges.clear();
+    for (jint i = 0; i < count; ++i) {
+        if (unlikely(offs[i] < 0 || lens[i] < 0 || static_cast<jlong>(offs[i]) + lens[i] > capacity)) {
+            __android_log_print(ANDROID_LOG_ERROR, TAG, "decodeTexts: record %d out of bounds", i);
+            return nullptr;
+        }
+        ranges.push_back({static_cast<uint32_t>(offs[i]), static_cast<uint32_t>(lens[i])});
+    }
+    return newStrings(env, base, ranges);
+}
+
+/**
+ * JNI BRIDGE: decodeLines
+ * Text mode: strings for the complete, non-empty lines in the first `length` bytes of a
+ * direct buffer; `consumed[0]` receives the bytes used. With `last` the unterminated
+ * rest is a line too. A full buffer without any '\n' is cut at a character boundary, so
+ * an overlong line arrives in pieces instead of stalling the reader.
+ * @return the lines, or null if there is none.
+ */
+static jobjectArray nativeDecodeLines(JNIEnv *env, jobject thiz, jobject buffer, jint length, jboolean last,
+                                      jintArray consumed) {
+    const char *base = static_cast<const char *>(env->GetDirectBufferAddress(buffer));
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (unlikely(!base || length < 0 || length > capacity)) return nullptr;
+
+    thread_local std::vector<TextRange> ranges;
+    ranges.clear();
+    const auto n = static_cast<size_t>(length);
+    size_t pos = 0;
+    while (pos < n) {
+        const void *nl = memchr(base + pos, '\n', n - pos);
+        if (!nl) break;
+        size_t end = static_cast<size_t>(static_cast<const char *>(nl) - base);
+        if (end > pos) ranges.push_back({static_cast<uint32_t>(pos), static_cast<uint32_t>(end - pos)});
+        pos = end + 1;
+    }
+    if (pos < n && (last == JNI_TRUE || (pos == 0 && length == capacity))) {
+        size_t end = last == JNI_TRUE ? n : utf8BoundaryPrefix(base, n);
+        if (end == 0) end = n;
+        ranges.push_back({static_cast<uint32_t>(pos), static_cast<uint32_t>(end - pos)});
+        pos = end;
+    }
+
+    const auto used = static_cast<jint>(pos);
+    env->SetIntArrayRegion(consumed, 0, 1, &used);
+    return ranges.empty() ? nullptr : newStrings(env, base, ranges);
+}
+
+/**
+ * NATIVE REGISTRATION
+ * Bound once when the library is loaded instead of resolved lazily by mangled symbol
+ * names: no dlsym on first call, and only JNI_OnLoad is exported from the .so.
+ * Signatures mirror the `external fun` declarations in LogManager.kt.
+ */
+#define STR "Ljava/lang/String;"
+
+static const JNINativeMethod LOG_MANAGER_METHODS[] = {
+        {"configureAndStart", "(" STR STR STR STR "ZIIIIZZZ" STR "I" STR STR STR STR "Z)I",
+                reinterpret_cast<void *>(nativeConfigureAndStart)},
+        {"stop", "()V", reinterpret_cast<void *>(nativeStop)},
+        {"updateRegex", "(" STR ")V", reinterpret_cast<void *>(nativeUpdateRegex)},
+        {"updateLiteral", "(" STR ")V", reinterpret_cast<void *>(nativeUpdateLiteral)},
+        {"configureTrigger", "(" STR "II)V", reinterpret_cast<void *>(nativeConfigureTrigger)},
+        {"setReassemblyWindow", "(I)V", reinterpret_cast<void *>(nativeSetReassemblyWindow)},
+        {"addExtractRule", "(" STR "ZZ)I", reinterpret_cast<void *>(nativeAddExtractRule)},
+        {"getExtractFieldNames", "(I)[" STR, reinterpret_cast<void *>(nativeGetExtractFieldNames)},
+        {"clearExtractRules", "()V", reinterpret_cast<void *>(nativeClearExtractRules)},
+        {"getFieldQuantiles", "(II[D)[D", reinterpret_cast<void *>(nativeGetFieldQuantiles)},
+        {"getFieldSummary", "(II)[D", reinterpret_cast<void *>(nativeGetFieldSummary)},
+        {"resetFieldStats", "(I)V", reinterpret_cast<void *>(nativeResetFieldStats)},
+        {"startExport", "(" STR ")V", reinterpret_cast<void *>(nativeStartExport)},
+        {"stopExport", "()V", reinterpret_cast<void *>(nativeStopExport)},
+        {"getTagNames", "(I)[" STR, reinterpret_cast<void *>(nativeGetTagNames)},
+        {"getTagLineCounts", "()[J", reinterpret_cast<void *>(nativeGetTagLineCounts)},
+        {"getEngineStats", "()[J", reinterpret_cast<void *>(nativeGetEngineStats)},
+        {"getEngineCounter", "(I)J", reinterpret_cast<void *>(nativeGetEngineCounter)},
+        {"getTagCount", "()I", reinterpret_cast<void *>(nativeGetTagCount)},
+        {"setMemoryBudget", "(J)V", reinterpret_cast<void *>(nativeSetMemoryBudget)},
+        {"trimMemory", "(I)V", reinterpret_cast<void *>(nativeTrimMemory)},
+        {"getMemoryUsage", "()[J", reinterpret_cast<void *>(nativeGetMemoryUsage)},
+        {"decodeTexts", "(Ljava/nio/ByteBuffer;[I[II)[" STR, reinterpret_cast<void *>(nativeDecodeTexts)},
+        {"decodeLines", "(Ljava/nio/ByteBuffer;IZ[I)[" STR, reinterpret_cast<void *>(nativeDecodeLines)},
+};
+
+#undef STR
+
+extern "C" JNIEXPORT jint JNI_OnLoad(JavaVM *vm, void *reserved) {
+    JNIEnv *env = nullptr;
+    if (unlikely(vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK)) return JNI_ERR;
+
+    jclass stringClass = env->FindClass("java/lang/String");
+    jclass managerClass = env->FindClass("com/core/logcat/capture/core/LogManager");
+    if (unlikely(!stringClass || !managerClass)) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "JNI_OnLoad: class lookup failed");
+        return JNI_ERR;
+    }
+    g_stringClass = static_cast<jclass>(env->NewGlobalRef(stringClass));
+
+    constexpr jint count = sizeof(LOG_MANAGER_METHODS) / sizeof(LOG_MANAGER_METHODS[0]);
+    if (unlikely(env->RegisterNatives(managerClass, LOG_MANAGER_METHODS, count) != JNI_OK)) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "JNI_OnLoad: RegisterNatives failed");
+        return JNI_ERR;
     }
-}
\ No newline at end of file
+    env->DeleteLocalRef(stringClass);
+    env->DeleteLocalRef(managerClass);
+    return JNI_VERSION_1_6;
+}
@@ -0,0 +1,131 @@
+#include "LogMerger.hpp"
+#include <algorithm>
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * HARD BOUND: an input stuck mid-burst cannot make the others queue more than this;
+ * beyond it the oldest head is released without waiting for its delay.
+ */
+static constexpr size_t MERGE_MAX_BYTES = 1024 * 1024;
+
+void LogMerger::configure(size_t inputs, uint32_t delayMs) {
+    m_inputs.clear();
+    if (inputs >= 2 && delayMs > 0) m_inputs.resize(inputs);
+    m_delayMs = delayMs;
+    m_queuedBytes = 0;
+    m_head = nullptr;
+}
+
+void LogMerger::setLive(size_t input, bool live) {
+    if (input < m_inputs.size()) m_inputs[input].live = live;
+}
+
+static inline void storeView(std::string_view view, std::string_view line, uint32_t *out) {
+    if (view.empty()) {
+        out[0] = out[1] = 0;
+        return;
+    }
+    out[0] = static_cast<uint32_t>(view.data() - line.data());
+    out[1] = static_cast<uint32_t>(view.size());
+}
+
+void LogMerger::push(size_t input, std::string_view line, const LogRecord &rec, uint64_t nowMs) {
+    Input &in = m_inputs[input];
+
+    Entry e{};
+    e.offset = static_cast<uint32_t>(in.text.size());
+    e.length = static_cast<uint32_t>(line.size());
+    e.seq = m_seq++;
+    e.arrivalMs = nowMs;
+    e.rec = rec;
+    if (e.rec.timeNs == 0 && e.rec.valid()) e.rec.timeNs = timeFormatToNs(e.rec.timestamp);
+    if (e.rec.timeNs == 0) e.rec.timeNs = in.lastTimeNs; // Separators, headerless lines
+    in.lastTimeNs = e.rec.timeNs;
+
+    // Views of `rec` point into `line`; keep them as offsets
+    storeView(rec.timestamp, line, e.views);
+    storeView(rec.tag, line, e.views + 2);
+    storeView(rec.message, line, e.views + 4);
+    e.rec.timestamp = e.rec.tag = e.rec.message = std::string_view();
+
+    in.text.append(line.data(), line.size());
+    in.text.push_back('\n');
+    in.entries.push_back(e);
+    m_queuedBytes += line.size() + 1;
+}
+
+/**
+ * OLDEST HEAD
+ * k is tiny (a handful of inputs), so a linear scan beats a heap.
+ */
+const LogMerger::Input *LogMerger::oldest(bool &allHeads) const {
+    const Input *best = nullptr;
+    allHeads = true;
+    for (const Input &in: m_inputs) {
+        if (in.entries.empty()) {
+            if (in.live) allHeads = false;
+            continue;
+        }
+        if (!best) {
+            best = &in;
+            continue;
+        }
+        const Entry &e = in.entries.front(), &b = best->entries.front();
+        if (e.rec.timeNs < b.rec.timeNs || (e.rec.timeNs == b.rec.timeNs && e.seq < b.seq)) best = &in;
+    }
+    return best;
+}
+
+bool LogMerger::next(uint64_t nowMs, bool flushAll, std::string_view &line, LogRecord &rec) {
+    if (m_queuedBytes == 0) return false;
+
+    bool allHeads;
+    auto *best = const_cast<Input *>(oldest(allHeads));
+    const Entry &e = best->entries.front();
+    bool due = allHeads || flushAll || nowMs >= e.arrivalMs + m_delayMs || m_queuedBytes > MERGE_MAX_BYTES;
+    if (!due) return false;
+
+    const char *base = best->text.data() + e.offset;
+    line = std::string_view(base, e.length);
+    rec = e.rec;
+    rec.timestamp = std::string_view(base + e.views[0], e.views[1]);
+    rec.tag = std::string_view(base + e.views[2], e.views[3]);
+    rec.message = std::string_view(base + e.views[4], e.views[5]);
+    m_head = best;
+    return true;
+}
+
+void LogMerger::pop() {
+    Input &in = *m_head;
+    const Entry &e = in.entries.front();
+    m_queuedBytes -= e.length + 1;
+    in.entries.pop_front();
+    m_head = nullptr;
+
+    if (in.entries.empty()) {
+        in.text.clear();
+        return;
+    }
+    // Compact once the consumed prefix dominates, keeping appends amortized O(1)
+    uint32_t consumed = in.entries.front().offset;
+    if (unlikely(consumed > 4096 && consumed > in.text.size() / 2)) {
+        in.text.erase(0, consumed);
+        for (Entry &rest: in.entries) rest.offset -= consumed;
+    }
+}
+
+int LogMerger::msUntilRelease(uint64_t nowMs) const {
+    if (m_queuedBytes == 0) return -1;
+    bool allHeads;
+    const Entry &e = oldest(allHeads)->entries.front();
+    uint64_t due = e.arrivalMs + m_delayMs;
+    return allHeads || due <= nowMs ? 0 : static_cast<int>(due - nowMs);
+}
+
+size_t LogMerger::memoryUsage() const {
+    size_t bytes = 0;
+    for (const Input &in: m_inputs) bytes += in.text.capacity() + in.entries.size() * sizeof(Entry);
+    return bytes;
+}
@@ -0,0 +1,95 @@
+#ifndef LOG_MERGER_HPP
+#define LOG_MERGER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include "LogParser.hpp"
+
+/**
+ * LogMerger: timestamp-ordered k-way merge of the engine's inputs (logcat, liblog hook,
+ * stdio, ...) with a bounded reordering delay.
+ *
+ * Each input is assumed to be ordered by itself, so only queue heads compete. The oldest
+ * head is released as soon as every live input has a head (nothing older can arrive), or
+ * once it has waited `delayMs` (a quiet input does not hold the others back longer).
+ * Lines without a timestamp inherit the previous one of their input and stay behind it.
+ *
+ * Worker-thread only. Lines are copied (with their '\n') into per-input buffers; the
+ * records handed to the sink point into those buffers.
+ */
+class LogMerger {
+public:
+    /**
+     * @param inputs Number of inputs; fewer than 2 disables the merger (lines pass through).
+     */
+    void configure(size_t inputs, uint32_t delayMs);
+
+    bool enabled() const { return !m_inputs.empty(); }
+
+    /**
+     * A live input holds back older lines of the others; an ended one does not.
+     */
+    void setLive(size_t input, bool live);
+
+    /**
+     * Queues a line of `input`. Fills rec.timeNs if the source left it at 0.
+     */
+    void push(size_t input, std::string_view line, const LogRecord &rec, uint64_t nowMs);
+
+    /**
+     * Releases every line that is safe to emit, oldest first, as emit(line, rec) with a
+     * '\n' following `line` in memory. `flushAll` releases everything (stream end).
+     * @return false if emit() reported a severe error (the line is consumed anyway).
+     */
+    template<typename Emit>
+    bool release(uint64_t nowMs, bool flushAll, Emit &&emit) {
+        bool ok = true;
+        LogRecord rec;
+        std::string_view line;
+        while (next(nowMs, flushAll, line, rec)) {
+            ok = emit(line, rec) && ok;
+            pop();
+        }
+        return ok;
+    }
+
+    /**
+     * Milliseconds until the oldest waiting line is due, -1 if nothing is queued.
+     */
+    int msUntilRelease(uint64_t nowMs) const;
+
+    bool empty() const { return m_queuedBytes == 0; }
+    size_t memoryUsage() const;
+
+private:
+    struct Entry {
+        uint32_t offset;      // Line start in Input::text
+        uint32_t length;      // Without the '\n'
+        uint64_t seq;         // Arrival order, breaks timestamp ties
+        uint64_t arrivalMs;
+        LogRecord rec;        // Scalar fields; its views are rebuilt from `views`
+        uint32_t views[6];    // timestamp, tag, message as (offset into the line, length)
+    };
+
+    struct Input {
+        std::string text;
+        std::deque<Entry> entries;
+        int64_t lastTimeNs = 0;
+        bool live = true;
+    };
+
+    const Input *oldest(bool &allHeads) const;
+    bool next(uint64_t nowMs, bool flushAll, std::string_view &line, LogRecord &rec);
+    void pop();
+
+    std::vector<Input> m_inputs;
+    uint32_t m_delayMs = 0;
+    uint64_t m_seq = 0;
+    size_t m_queuedBytes = 0;
+    Input *m_head = nullptr; // Input of the line returned by the last next()
+};
+
+#endif // LOG_MERGER_HPP
@@ -0,0 +1,357 @@
+#include "LogParser.hpp"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * FIXED OFFSETS of `-v time`: the timestamp is always 18 bytes, followed by one space.
+ */
+static constexpr size_t TIME_LEN = 18;       // "MM-DD HH:MM:SS.mmm"
+static constexpr size_t DATE_LEN = 14;       // "MM-DD HH:MM:SS", before the fraction
+
+static inline bool isLevel(char c) {
+    return c == 'V' || c == 'D' || c == 'I' || c == 'W' || c == 'E' || c == 'F' || c == 'A';
+}
+
+/**
+ * SWAR DIGITS
+ * Eight ASCII digits are validated and converted with a few 64-bit operations instead of
+ * eight dependent multiply-adds. Plain integer arithmetic, so it runs the same on every
+ * ABI the NDK builds (all little-endian).
+ */
+static inline uint64_t load8(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline bool isEightDigits(uint64_t v) {
+    return ((v & 0xF0F0F0F0F0F0F0F0ULL) | (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+           0x3333333333333333ULL;
+}
+
+static inline uint32_t eightDigitsValue(uint64_t v) {
+    constexpr uint64_t MASK = 0x000000FF000000FFULL;
+    constexpr uint64_t MUL1 = 100 + (1000000ULL << 32);
+    constexpr uint64_t MUL2 = 1 + (10000ULL << 32);
+    v -= 0x3030303030303030ULL;
+    v = v * 10 + (v >> 8); // Adjacent digit pairs
+    return static_cast<uint32_t>(((v & MASK) * MUL1 + ((v >> 16) & MASK) * MUL2) >> 32);
+}
+
+/**
+ * @return false unless [p, p + n) are all digits.
+ */
+static inline bool parseDigits(const char *p, size_t n, uint64_t &value) {
+    uint64_t v = 0;
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t chunk = load8(p);
+        if (unlikely(!isEightDigits(chunk))) return false;
+        v = v * 100000000ULL + eightDigitsValue(chunk);
+    }
+    for (; n > 0; ++p, --n) {
+        auto d = static_cast<unsigned>(*p - '0');
+        if (unlikely(d > 9)) return false;
+        v = v * 10 + d;
+    }
+    value = v;
+    return true;
+}
+
+static constexpr int64_t FRACTION_SCALE[10] = {1000000000, 100000000, 10000000, 1000000, 100000,
+                                               10000, 1000, 100, 10, 1};
+
+/**
+ * `-v time` HEADER after a timestamp of `stampLen` bytes: " L/Tag( pid): ".
+ * Branch-light: fixed offset for the level, one memchr-style scan for "): ".
+ */
+static bool parseTimeHeader(std::string_view line, size_t stampLen, LogRecord &out) {
+    const size_t levelPos = stampLen + 1;
+    if (unlikely(line.size() < levelPos + 2 || line[levelPos + 1] != '/' || !isLevel(line[levelPos]))) {
+        return false;
+    }
+
+    // Tag runs until the "(" that opens the pid field; the header ends at "): "
+    const char *base = line.data();
+    const char *end = base + line.size();
+    const char *tagStart = base + levelPos + 2;
+    const char *close = tagStart;
+    while (true) {
+        close = static_cast<const char *>(memchr(close, ')', static_cast<size_t>(end - close)));
+        if (unlikely(!close || close + 1 >= end)) return false;
+        if (close[1] == ':') break;
+        ++close;
+    }
+
+    const char *open = close;
+    while (open > tagStart && *open != '(') --open;
+    if (unlikely(*open != '(')) return false;
+
+    int32_t pid = 0;
+    for (const char *p = open + 1; p < close; ++p) {
+        if (*p >= '0' && *p <= '9') pid = pid * 10 + (*p - '0');
+        else if (*p != ' ') return false;
+    }
+
+    const char *tagEnd = open;
+    while (tagEnd > tagStart && tagEnd[-1] == ' ') --tagEnd; // logcat pads short tags
+
+    const char *msg = close + 2;
+    if (msg < end && *msg == ' ') ++msg;
+
+    out.timestamp = std::string_view(base, stampLen);
+    out.level = line[levelPos];
+    out.tag = std::string_view(tagStart, static_cast<size_t>(tagEnd - tagStart));
+    out.pid = pid;
+    out.message = std::string_view(msg, static_cast<size_t>(end - msg));
+    return true;
+}
+
+/**
+ * `-v threadtime` HEADER after the timestamp: " %5d %5d L %-8s: ".
+ */
+static bool parseThreadtimeHeader(std::string_view line, size_t stampLen, LogRecord &out) {
+    const char *base = line.data();
+    const char *end = base + line.size();
+    const char *p = base + stampLen;
+
+    int32_t ids[2];
+    for (int32_t &id: ids) {
+        if (unlikely(p >= end || *p != ' ')) return false;
+        while (p < end && *p == ' ') ++p;
+        const char *digits = p;
+        id = 0;
+        while (p < end && static_cast<unsigned>(*p - '0') <= 9) id = id * 10 + (*p++ - '0');
+        if (unlikely(p == digits)) return false;
+    }
+    if (unlikely(end - p < 4 || p[0] != ' ' || !isLevel(p[1]) || p[2] != ' ')) return false;
+    const char level = p[1];
+
+    // Tag is padded to 8 columns and closed by ": "
+    const char *tagStart = p + 3;
+    const char *colon = tagStart;
+    while (true) {
+        colon = static_cast<const char *>(memchr(colon, ':', static_cast<size_t>(end - colon)));
+        if (unlikely(!colon)) return false;
+        if (colon + 1 == end || colon[1] == ' ') break;
+        ++colon;
+    }
+    const char *tagEnd = colon;
+    while (tagEnd > tagStart && tagEnd[-1] == ' ') --tagEnd;
+    const char *msg = colon + 1 < end ? colon + 2 : end;
+
+    out.timestamp = std::string_view(base, stampLen);
+    out.level = level;
+    out.tag = std::string_view(tagStart, static_cast<size_t>(tagEnd - tagStart));
+    out.pid = ids[0];
+    out.tid = ids[1];
+    out.message = std::string_view(msg, static_cast<size_t>(end - msg));
+    return true;
+}
+
+/**
+ * PARSE -v time
+ * The default format: fixed offsets for timestamp and level.
+ */
+bool parseTimeFormat(std::string_view line, LogRecord &out) {
+    out = LogRecord{};
+    out.message = line;
+    if (unlikely(line.size() < TIME_LEN + 3 || line[2] != '-' || line[5] != ' ')) return false;
+    if (unlikely(!parseTimeHeader(line, TIME_LEN, out))) {
+        out = LogRecord{};
+        out.message = line;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @return the length of the `format` timestamp at the start of `line`, 0 if there is none.
+ */
+static size_t stampLength(const LineFormat &format, std::string_view line) {
+    if (format.clock == LineFormat::DATE) {
+        size_t length = DATE_LEN + 1 + format.fractionDigits;
+        if (line.size() < length || line[2] != '-' || line[5] != ' ' || line[DATE_LEN] != '.') return 0;
+        return length;
+    }
+    size_t i = 0;
+    while (i < line.size() && line[i] == ' ') ++i; // logcat right-aligns the seconds
+    const size_t digits = i;
+    while (i < line.size() && static_cast<unsigned>(line[i] - '0') <= 9) ++i;
+    if (i == digits || i >= line.size() || line[i] != '.') return 0;
+    i += 1 + format.fractionDigits;
+    return i <= line.size() ? i : 0;
+}
+
+bool parseLine(const LineFormat &format, std::string_view line, LogRecord &out) {
+    if (likely(format.isDefault())) {
+        if (!parseTimeFormat(line, out)) return false;
+        out.timeNs = timeFormatToNs(out.timestamp);
+        return true;
+    }
+
+    out = LogRecord{};
+    out.message = line;
+    size_t stampLen = stampLength(format, line);
+    bool ok = stampLen != 0 && (format.layout == LineFormat::TIME ? parseTimeHeader(line, stampLen, out)
+                                                                   : parseThreadtimeHeader(line, stampLen, out));
+    if (unlikely(!ok)) {
+        out = LogRecord{};
+        out.message = line;
+        return false;
+    }
+    out.timeNs = timestampToNs(format, out.timestamp);
+    return true;
+}
+
+static inline int digits2(const char *p) {
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+/**
+ * TIMESTAMP CONVERSION
+ * mktime() (timezone + DST rules) is far too slow per line, so the epoch second of the
+ * current "MM-DD HH" is cached; minutes, seconds and millis are added arithmetically.
+ * The cache is per thread, so parsers on different threads never contend.
+ */
+static int64_t dateToNs(std::string_view ts, size_t fractionDigits) {
+    if (ts.size() < DATE_LEN + 1 + fractionDigits || ts[2] != '-' || ts[5] != ' ' || ts[8] != ':' ||
+        ts[11] != ':' || ts[14] != '.') {
+        return 0;
+    }
+    for (int i: {0, 1, 3, 4, 6, 7, 9, 10, 12, 13}) {
+        if (static_cast<unsigned>(ts[i] - '0') > 9) return 0;
+    }
+    uint64_t fraction;
+    if (!parseDigits(ts.data() + DATE_LEN + 1, fractionDigits, fraction)) return 0;
+
+    thread_local char cachedHour[8] = {};   // "MM-DD HH" of the cached base
+    thread_local int64_t cachedBase = 0;    // Epoch seconds of that hour
+
+    if (memcmp(cachedHour, ts.data(), sizeof(cachedHour)) != 0) {
+        time_t now = time(nullptr);
+        struct tm local{};
+        localtime_r(&now, &local);
+
+        struct tm t{};
+        t.tm_year = local.tm_year;
+        t.tm_mon = digits2(ts.data()) - 1;
+        t.tm_mday = digits2(ts.data() + 3);
+        t.tm_hour = digits2(ts.data() + 6);
+        t.tm_isdst = -1;
+        time_t base = mktime(&t);
+        if (base > now + 86400) { // Entry from December read in January
+            t = {};
+            t.tm_year = local.tm_year - 1;
+            t.tm_mon = digits2(ts.data()) - 1;
+            t.tm_mday = digits2(ts.data() + 3);
+            t.tm_hour = digits2(ts.data() + 6);
+            t.tm_isdst = -1;
+            base = mktime(&t);
+        }
+        cachedBase = static_cast<int64_t>(base);
+        memcpy(cachedHour, ts.data(), sizeof(cachedHour));
+    }
+
+    int64_t seconds = cachedBase + digits2(ts.data() + 9) * 60 + digits2(ts.data() + 12);
+    return seconds * 1000000000LL + static_cast<int64_t>(fraction) * FRACTION_SCALE[fractionDigits];
+}
+
+int64_t timeFormatToNs(std::string_view ts) {
+    return dateToNs(ts, 3);
+}
+
+int64_t monotonicToRealtimeNs() {
+    struct timespec real{}, mono{};
+    clock_gettime(CLOCK_REALTIME, &real);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    return (static_cast<int64_t>(real.tv_sec) - mono.tv_sec) * 1000000000LL +
+           (static_cast<int64_t>(real.tv_nsec) - mono.tv_nsec);
+}
+
+/**
+ * EPOCH / MONOTONIC stamps are "<seconds>.<fraction>"; the boot-time offset of monotonic
+ * stamps is sampled once per second of log time (per thread, like the date cache).
+ */
+int64_t timestampToNs(const LineFormat &format, std::string_view ts) {
+    if (format.clock == LineFormat::DATE) return dateToNs(ts, format.fractionDigits);
+
+    while (!ts.empty() && ts.front() == ' ') ts.remove_prefix(1);
+    size_t dot = ts.find('.');
+    uint64_t seconds, fraction;
+    if (dot == std::string_view::npos || dot == 0 || dot > 18 || ts.size() < dot + 1 + format.fractionDigits ||
+        !parseDigits(ts.data(), dot, seconds) ||
+        !parseDigits(ts.data() + dot + 1, format.fractionDigits, fraction)) {
+        return 0;
+    }
+    int64_t ns = static_cast<int64_t>(seconds) * 1000000000LL +
+                 static_cast<int64_t>(fraction) * FRACTION_SCALE[format.fractionDigits];
+    if (format.clock == LineFormat::EPOCH) return ns;
+
+    thread_local uint64_t offsetSecond = UINT64_MAX;
+    thread_local int64_t offset = 0;
+    if (seconds != offsetSecond) {
+        offset = monotonicToRealtimeNs();
+        offsetSecond = seconds;
+    }
+    return ns + offset;
+}
+
+bool LineFormat::configure(std::string_view spec) {
+    *this = LineFormat{};
+    bool known = true;
+    for (size_t pos = 0; pos < spec.size();) {
+        size_t end = std::min(spec.find(',', pos), spec.size());
+        std::string_view word = spec.substr(pos, end - pos);
+        pos = end + 1;
+        while (!word.empty() && word.front() == ' ') word.remove_prefix(1);
+        while (!word.empty() && word.back() == ' ') word.remove_suffix(1);
+        if (word.empty() || word == "time") layout = TIME;
+        else if (word == "threadtime") layout = THREADTIME;
+        else if (word == "epoch") clock = EPOCH;
+        else if (word == "monotonic") clock = MONOTONIC;
+        else if (word == "usec") fractionDigits = 6;
+        else if (word == "nsec") fractionDigits = 9;
+        else known = false;
+    }
+    return known;
+}
+
+std::string LineFormat::logcatArgs() const {
+    std::string args = layout == THREADTIME ? " -v threadtime" : " -v time";
+    if (clock == EPOCH) args += " -v epoch";
+    if (clock == MONOTONIC) args += " -v monotonic";
+    if (fractionDigits == 6) args += " -v usec";
+    if (fractionDigits == 9) args += " -v nsec";
+    return args;
+}
+static constexpr std::string_view BUFFER_NAMES[] = {"main", "radio", "events", "system",
+                                                    "crash", "stats", "security", "kernel"};
+
+int logBufferId(std::string_view name) {
+    for (size_t i = 0; i < sizeof(BUFFER_NAMES) / sizeof(BUFFER_NAMES[0]); ++i) {
+        if (BUFFER_NAMES[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+std::string_view logBufferName(uint8_t id) {
+    return id < sizeof(BUFFER_NAMES) / sizeof(BUFFER_NAMES[0]) ? BUFFER_NAMES[id] : BUFFER_NAMES[0];
+}
+
+/**
+ * BUFFER MARKERS
+ * Only checked for lines without a `-v time` header, so the prefix test is off the hot path.
+ */
+int parseBufferMarker(std::string_view line) {
+    static constexpr std::string_view PREFIX = "--------- ";
+    if (line.substr(0, PREFIX.size()) != PREFIX) return -1;
+    line.remove_prefix(PREFIX.size());
+    for (std::string_view lead: {std::string_view("beginning of "), std::string_view("switch to ")}) {
+        if (line.substr(0, lead.size()) == lead) return logBufferId(line.substr(lead.size()));
+    }
+    return -1;
+}
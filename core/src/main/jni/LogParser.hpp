@@ -0,0 +1,122 @@
+#ifndef LOG_PARSER_HPP
+#define LOG_PARSER_HPP
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+/**
+ * logd buffer ids (log_id_t), as reported by `logcat -b` markers and liblog.
+ */
+enum LogBuffer : uint8_t {
+    LOG_BUFFER_MAIN = 0,
+    LOG_BUFFER_RADIO = 1,
+    LOG_BUFFER_EVENTS = 2,
+    LOG_BUFFER_SYSTEM = 3,
+    LOG_BUFFER_CRASH = 4,
+    LOG_BUFFER_STATS = 5,
+    LOG_BUFFER_SECURITY = 6,
+    LOG_BUFFER_KERNEL = 7,
+};
+
+/**
+ * @return the buffer id for a `logcat -b` name ("main", "crash", ...), or -1.
+ */
+int logBufferId(std::string_view name);
+
+/**
+ * @return the `logcat -b` name of a buffer id ("main" for an unknown id).
+ */
+std::string_view logBufferName(uint8_t id);
+
+/**
+ * LINE FORMAT: logcat's `-v` layout and timestamp options.
+ *   layout  time:       "MM-DD HH:MM:SS.mmm L/Tag( pid): message"
+ *           threadtime: "MM-DD HH:MM:SS.mmm  pid  tid L Tag     : message"
+ *   clock   date (default), epoch ("1760700000.123"), monotonic (seconds since boot)
+ *   digits  3, or 6 with usec, 9 with nsec
+ */
+struct LineFormat {
+    enum Layout : uint8_t { TIME, THREADTIME };
+    enum Clock : uint8_t { DATE, EPOCH, MONOTONIC };
+
+    Layout layout = TIME;
+    Clock clock = DATE;
+    uint8_t fractionDigits = 3;
+
+    /**
+     * Parses a comma-separated spec such as "threadtime,usec" (empty = time).
+     * @return false if a word is unknown (the others still apply).
+     */
+    bool configure(std::string_view spec);
+
+    /**
+     * The matching logcat options, e.g. " -v threadtime -v usec".
+     */
+    std::string logcatArgs() const;
+
+    bool isDefault() const { return layout == TIME && clock == DATE && fractionDigits == 3; }
+};
+
+/**
+ * Parsed view over a single logcat line. All views point into the caller's buffer,
+ * so a LogRecord is only valid as long as the line it was parsed from.
+ */
+struct LogRecord {
+    std::string_view timestamp; // As printed, e.g. "MM-DD HH:MM:SS.mmm" (see LineFormat)
+    std::string_view tag;
+    std::string_view message;   // Payload after "): "
+    int32_t pid = -1;
+    int32_t tid = -1;           // -1 when the output format carries no thread id
+    int64_t timeNs = 0;         // Epoch nanoseconds; 0 until converted (see timeFormatToNs)
+    uint16_t tagId = 0;         // TagTable id; 0 (empty tag) until interned by the engine
+    uint8_t bufferId = LOG_BUFFER_MAIN; // logd buffer the line was read from
+    char level = 0;             // V, D, I, W, E, F (0 when the header could not be parsed)
+    std::string_view process;   // Process / thread name, filled by the engine when names are
+    std::string_view thread;    // resolved (ProcessNames), empty otherwise
+
+    bool valid() const { return level != 0; }
+};
+
+/**
+ * Parses a `logcat -v time` line: "MM-DD HH:MM:SS.mmm L/Tag( pid): message".
+ * Lines without a recognizable header (e.g. "--------- beginning of main") yield
+ * an invalid record whose message is the whole line.
+ * @return true if the header was recognized.
+ */
+bool parseTimeFormat(std::string_view line, LogRecord& out);
+
+/**
+ * Converts a `-v time` timestamp ("MM-DD HH:MM:SS.mmm", device local time) to nanoseconds
+ * since the Unix epoch. The year is not printed by logcat and is taken from the current
+ * date (previous year if that would put the entry in the future, e.g. around New Year).
+ * @return the timestamp, or 0 if it is malformed.
+ */
+int64_t timeFormatToNs(std::string_view timestamp);
+
+/**
+ * Parses a line of any LineFormat and converts its timestamp (rec.timeNs, epoch
+ * nanoseconds; monotonic stamps are shifted by the current boot time).
+ * @return true if the header was recognized.
+ */
+bool parseLine(const LineFormat &format, std::string_view line, LogRecord &out);
+
+/**
+ * Timestamp of `format` as printed (leading padding allowed) to epoch nanoseconds.
+ * @return the timestamp, or 0 if it is malformed.
+ */
+int64_t timestampToNs(const LineFormat &format, std::string_view timestamp);
+
+/**
+ * Offset from CLOCK_MONOTONIC to CLOCK_REALTIME in nanoseconds, sampled now.
+ */
+int64_t monotonicToRealtimeNs();
+
+/**
+ * Recognizes the separators logcat prints when reading several buffers
+ * ("--------- beginning of crash", "--------- switch to main").
+ * @return the buffer id the following lines belong to, or -1 for any other line.
+ */
+int parseBufferMarker(std::string_view line);
+
+#endif // LOG_PARSER_HPP
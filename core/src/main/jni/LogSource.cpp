@@ -0,0 +1,124 @@
+#include "LogSource.hpp"
+#include <cstdio>
+#include <ctime>
+
+// Nanoseconds per unit of the last printed digit, by number of fraction digits
+static constexpr int64_t FRACTION_UNIT[10] = {1000000000, 100000000, 10000000, 1000000, 100000,
+                                              10000, 1000, 100, 10, 1};
+
+/**
+ * RENDER
+ * The whole-second part of the stamp (localtime_r() for dates) is built once per second
+ * of log time; the rest is a few snprintf calls. Column widths follow logcat's.
+ */
+std::string_view TimeLineRenderer::render(std::string &out, const LineFormat &format, int64_t timeNs, char level,
+                                          std::string_view tag, int32_t pid, int32_t tid,
+                                          std::string_view message, LogRecord &rec) {
+    const int64_t second = timeNs / 1000000000LL;
+    if (second != m_stampSecond || format.clock != m_stampClock) {
+        if (format.clock == LineFormat::DATE) {
+            auto t = static_cast<time_t>(second);
+            struct tm local{};
+            localtime_r(&t, &local);
+            m_stampLen = static_cast<int>(strftime(m_stamp, sizeof(m_stamp), "%m-%d %H:%M:%S", &local));
+        } else if (format.clock == LineFormat::EPOCH) {
+            m_stampLen = snprintf(m_stamp, sizeof(m_stamp), "%19lld", static_cast<long long>(second));
+        } else {
+            m_monotonicOffset = monotonicToRealtimeNs();
+            m_stampLen = snprintf(m_stamp, sizeof(m_stamp), "%6lld",
+                                  static_cast<long long>((timeNs - m_monotonicOffset) / 1000000000LL));
+        }
+        m_stampSecond = second;
+        m_stampClock = format.clock;
+    }
+    int64_t stampNs = format.clock == LineFormat::MONOTONIC ? timeNs - m_monotonicOffset : timeNs;
+    if (stampNs < 0) stampNs = 0; // Monotonic stamp of a record older than the boot
+    const int fraction = static_cast<int>((stampNs % 1000000000LL) / FRACTION_UNIT[format.fractionDigits]);
+
+    char header[64];
+    int headerLen;
+    if (format.layout == LineFormat::THREADTIME) {
+        headerLen = snprintf(header, sizeof(header), "%s.%0*d %5d %5d %c ", m_stamp, format.fractionDigits,
+                             fraction, pid, tid < 0 ? 0 : tid, level);
+    } else {
+        headerLen = snprintf(header, sizeof(header), "%s.%0*d %c/", m_stamp, format.fractionDigits, fraction,
+                             level);
+    }
+    char pidField[24];
+    int pidLen = format.layout == LineFormat::THREADTIME
+                 ? snprintf(pidField, sizeof(pidField), "%*s: ", static_cast<int>(tag.size() < 8 ? 8 - tag.size() : 0), "")
+                 : snprintf(pidField, sizeof(pidField), "(%5d): ", pid);
+
+    out.assign(header, static_cast<size_t>(headerLen));
+    out.append(tag);
+    out.append(pidField, static_cast<size_t>(pidLen));
+    out.append(message);
+    out.push_back('\n');
+
+    rec = LogRecord{};
+    rec.timestamp = std::string_view(out.data(), static_cast<size_t>(m_stampLen + 1 + format.fractionDigits));
+    rec.level = level;
+    rec.tag = std::string_view(out.data() + headerLen, tag.size());
+    rec.pid = pid;
+    rec.tid = tid;
+    rec.timeNs = timeNs;
+    rec.message = std::string_view(out.data() + out.size() - 1 - message.size(), message.size());
+    return std::string_view(out.data(), out.size() - 1);
+}
+
+int64_t TimeLineRenderer::nowNs() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+int LevelFilter::rank(char level) {
+    switch (level) {
+        case 'D': return 1;
+        case 'I': return 2;
+        case 'W': return 3;
+        case 'E': return 4;
+        case 'F':
+        case 'A': return 5;
+        case 'S': return 6;
+        default: return 0;
+    }
+}
+
+/**
+ * CONFIGURE
+ * Mirrors the logcat command line built by LogEngine::start(): a tag filter, when
+ * present, replaces the plain "*:level" default.
+ */
+void LevelFilter::configure(std::string_view level, std::string_view spec) {
+    m_entries.clear();
+    m_defaultRank = rank(level.empty() ? 'D' : level[0]);
+    if (spec.empty()) return;
+
+    m_defaultRank = rank('V'); // logcat's default for a spec without "*:"
+    size_t pos = 0;
+    while (pos < spec.size()) {
+        size_t end = spec.find_first_of(" \t", pos);
+        if (end == std::string_view::npos) end = spec.size();
+        std::string_view item = spec.substr(pos, end - pos);
+        pos = end + 1;
+        if (item.empty()) continue;
+
+        size_t colon = item.rfind(':');
+        std::string_view tag = colon == std::string_view::npos ? item : item.substr(0, colon);
+        int minRank = colon == std::string_view::npos || colon + 1 >= item.size() ? rank('V') : rank(item[colon + 1]);
+        if (tag == "*") m_defaultRank = minRank;
+        else m_entries.push_back({std::string(tag), minRank});
+    }
+}
+
+bool LevelFilter::allows(std::string_view tag, char level) const {
+    int minRank = m_defaultRank;
+    for (const Entry &e: m_entries) {
+        if (e.tag == tag) {
+            minRank = e.minRank;
+            break;
+        }
+    }
+    return rank(level) >= minRank;
+}
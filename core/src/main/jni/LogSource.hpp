@@ -0,0 +1,120 @@
+#ifndef LOG_SOURCE_HPP
+#define LOG_SOURCE_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <sys/types.h>
+#include "LogParser.hpp"
+
+/**
+ * Receives the lines produced by a LogSource (the engine, on its worker thread).
+ */
+class LineSink {
+public:
+    virtual ~LineSink() = default;
+
+    /**
+     * @param line One line without its terminator; a '\n' MUST follow it in memory
+     * (line.data()[line.size()] == '\n') so it can be delivered without a copy.
+     * @param rec Fields already known to the source (views into `line`), or nullptr to
+     * have the line parsed as `-v time`.
+     * @return false on a severe output error; the source should stop at a record boundary.
+     */
+    virtual bool onSourceLine(std::string_view line, const LogRecord *rec) = 0;
+
+    /**
+     * Format the sink expects rendered lines in (the engine's logcat format).
+     */
+    virtual const LineFormat &lineFormat() const {
+        static const LineFormat DEFAULT;
+        return DEFAULT;
+    }
+};
+
+/**
+ * A producer of log lines multiplexed into the engine's epoll loop next to logcat.
+ * All methods except the constructor/destructor run on the worker thread.
+ */
+class LogSource {
+public:
+    virtual ~LogSource() = default;
+
+    /**
+     * Short name used in the engine's own diagnostics.
+     */
+    virtual const char *name() const = 0;
+
+    /**
+     * Descriptor registered in the epoll set (EPOLLIN), or -1 while the source is closed.
+     * It may change during drain(); the new descriptor must be opened before the old one
+     * is closed so the engine sees a different number and re-registers it.
+     */
+    virtual int pollFd() const = 0;
+
+    /**
+     * Called when pollFd() is readable: delivers every complete line to `sink`.
+     * @return bytes consumed (for the engine counters), or -1 once the source has ended.
+     */
+    virtual ssize_t drain(LineSink &sink) = 0;
+};
+
+/**
+ * LINE RENDERING for sources that know the fields, in the sink's LineFormat, so their
+ * text output is identical to logcat's and the UI needs no second format. Keeps a
+ * per-second timestamp cache.
+ */
+class TimeLineRenderer {
+public:
+    /**
+     * Renders one line into `out` (terminated by '\n') and points `rec` into it.
+     * @param tid -1 if unknown (printed as 0 by threadtime).
+     * @return the line without its '\n', as expected by LineSink.
+     */
+    std::string_view render(std::string &out, const LineFormat &format, int64_t timeNs, char level,
+                            std::string_view tag, int32_t pid, int32_t tid, std::string_view message,
+                            LogRecord &rec);
+
+    /**
+     * CLOCK_REALTIME in nanoseconds.
+     */
+    static int64_t nowNs();
+
+private:
+    int64_t m_stampSecond = -1;   // Epoch second of m_stamp
+    uint8_t m_stampClock = 0;     // LineFormat::Clock of m_stamp
+    int64_t m_monotonicOffset = 0; // CLOCK_MONOTONIC -> REALTIME, sampled with m_stamp
+    char m_stamp[24] = {};        // Whole-second part: "MM-DD HH:MM:SS", or right-aligned seconds
+    int m_stampLen = 0;
+};
+
+/**
+ * LEVEL / TAG FILTER
+ * logcat filterspec semantics ("Tag:L ... *:L") for sources that bypass logcat.
+ */
+class LevelFilter {
+public:
+    /**
+     * @param level Default minimum level (V, D, I, W, E, F, S).
+     * @param spec Whitespace-separated "tag:L" pairs; "*:L" replaces the default.
+     */
+    void configure(std::string_view level, std::string_view spec);
+
+    bool allows(std::string_view tag, char level) const;
+
+    /**
+     * Ordering of V < D < I < W < E < F(A) < S; unknown letters rank as V.
+     */
+    static int rank(char level);
+
+private:
+    struct Entry {
+        std::string tag;
+        int minRank;
+    };
+    std::vector<Entry> m_entries; // Few entries: a linear scan beats hashing here
+    int m_defaultRank = 1;
+};
+
+#endif // LOG_SOURCE_HPP
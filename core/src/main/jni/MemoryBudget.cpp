@@ -0,0 +1,120 @@
+#include "MemoryBudget.hpp"
+#include "BatchWriter.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+/**
+ * DEFAULT SIZES (scale 1.0) and FLOORS per component, in MemComponent order.
+ * The defaults are the sizes the engine always used (pipe, read buffer and accumulator
+ * are overridden by LogConfig); the floors keep every component functional under the
+ * harshest trim level.
+ */
+static constexpr size_t DEFAULT_SIZES[MemoryBudget::COMPONENT_COUNT] = {
+        1024 * 1024,  // Pipe
+        128 * 1024,   // ReadBuffer
+        512 * 1024,   // Accumulator
+        1024 * 1024,  // TriggerRing
+        64 * 1024,    // Assembler
+        256 * 1024,   // Arena
+        1024 * 1024,  // Export
+};
+
+static constexpr size_t MIN_SIZES[MemoryBudget::COMPONENT_COUNT] = {
+        BATCH_MIN_PIPE_BYTES, // Pipe: two full frames (BatchWriter cuts frames at half the pipe)
+        16 * 1024,    // ReadBuffer
+        64 * 1024,    // Accumulator: must hold at least one maximal logcat line
+        64 * 1024,    // TriggerRing
+        16 * 1024,    // Assembler
+        16 * 1024,    // Arena
+        64 * 1024,    // Export
+};
+
+static constexpr const char *COMPONENT_NAMES[MemoryBudget::COMPONENT_COUNT] = {
+        "pipe", "readBuffer", "accumulator", "triggerRing", "assembler", "arena", "export",
+};
+
+/**
+ * TRIM LEVELS (android.content.ComponentCallbacks2) -> share of the budget kept.
+ * RUNNING_* levels arrive while we are in the foreground and the device is low;
+ * BACKGROUND and above mean we are a candidate for being killed.
+ */
+static double pressureScale(int level) {
+    if (level >= 80) return 0.125;  // TRIM_MEMORY_COMPLETE
+    if (level >= 60) return 0.25;   // TRIM_MEMORY_MODERATE
+    if (level >= 40) return 0.5;    // TRIM_MEMORY_BACKGROUND
+    if (level >= 20) return 1.0;    // TRIM_MEMORY_UI_HIDDEN: capture continues unchanged
+    if (level >= 15) return 0.25;   // TRIM_MEMORY_RUNNING_CRITICAL
+    if (level >= 10) return 0.5;    // TRIM_MEMORY_RUNNING_LOW
+    if (level >= 5) return 0.75;    // TRIM_MEMORY_RUNNING_MODERATE
+    return 1.0;
+}
+
+MemoryBudget::MemoryBudget() {
+    for (size_t i = 0; i < COMPONENT_COUNT; ++i) m_base[i].store(DEFAULT_SIZES[i], std::memory_order_relaxed);
+}
+
+void MemoryBudget::setBudget(size_t bytes) {
+    m_budget.store(bytes, std::memory_order_relaxed);
+    m_generation.fetch_add(1, std::memory_order_release);
+}
+
+size_t MemoryBudget::budget() const {
+    size_t bytes = m_budget.load(std::memory_order_relaxed);
+    if (bytes) return bytes;
+    for (const auto &base: m_base) bytes += base.load(std::memory_order_relaxed);
+    return bytes;
+}
+
+void MemoryBudget::setBaseSize(MemComponent c, size_t bytes) {
+    m_base[static_cast<size_t>(c)].store(std::max(bytes, minSize(c)), std::memory_order_relaxed);
+    m_generation.fetch_add(1, std::memory_order_release);
+}
+
+size_t MemoryBudget::minSize(MemComponent c) {
+    return MIN_SIZES[static_cast<size_t>(c)];
+}
+
+void MemoryBudget::setTrimLevel(int level) {
+    m_trimLevel.store(level, std::memory_order_relaxed);
+    m_generation.fetch_add(1, std::memory_order_release);
+}
+
+size_t MemoryBudget::quota(MemComponent c) const {
+    size_t total = 0;
+    for (const auto &base: m_base) total += base.load(std::memory_order_relaxed);
+    double scale = static_cast<double>(budget()) / static_cast<double>(total) * pressureScale(trimLevel());
+    auto bytes = static_cast<size_t>(static_cast<double>(baseSize(c)) * scale);
+    return std::max(bytes, minSize(c));
+}
+
+size_t MemoryBudget::totalUsage() const {
+    size_t total = 0;
+    for (const auto &u: m_usage) total += u.load(std::memory_order_relaxed);
+    return total;
+}
+
+const char *MemoryBudget::componentName(MemComponent c) {
+    size_t i = static_cast<size_t>(c);
+    return i < COMPONENT_COUNT ? COMPONENT_NAMES[i] : "";
+}
+
+/**
+ * RSS: second field of /proc/self/statm, in pages. Read with raw syscalls so it is
+ * cheap enough to sample on every stats query.
+ */
+size_t MemoryBudget::residentBytes() {
+    int fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    char buf[128];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+
+    unsigned long long size = 0, resident = 0;
+    if (sscanf(buf, "%llu %llu", &size, &resident) != 2) return 0;
+    return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
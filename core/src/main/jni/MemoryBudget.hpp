@@ -0,0 +1,96 @@
+#ifndef MEMORY_BUDGET_HPP
+#define MEMORY_BUDGET_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Native buffers governed by the memory budget.
+ */
+enum class MemComponent : uint8_t {
+    Pipe = 0,       // Kernel buffer of the Kotlin pipe (F_SETPIPE_SZ)
+    ReadBuffer,     // Raw read buffer of the worker
+    Accumulator,    // Partial-line accumulator (cap before it is discarded)
+    TriggerRing,    // Crash/ANR pre-event history
+    Assembler,      // Largest multi-line event held back
+    Arena,          // Per-batch arena
+    Export,         // Columnar export block
+    Count
+};
+
+/**
+ * MemoryBudget: one global budget for the engine's native buffers, split into
+ * per-component quotas.
+ *
+ * Quotas are the base sizes (defaults, or the sizes configured in LogConfig) scaled by
+ * budget / sum(base sizes) and by the current memory pressure (Android onTrimMemory level). JNI threads change the budget or the
+ * trim level; the worker notices the new generation() and resizes its buffers between
+ * read batches, then reports actual usage back with setUsage().
+ */
+class MemoryBudget {
+public:
+    static constexpr size_t COMPONENT_COUNT = static_cast<size_t>(MemComponent::Count);
+
+    MemoryBudget();
+
+    /**
+     * Total native budget in bytes; 0 restores the default (sum of the base sizes).
+     */
+    void setBudget(size_t bytes);
+    size_t budget() const;
+
+    /**
+     * Size of a component at scale 1.0 (LogConfig); clamped to the component's minimum.
+     */
+    void setBaseSize(MemComponent c, size_t bytes);
+    size_t baseSize(MemComponent c) const {
+        return m_base[static_cast<size_t>(c)].load(std::memory_order_relaxed);
+    }
+    static size_t minSize(MemComponent c);
+
+    /**
+     * Applies an Android ComponentCallbacks2 trim level (0 = no pressure).
+     */
+    void setTrimLevel(int level);
+    int trimLevel() const { return m_trimLevel.load(std::memory_order_relaxed); }
+
+    /**
+     * Bumped whenever quotas change; the worker compares it with the last applied value.
+     */
+    uint32_t generation() const { return m_generation.load(std::memory_order_acquire); }
+
+    /**
+     * Current quota of a component in bytes (never below its minimum).
+     */
+    size_t quota(MemComponent c) const;
+
+    void setUsage(MemComponent c, size_t bytes) {
+        m_usage[static_cast<size_t>(c)].store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t usage(MemComponent c) const {
+        return m_usage[static_cast<size_t>(c)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Sum of the reported usage of all components.
+     */
+    size_t totalUsage() const;
+
+    static const char* componentName(MemComponent c);
+
+    /**
+     * Resident set size of the whole process, from /proc/self/statm (0 if unavailable).
+     */
+    static size_t residentBytes();
+
+private:
+    std::atomic<size_t> m_budget{0};           // 0 = sum of the base sizes
+    std::atomic<size_t> m_base[COMPONENT_COUNT];
+    std::atomic<int> m_trimLevel{0};
+    std::atomic<uint32_t> m_generation{1};
+    std::atomic<size_t> m_usage[COMPONENT_COUNT] = {};
+};
+
+#endif // MEMORY_BUDGET_HPP
@@ -0,0 +1,336 @@
+#include "OutputFormatter.hpp"
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <android/log.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define TAG "LogcatEngine-Format"
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+static constexpr int MAX_WIDTH = 255;
+
+/**
+ * PRESETS: accepted in place of a template.
+ */
+static std::string_view presetTemplate(std::string_view name) {
+    if (name == "compact") return "{level}/{tag}: {message}";
+    if (name == "threadtime") return "{date} {pid:5} {tid:5} {level} {tag:-8}: {message}";
+    if (name == "json") {
+        return R"({{"ts":{epoch_ms},"level":"{level}","tag":{tag:json},"pid":{pid},"tid":{tid},)"
+               R"("msg":{message:json},"rules":{rules}}})";
+    }
+    if (name == "csv") return "{iso},{level},{tag:csv},{pid},{tid},{message:csv}";
+    return name;
+}
+
+bool OutputFormatter::compile(std::string_view templ) {
+    m_ops.clear();
+    m_literals.clear();
+    m_usesNames = false;
+    templ = presetTemplate(templ);
+
+    auto literal = [this](char c) {
+        if (m_ops.empty() || m_ops.back().field != LITERAL) {
+            m_ops.push_back({LITERAL, NONE, 0, static_cast<uint32_t>(m_literals.size()), 0});
+        }
+        m_literals.push_back(c);
+        m_ops.back().length++;
+    };
+
+    for (size_t i = 0; i < templ.size(); ++i) {
+        const char c = templ[i];
+        if (c == '}') {
+            if (i + 1 < templ.size() && templ[i + 1] == '}') {
+                literal('}');
+                ++i;
+                continue;
+            }
+            __android_log_print(ANDROID_LOG_WARN, TAG, "compile(): unmatched '}' at %zu", i);
+            m_ops.clear();
+            return false;
+        }
+        if (c != '{') {
+            literal(c);
+            continue;
+        }
+        if (i + 1 < templ.size() && templ[i + 1] == '{') {
+            literal('{');
+            ++i;
+            continue;
+        }
+        size_t close = templ.find('}', i + 1);
+        if (close == std::string_view::npos || !addField(templ.substr(i + 1, close - i - 1))) {
+            __android_log_print(ANDROID_LOG_WARN, TAG, "compile(): bad field at %zu", i);
+            m_ops.clear();
+            return false;
+        }
+        i = close;
+    }
+    return true;
+}
+
+bool OutputFormatter::addField(std::string_view spec) {
+    static constexpr struct {
+        std::string_view name;
+        Field field;
+    } FIELDS[] = {
+            {"time", TIME}, {"date", DATE}, {"iso", ISO}, {"epoch_ms", EPOCH_MS}, {"epoch_ns", EPOCH_NS},
+            {"level", LEVEL}, {"tag", TAG_NAME}, {"pid", PID}, {"tid", TID}, {"process", PROCESS},
+            {"thread", THREAD}, {"buffer", BUFFER}, {"message", MESSAGE}, {"line", LINE}, {"rules", RULES},
+    };
+
+    size_t colon = spec.find(':');
+    std::string_view name = spec.substr(0, colon);
+    Op op{LITERAL, NONE, 0, 0, 0};
+    for (const auto &f: FIELDS) {
+        if (f.name == name) op.field = f.field;
+    }
+    if (op.field == LITERAL) return false;
+
+    while (colon != std::string_view::npos) {
+        spec.remove_prefix(colon + 1);
+        colon = spec.find(':');
+        std::string_view modifier = spec.substr(0, colon);
+        if (modifier == "json") {
+            op.escape = JSON;
+        } else if (modifier == "csv") {
+            op.escape = CSV;
+        } else {
+            std::string number(modifier);
+            char *end = nullptr;
+            long width = strtol(number.c_str(), &end, 10);
+            if (number.empty() || *end != '\0' || width < -MAX_WIDTH || width > MAX_WIDTH) return false;
+            op.width = static_cast<int16_t>(width);
+        }
+    }
+
+    if (op.field == PROCESS || op.field == THREAD) m_usesNames = true;
+    m_ops.push_back(op);
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------
+// Rendering
+// ---------------------------------------------------------------------------------------
+
+static void appendInt(std::string &out, int64_t value) {
+    char digits[24];
+    char *p = digits + sizeof(digits);
+    uint64_t v = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    do {
+        *--p = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    if (value < 0) *--p = '-';
+    out.append(p, static_cast<size_t>(digits + sizeof(digits) - p));
+}
+
+/**
+ * JSON SCAN
+ * Finds the next byte that needs an escape ('"', '\\' or a control character < 0x20),
+ * 16 bytes per step with NEON on the ARM ABIs and SSE2 on x86 (baseline for every ABI
+ * the NDK builds), then 8 bytes per step with SWAR words for the tail. Log text is almost
+ * all clean, so a message is usually one scan and one bulk copy.
+ */
+static inline uint64_t load8(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t swarJsonSpecial(uint64_t v) {
+    constexpr uint64_t ONES = 0x0101010101010101ULL;
+    constexpr uint64_t HIGH = 0x8080808080808080ULL;
+    // Per byte "less than n" / "is zero" tests: the lowest flagged byte is always exact
+    const uint64_t q = v ^ (ONES * '"'), b = v ^ (ONES * '\\');
+    const uint64_t control = (v - ONES * 0x20) & ~v;
+    const uint64_t quote = (q - ONES) & ~q;
+    const uint64_t backslash = (b - ONES) & ~b;
+    return (control | quote | backslash) & HIGH;
+}
+
+static inline bool isJsonSpecial(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+static const char *findJsonSpecial(const char *p, const char *end) {
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const uint8x16_t space = vdupq_n_u8(0x20), quote = vdupq_n_u8('"'), backslash = vdupq_n_u8('\\');
+    for (; end - p >= 16; p += 16) {
+        const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+        const uint8x16_t hit = vorrq_u8(vcltq_u8(v, space), vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)));
+        // Narrow to 4 bits per byte: no movemask on NEON
+        const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+        if (mask) return p + (__builtin_ctzll(mask) >> 2);
+    }
+#elif defined(__SSE2__)
+    const __m128i control = _mm_set1_epi8(0x1F), quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\');
+    for (; end - p >= 16; p += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        // max(v, 0x1F) == 0x1F  <=>  v <= 0x1F unsigned (SSE2 compares are signed)
+        const __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, control), control),
+                                         _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+        const int mask = _mm_movemask_epi8(hit);
+        if (mask) return p + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+#endif
+    for (; end - p >= 8; p += 8) {
+        const uint64_t mask = swarJsonSpecial(load8(p));
+        if (mask) return p + (__builtin_ctzll(mask) >> 3);
+    }
+    for (; p < end; ++p) {
+        if (isJsonSpecial(static_cast<unsigned char>(*p))) return p;
+    }
+    return end;
+}
+
+/**
+ * JSON ESCAPE: clean spans between special bytes are copied whole; quotes, backslashes
+ * and control characters become escapes. Bytes >= 0x80 pass through (the stream is UTF-8).
+ */
+static void appendJson(std::string &out, std::string_view s) {
+    static constexpr char HEX[] = "0123456789abcdef";
+    const char *p = s.data(), *end = p + s.size();
+    for (;;) {
+        const char *special = findJsonSpecial(p, end);
+        out.append(p, static_cast<size_t>(special - p));
+        if (special == end) break;
+        const auto c = static_cast<unsigned char>(*special);
+        p = special + 1;
+        switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default: {
+                const char escape[] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 15]};
+                out.append(escape, sizeof(escape));
+            }
+        }
+    }
+}
+
+static void appendRuleIds(std::string &out, uint64_t rules) {
+    out.push_back('[');
+    for (int id = 0; rules; ++id, rules >>= 1) {
+        if (!(rules & 1)) continue;
+        if (out.back() != '[') out.push_back(',');
+        appendInt(out, id);
+    }
+    out.push_back(']');
+}
+
+static void appendCsv(std::string &out, std::string_view s) {
+    size_t run = 0, quote;
+    while ((quote = s.find('"', run)) != std::string_view::npos) {
+        out.append(s.data() + run, quote + 1 - run);
+        out.push_back('"');
+        run = quote + 1;
+    }
+    out.append(s.data() + run, s.size() - run);
+}
+
+void OutputFormatter::appendEscaped(std::string &out, std::string_view s, Escape escape) {
+    switch (escape) {
+        case JSON: appendJson(out, s); break;
+        case CSV: appendCsv(out, s); break;
+        default: out.append(s.data(), s.size());
+    }
+}
+
+void OutputFormatter::appendDate(std::string &out, int64_t timeNs, bool iso) {
+    const int64_t second = timeNs / 1000000000LL;
+    if (unlikely(second != m_second)) {
+        time_t t = static_cast<time_t>(second);
+        struct tm local{};
+        localtime_r(&t, &local);
+        // The fixed offsets below need a four-digit year
+        const int year = std::min(std::max(local.tm_year + 1900, 0), 9999);
+        snprintf(m_secondText, sizeof(m_secondText), "%04d-%02d-%02dT%02d:%02d:%02d", year,
+                 local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, local.tm_sec);
+        m_second = second;
+    }
+    if (iso) {
+        out.append(m_secondText, 19);
+    } else {
+        out.append(m_secondText + 5, 5);
+        out.push_back(' ');
+        out.append(m_secondText + 11, 8);
+    }
+    const int ms = static_cast<int>(timeNs / 1000000 % 1000);
+    const char fraction[] = {'.', static_cast<char>('0' + ms / 100), static_cast<char>('0' + ms / 10 % 10),
+                             static_cast<char>('0' + ms % 10)};
+    out.append(fraction, sizeof(fraction));
+}
+
+/**
+ * MESSAGE: the first line's payload comes from `first`; continuation lines are parsed
+ * here (a stack trace line has its own header). A line that did not parse, the first
+ * included, falls back to the whole line.
+ */
+void OutputFormatter::appendMessage(std::string &out, const Op &op, const LineFormat &format,
+                                    std::string_view text, const LogRecord &first) {
+    size_t nl = text.find('\n');
+    appendEscaped(out, first.valid() ? first.message : text.substr(0, nl), op.escape);
+    while (nl != std::string_view::npos) {
+        text.remove_prefix(nl + 1);
+        nl = text.find('\n');
+        std::string_view line = text.substr(0, nl);
+        LogRecord rec;
+        appendEscaped(out, "\n", op.escape);
+        appendEscaped(out, parseLine(format, line, rec) ? rec.message : line, op.escape);
+    }
+}
+
+void OutputFormatter::render(std::string &out, const LineFormat &format, std::string_view text,
+                             const LogRecord &first, uint64_t rules) {
+    for (const Op &op: m_ops) {
+        if (op.field == LITERAL) {
+            out.append(m_literals.data() + op.offset, op.length);
+            continue;
+        }
+
+        const size_t start = out.size();
+        if (op.escape != NONE) out.push_back('"');
+
+        switch (op.field) {
+            case TIME: appendEscaped(out, first.timestamp, op.escape); break;
+            case DATE:
+            case ISO: if (first.timeNs != 0) appendDate(out, first.timeNs, op.field == ISO); break;
+            case EPOCH_MS: appendInt(out, first.timeNs / 1000000); break;
+            case EPOCH_NS: appendInt(out, first.timeNs); break;
+            case LEVEL: if (first.level) out.push_back(first.level); break;
+            case TAG_NAME: appendEscaped(out, first.tag, op.escape); break;
+            case PID: appendInt(out, first.pid); break;
+            case TID: appendInt(out, first.tid); break;
+            case PROCESS: appendEscaped(out, first.process, op.escape); break;
+            case THREAD: appendEscaped(out, first.thread, op.escape); break;
+            case BUFFER: out.append(logBufferName(first.bufferId)); break;
+            case MESSAGE: appendMessage(out, op, format, text, first); break;
+            case LINE: appendEscaped(out, text, op.escape); break;
+            case RULES: appendRuleIds(out, rules); break;
+            case LITERAL: break;
+        }
+
+        if (op.escape != NONE) out.push_back('"');
+        if (op.width != 0) {
+            const size_t width = static_cast<size_t>(op.width < 0 ? -op.width : op.width);
+            const size_t length = out.size() - start;
+            if (length < width) {
+                if (op.width < 0) out.append(width - length, ' ');
+                else out.insert(start, width - length, ' ');
+            }
+        }
+    }
+}
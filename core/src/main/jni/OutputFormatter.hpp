@@ -0,0 +1,86 @@
+#ifndef OUTPUT_FORMATTER_HPP
+#define OUTPUT_FORMATTER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "LogParser.hpp"
+
+/**
+ * OUTPUT TEMPLATE
+ *
+ * Reformats delivered events, e.g. "{iso} {level} {tag:-20} {message}". The template is
+ * compiled once into a list of ops (literal run or field) and every event is rendered in
+ * a single pass straight into the output buffer, with no intermediate strings.
+ *
+ *   {field}            time     timestamp as printed by the line format
+ *                      date     "MM-DD HH:MM:SS.mmm" (local)   iso  "YYYY-MM-DDTHH:MM:SS.mmm" (local)
+ *                      epoch_ms, epoch_ns                      level, tag, pid, tid
+ *                      process, thread (names; resolved only when used)
+ *                      buffer   logd buffer name               message, line (raw event)
+ *                      rules    ids of the extraction rules that matched, as a JSON array
+ *   {field:N}          right-aligned in N columns; {field:-N} left-aligned
+ *   {field:json}       JSON string literal, quotes included; {field:csv} RFC 4180 field
+ *   {{ and }}          literal braces
+ *
+ * Presets: "compact", "threadtime", "json", "csv". The message of a multi-line event is
+ * the messages of its lines joined by '\n' (escaped like the rest of the field).
+ *
+ * JSON LINES: the "json" preset emits one object per event,
+ *   {"ts":<epoch ms>,"level":"E","tag":"...","pid":1,"tid":2,"msg":"...","rules":[0,3]}
+ * Strings are escaped by a vectorized scanner that copies clean spans in bulk.
+ */
+class OutputFormatter {
+public:
+    /**
+     * @return false on a syntax error or unknown field; the formatter is then inactive.
+     */
+    bool compile(std::string_view templ);
+
+    bool active() const { return !m_ops.empty(); }
+
+    /**
+     * The template shows process or thread names, which the engine must resolve.
+     */
+    bool usesNames() const { return m_usesNames; }
+
+    /**
+     * Appends `text` (one event without its final '\n') rendered through the template.
+     * @param first Record of the event's first line, names resolved if usesNames().
+     * @param rules Bit i set: extraction rule i matched the event.
+     */
+    void render(std::string &out, const LineFormat &format, std::string_view text, const LogRecord &first,
+                uint64_t rules);
+
+private:
+    enum Field : uint8_t {
+        LITERAL, TIME, DATE, ISO, EPOCH_MS, EPOCH_NS, LEVEL, TAG_NAME, PID, TID,
+        PROCESS, THREAD, BUFFER, MESSAGE, LINE, RULES
+    };
+    enum Escape : uint8_t { NONE, JSON, CSV };
+
+    struct Op {
+        Field field;
+        Escape escape;
+        int16_t width;       // < 0: left-aligned
+        uint32_t offset;     // Literal: run in m_literals
+        uint32_t length;
+    };
+
+    bool addField(std::string_view spec);
+    static void appendEscaped(std::string &out, std::string_view s, Escape escape);
+    void appendDate(std::string &out, int64_t timeNs, bool iso);
+    void appendMessage(std::string &out, const Op &op, const LineFormat &format, std::string_view text,
+                       const LogRecord &first);
+
+    std::vector<Op> m_ops;
+    std::string m_literals;
+    bool m_usesNames = false;
+
+    // localtime_r() once per second of log time
+    int64_t m_second = -1;
+    char m_secondText[32] = {}; // "YYYY-MM-DDTHH:MM:SS"; room for any int fields
+};
+
+#endif // OUTPUT_FORMATTER_HPP
@@ -0,0 +1,122 @@
+#include "ProcessNames.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstdio>
+#include <cstring>
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+void ProcessNames::resolve(int32_t pid, int32_t tid, uint64_t nowMs, std::string_view &process,
+                           std::string_view &thread) {
+    if (unlikely(!m_processes)) {
+        m_processes = std::make_unique<ProcessEntry[]>(PROCESS_CAPACITY * 2);
+        m_threads = std::make_unique<ThreadEntry[]>(THREAD_CAPACITY * 2);
+    }
+    // Full tables are cleared up front, so both views below point into live entries
+    if (unlikely(m_processCount >= PROCESS_CAPACITY || m_threadCount >= THREAD_CAPACITY)) clear();
+
+    char path[64];
+    bool inserted;
+    process = thread = std::string_view();
+    if (pid > 0) {
+        ProcessEntry *e = find(m_processes.get(), PROCESS_CAPACITY * 2, pid, inserted);
+        if (inserted || nowMs - e->checkedMs >= REVALIDATE_MS) {
+            m_processCount += inserted;
+            snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+            uint64_t startTime = readStartTime(path);
+            if (inserted || (startTime != 0 && startTime != e->startTime)) {
+                snprintf(path, sizeof(path), "/proc/%d/cmdline", pid);
+                size_t length = readName(path, e->name, sizeof(e->name), true);
+                if (length == 0) { // Kernel threads and zombies have no command line
+                    snprintf(path, sizeof(path), "/proc/%d/comm", pid);
+                    length = readName(path, e->name, sizeof(e->name), false);
+                }
+                e->length = static_cast<uint8_t>(length);
+                e->startTime = startTime;
+            }
+            e->checkedMs = nowMs;
+        }
+        process = std::string_view(e->name, e->length);
+    }
+    if (tid > 0) {
+        ThreadEntry *e = find(m_threads.get(), THREAD_CAPACITY * 2, tid, inserted);
+        if (inserted || nowMs - e->checkedMs >= REVALIDATE_MS) {
+            m_threadCount += inserted;
+            if (pid > 0) snprintf(path, sizeof(path), "/proc/%d/task/%d/stat", pid, tid);
+            else snprintf(path, sizeof(path), "/proc/%d/stat", tid);
+            uint64_t startTime = readStartTime(path);
+            if (inserted || (startTime != 0 && startTime != e->startTime)) {
+                memcpy(path + strlen(path) - 4, "comm", 4);
+                e->length = static_cast<uint8_t>(readName(path, e->name, sizeof(e->name), false));
+                e->startTime = startTime;
+            }
+            e->checkedMs = nowMs;
+        }
+        thread = std::string_view(e->name, e->length);
+    }
+}
+
+std::string_view ProcessNames::packageOf(std::string_view process) {
+    size_t colon = process.find(':');
+    return colon == std::string_view::npos ? process : process.substr(0, colon);
+}
+
+void ProcessNames::clear() {
+    if (m_processes) memset(m_processes.get(), 0, sizeof(ProcessEntry) * PROCESS_CAPACITY * 2);
+    if (m_threads) memset(m_threads.get(), 0, sizeof(ThreadEntry) * THREAD_CAPACITY * 2);
+    m_processCount = m_threadCount = 0;
+}
+
+template<typename E>
+E *ProcessNames::find(E *table, uint32_t slots, int32_t id, bool &inserted) {
+    uint32_t s = (static_cast<uint32_t>(id) * 0x9E3779B1u) & (slots - 1);
+    while (table[s].id != 0) {
+        if (table[s].id == id) {
+            inserted = false;
+            return &table[s];
+        }
+        s = (s + 1) & (slots - 1);
+    }
+    table[s].id = id;
+    table[s].length = 0;
+    inserted = true;
+    return &table[s];
+}
+
+/**
+ * START TIME
+ * Field 22 of /proc/<id>/stat, counted after the last ')' since comm may contain spaces
+ * and parentheses. Pid reuse shows up as a different value.
+ * @return 0 if the process is gone.
+ */
+uint64_t ProcessNames::readStartTime(const char *statPath) {
+    char buffer[512];
+    int fd = open(statPath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    ssize_t n = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (n <= 0) return 0;
+    buffer[n] = '\0';
+
+    const char *p = strrchr(buffer, ')');
+    if (!p) return 0;
+    for (int field = 2; field < 22 && *p; ++p) { // ')' ends field 2
+        if (*p == ' ') ++field;
+    }
+    uint64_t value = 0;
+    while (*p >= '0' && *p <= '9') value = value * 10 + static_cast<uint64_t>(*p++ - '0');
+    return value;
+}
+
+size_t ProcessNames::readName(const char *path, char *out, size_t size, bool firstArgument) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    ssize_t n = read(fd, out, size);
+    close(fd);
+    if (n <= 0) return 0;
+
+    size_t length = firstArgument ? strnlen(out, static_cast<size_t>(n)) : static_cast<size_t>(n);
+    while (length > 0 && (out[length - 1] == '\n' || out[length - 1] == '\0')) --length;
+    return length;
+}
@@ -0,0 +1,66 @@
+#ifndef PROCESS_NAMES_HPP
+#define PROCESS_NAMES_HPP
+
+#include <string_view>
+#include <memory>
+#include <cstdint>
+#include <sys/types.h>
+
+/**
+ * ProcessNames: pid -> process name (cmdline, i.e. the package for app processes) and
+ * tid -> thread name (comm) for lines of other processes, which only carry numbers.
+ *
+ * Names are read from /proc lazily, the first time an id shows up, and cached in two
+ * fixed-capacity open-addressing tables with the names inline, so a line costs one or
+ * two probes and no allocation. A cached entry is revalidated at most once per
+ * REVALIDATE_MS by comparing the start time in /proc/<pid>/stat: a reused pid gets its
+ * new name, while a process that just died keeps its old one for its last lines.
+ * When a table fills up both are cleared and refilled on demand.
+ *
+ * Worker-thread only. The tables are allocated on first use. Views returned by resolve()
+ * stay valid until the next call.
+ */
+class ProcessNames {
+public:
+    static constexpr uint64_t REVALIDATE_MS = 1000;
+    static constexpr uint32_t PROCESS_CAPACITY = 256;  // Entries; tables have twice as many slots
+    static constexpr uint32_t THREAD_CAPACITY = 2048;
+
+    /**
+     * Names of `pid` / `tid` (empty if unknown or unreadable; tid < 0 is skipped).
+     */
+    void resolve(int32_t pid, int32_t tid, uint64_t nowMs, std::string_view &process,
+                 std::string_view &thread);
+
+    /**
+     * Package part of a process name ("com.foo:remote" -> "com.foo").
+     */
+    static std::string_view packageOf(std::string_view process);
+
+    void clear();
+
+private:
+    template<size_t NameSize>
+    struct Entry {
+        int32_t id;           // 0 = empty slot
+        uint8_t length;
+        uint64_t startTime;   // Field 22 of stat; 0 if the process was gone at lookup
+        uint64_t checkedMs;
+        char name[NameSize];
+    };
+    using ProcessEntry = Entry<128>;
+    using ThreadEntry = Entry<16>; // TASK_COMM_LEN
+
+    template<typename E>
+    static E *find(E *table, uint32_t slots, int32_t id, bool &inserted);
+
+    static uint64_t readStartTime(const char *statPath);
+    static size_t readName(const char *path, char *out, size_t size, bool firstArgument);
+
+    std::unique_ptr<ProcessEntry[]> m_processes;
+    std::unique_ptr<ThreadEntry[]> m_threads;
+    uint32_t m_processCount = 0;
+    uint32_t m_threadCount = 0;
+};
+
+#endif // PROCESS_NAMES_HPP
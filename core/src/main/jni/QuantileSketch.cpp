@@ -0,0 +1,127 @@
+#include "QuantileSketch.hpp"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+/**
+ * Values below this magnitude are counted as zero (log would diverge).
+ */
+static constexpr double MIN_INDEXABLE = 1e-9;
+
+QuantileSketch::QuantileSketch(double relativeAccuracy) {
+    m_gamma = (1.0 + relativeAccuracy) / (1.0 - relativeAccuracy);
+    m_logGamma = std::log(m_gamma);
+}
+
+int32_t QuantileSketch::indexOf(double positive) const {
+    return static_cast<int32_t>(std::ceil(std::log(positive) / m_logGamma));
+}
+
+double QuantileSketch::valueOf(int32_t index) const {
+    // Midpoint (in relative terms) of (gamma^(i-1), gamma^i]
+    return 2.0 * std::pow(m_gamma, index) / (m_gamma + 1.0);
+}
+
+void QuantileSketch::Store::add(int32_t index) {
+    if (bins.empty()) {
+        bins.assign(1, 0);
+        offset = index;
+    } else if (index < offset) {
+        size_t grow = static_cast<size_t>(offset - index);
+        if (bins.size() + grow > MAX_BUCKETS) {
+            // Collapse: values below the retained range are counted in the lowest bucket
+            index = offset;
+        } else {
+            bins.insert(bins.begin(), grow, 0);
+            offset = index;
+        }
+    } else if (index >= offset + static_cast<int32_t>(bins.size())) {
+        size_t needed = static_cast<size_t>(index - offset) + 1;
+        if (needed > MAX_BUCKETS) {
+            // Keep the high end (tail latencies matter most): fold the lowest buckets together
+            size_t shift = needed - MAX_BUCKETS;
+            uint64_t folded = 0;
+            for (size_t i = 0; i <= std::min(shift, bins.size() - 1); ++i) folded += bins[i];
+            if (shift >= bins.size()) {
+                bins.assign(1, folded);
+            } else {
+                bins.erase(bins.begin(), bins.begin() + static_cast<std::ptrdiff_t>(shift));
+                bins[0] = folded;
+            }
+            offset += static_cast<int32_t>(shift);
+            needed = static_cast<size_t>(index - offset) + 1;
+        }
+        bins.resize(needed, 0);
+    }
+    bins[static_cast<size_t>(index - offset)]++;
+    total++;
+}
+
+void QuantileSketch::Store::clear() {
+    bins.clear();
+    offset = 0;
+    total = 0;
+}
+
+void QuantileSketch::add(double value) {
+    if (std::isnan(value)) return;
+
+    if (value > MIN_INDEXABLE) m_positive.add(indexOf(value));
+    else if (value < -MIN_INDEXABLE) m_negative.add(indexOf(-value));
+    else m_zeros++;
+
+    if (m_count == 0) {
+        m_min = m_max = value;
+    } else {
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+    m_sum += value;
+    m_count++;
+}
+
+/**
+ * QUANTILE
+ * Walks negative buckets from the largest magnitude down, then zeros, then positive
+ * buckets upwards until the requested rank is covered. The result is clamped to the
+ * exact min/max, which also makes p0/p100 exact.
+ */
+double QuantileSketch::quantile(double q) const {
+    if (m_count == 0 || std::isnan(q)) return std::numeric_limits<double>::quiet_NaN();
+    q = std::clamp(q, 0.0, 1.0);
+    auto rank = static_cast<uint64_t>(q * static_cast<double>(m_count - 1));
+
+    uint64_t seen = 0;
+    double result = m_max;
+    bool found = false;
+    for (size_t i = m_negative.bins.size(); i-- > 0 && !found;) {
+        seen += m_negative.bins[i];
+        if (seen > rank) {
+            result = -valueOf(m_negative.offset + static_cast<int32_t>(i));
+            found = true;
+        }
+    }
+    if (!found) {
+        seen += m_zeros;
+        if (seen > rank) {
+            result = 0;
+            found = true;
+        }
+    }
+    for (size_t i = 0; i < m_positive.bins.size() && !found; ++i) {
+        seen += m_positive.bins[i];
+        if (seen > rank) {
+            result = valueOf(m_positive.offset + static_cast<int32_t>(i));
+            found = true;
+        }
+    }
+    return std::clamp(result, m_min, m_max);
+}
+
+void QuantileSketch::clear() {
+    m_positive.clear();
+    m_negative.clear();
+    m_zeros = 0;
+    m_count = 0;
+    m_min = m_max = m_sum = 0;
+}
@@ -0,0 +1,64 @@
+#ifndef QUANTILE_SKETCH_HPP
+#define QUANTILE_SKETCH_HPP
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * QuantileSketch: a DDSketch with relative-error guarantees.
+ *
+ * Every value v > 0 lands in bucket ceil(log_gamma(v)) where gamma = (1 + a) / (1 - a),
+ * so any quantile is returned within a relative error `a` of the true value. Negative
+ * values use a mirrored store and zeros a plain counter.
+ *
+ * Memory is bounded: when a store exceeds MAX_BUCKETS the lowest buckets are collapsed
+ * into one, which only degrades accuracy of the smallest quantiles.
+ * Not thread-safe; FieldStats serializes access.
+ */
+class QuantileSketch {
+public:
+    static constexpr uint32_t MAX_BUCKETS = 2048;
+
+    explicit QuantileSketch(double relativeAccuracy = 0.01);
+
+    void add(double value);
+
+    /**
+     * @param q Quantile in [0, 1].
+     * @return the estimated value, or NaN when empty.
+     */
+    double quantile(double q) const;
+
+    uint64_t count() const { return m_count; }
+    double min() const { return m_min; }
+    double max() const { return m_max; }
+    double sum() const { return m_sum; }
+
+    void clear();
+
+private:
+    // Contiguous bucket counts starting at index `offset`
+    struct Store {
+        std::vector<uint64_t> bins;
+        int32_t offset = 0;
+        uint64_t total = 0;
+
+        void add(int32_t index);
+        void clear();
+    };
+
+    int32_t indexOf(double positive) const;
+    double valueOf(int32_t index) const;
+
+    double m_gamma;
+    double m_logGamma;
+    Store m_positive;
+    Store m_negative;
+    uint64_t m_zeros = 0;
+    uint64_t m_count = 0;
+    double m_min = 0;
+    double m_max = 0;
+    double m_sum = 0;
+};
+
+#endif // QUANTILE_SKETCH_HPP
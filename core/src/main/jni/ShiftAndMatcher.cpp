@@ -0,0 +1,228 @@
+#include "ShiftAndMatcher.hpp"
+#include <cstring>
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * BYTE SET
+ * One pattern position: 256 bits.
+ */
+struct ByteSet {
+    uint64_t bits[4] = {0, 0, 0, 0};
+
+    void add(unsigned c) { bits[c >> 6] |= 1ULL << (c & 63); }
+    bool has(unsigned c) const { return bits[c >> 6] >> (c & 63) & 1; }
+
+    void addRange(unsigned lo, unsigned hi) {
+        for (unsigned c = lo; c <= hi; ++c) add(c);
+    }
+
+    void addAll(const ByteSet &other) {
+        for (int k = 0; k < 4; ++k) bits[k] |= other.bits[k];
+    }
+
+    void invert() {
+        for (uint64_t &b: bits) b = ~b;
+    }
+
+    // icase: a letter in the set brings its other case along (std::regex folds both sides)
+    void foldCase() {
+        for (unsigned c = 'a'; c <= 'z'; ++c) {
+            if (has(c) || has(c - 32)) {
+                add(c);
+                add(c - 32);
+            }
+        }
+    }
+};
+
+static inline bool isOneOf(char c, const char *chars) {
+    return c != '\0' && strchr(chars, c) != nullptr;
+}
+
+/**
+ * @return the set of a \d \w \s \D \W \S escape, false for any other letter.
+ */
+static bool classEscape(char e, ByteSet &set) {
+    ByteSet s;
+    switch (e | 0x20) {
+        case 'd':
+            s.addRange('0', '9');
+            break;
+        case 'w':
+            s.addRange('0', '9');
+            s.addRange('A', 'Z');
+            s.addRange('a', 'z');
+            s.add('_');
+            break;
+        case 's':
+            s.add(' ');
+            s.addRange('\t', '\r'); // \t \n \v \f \r
+            break;
+        default:
+            return false;
+    }
+    if (e >= 'A' && e <= 'Z') s.invert();
+    set.addAll(s);
+    return true;
+}
+
+/**
+ * @return the byte of a single-character escape (\n, \t, ..., escaped punctuation), or -1.
+ */
+static int charEscape(char e) {
+    switch (e) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case 'f': return '\f';
+        case 'v': return '\v';
+        default: break;
+    }
+    const bool alnum = (e >= '0' && e <= '9') || ((e | 0x20) >= 'a' && (e | 0x20) <= 'z');
+    return alnum || static_cast<unsigned char>(e) >= 0x80 ? -1 : static_cast<unsigned char>(e);
+}
+
+/**
+ * BRACKET CLASS
+ * Parses "[...]" starting after '['; i ends past ']'.
+ * @return false on syntax this matcher does not model ([:alpha:], \b, \x, ...).
+ */
+static bool parseClass(std::string_view p, size_t &i, bool icase, ByteSet &set) {
+    bool negate = false;
+    if (i < p.size() && p[i] == '^') {
+        negate = true;
+        ++i;
+    }
+    ByteSet s;
+    while (i < p.size() && p[i] != ']') {
+        int lo;
+        if (p[i] == '[') return false; // [:class:], [=x=], [.x.]
+        if (p[i] == '\\') {
+            if (i + 1 >= p.size()) return false;
+            const char e = p[i + 1];
+            i += 2;
+            if (classEscape(e, s)) continue;
+            lo = charEscape(e);
+            if (lo < 0) return false;
+        } else {
+            lo = static_cast<unsigned char>(p[i++]);
+        }
+        // Range "a-z"; a '-' before ']' is literal
+        if (i + 1 < p.size() && p[i] == '-' && p[i + 1] != ']') {
+            int hi;
+            if (p[i + 1] == '\\') {
+                if (i + 2 >= p.size()) return false;
+                hi = charEscape(p[i + 2]);
+                i += 3;
+            } else {
+                hi = static_cast<unsigned char>(p[i + 1]);
+                i += 2;
+            }
+            if (hi < lo) return false; // std::regex rejects it
+            s.addRange(static_cast<unsigned>(lo), static_cast<unsigned>(hi));
+        } else {
+            s.add(static_cast<unsigned>(lo));
+        }
+    }
+    if (i >= p.size()) return false;
+    ++i;
+    // Negation applies after case folding: under icase [^a] excludes 'A' too
+    if (icase) s.foldCase();
+    if (negate) s.invert();
+    set.addAll(s);
+    return true;
+}
+
+bool ShiftAndMatcher::compile(std::string_view pattern, bool icase) {
+    m_length = 0;
+    ByteSet positions[MAX_POSITIONS];
+    size_t count = 0;
+
+    for (size_t i = 0; i < pattern.size();) {
+        if (count == MAX_POSITIONS) return false;
+        ByteSet &set = positions[count];
+        const char c = pattern[i];
+        bool literal = true;
+        if (c == '\\') {
+            if (i + 1 >= pattern.size()) return false;
+            const char e = pattern[i + 1];
+            i += 2;
+            if (classEscape(e, set)) {
+                literal = false;
+            } else {
+                const int byte = charEscape(e);
+                if (byte < 0) return false; // \b, \B, back-references, \x, \u, \c
+                set.add(static_cast<unsigned>(byte));
+            }
+        } else if (c == '[') {
+            ++i;
+            if (!parseClass(pattern, i, icase, set)) return false;
+            literal = false;
+        } else if (c == '.') {
+            set.invert();
+            set.bits[0] &= ~(1ULL << '\n' | 1ULL << '\r');
+            literal = false;
+            ++i;
+        } else if (isOneOf(c, "()|^$*+?{}]")) {
+            return false;
+        } else {
+            set.add(static_cast<unsigned char>(c));
+            ++i;
+        }
+        if (literal && icase) set.foldCase();
+        // A quantifier makes the length variable: not for this matcher
+        if (i < pattern.size() && isOneOf(pattern[i], "*+?{")) return false;
+        ++count;
+    }
+    if (count == 0) return false;
+
+    memset(m_masks, 0, sizeof(m_masks));
+    memset(m_reverse, 0, sizeof(m_reverse));
+    for (size_t pos = 0; pos < count; ++pos) {
+        for (unsigned c = 0; c < 256; ++c) {
+            if (!positions[pos].has(c)) continue;
+            m_masks[c] |= 1ULL << pos;
+            m_reverse[c] |= 1ULL << (count - 1 - pos);
+        }
+    }
+    m_length = static_cast<uint32_t>(count);
+    return true;
+}
+
+size_t ShiftAndMatcher::find(std::string_view text, size_t from) const {
+    const auto *s = reinterpret_cast<const unsigned char *>(text.data());
+    const size_t n = text.size(), m = m_length;
+    if (unlikely(m == 0 || from > n || n - from < m)) return std::string_view::npos;
+    const uint64_t hit = 1ULL << (m - 1);
+
+    if (m < 4) {
+        uint64_t state = 0;
+        for (size_t i = from; i < n; ++i) {
+            state = ((state << 1) | 1) & m_masks[s[i]];
+            if (state & hit) return i + 1 - m;
+        }
+        return std::string_view::npos;
+    }
+
+    // BNDM: read the window s[pos, pos + m) backwards while some factor of the pattern
+    // still matches; the last prefix seen gives the next window start
+    const uint64_t full = m == 64 ? ~0ULL : (1ULL << m) - 1;
+    for (size_t pos = from; pos + m <= n;) {
+        size_t j = m, next = m;
+        uint64_t state = full;
+        while (true) {
+            state &= m_reverse[s[pos + j - 1]];
+            if (!state) break;
+            --j;
+            if (state & hit) {
+                if (j == 0) return pos;
+                next = j;
+            }
+            state = (state << 1) & full;
+        }
+        pos += next;
+    }
+    return std::string_view::npos;
+}
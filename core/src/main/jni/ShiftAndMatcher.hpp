@@ -0,0 +1,57 @@
+#ifndef SHIFT_AND_MATCHER_HPP
+#define SHIFT_AND_MATCHER_HPP
+
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * BIT-PARALLEL MATCHER
+ *
+ * Many filters are short fixed-length patterns with classes or wildcards ("E/Ok[Hh]ttp",
+ * "err.r", "\d\d:\d\d"). For those, every position of the pattern is a set of bytes and
+ * the whole automaton state fits in one 64-bit word: bit i of mask[c] says that byte c
+ * may appear at position i. No DFA, no backtracking, 4 KB of tables.
+ *
+ *   Shift-And  state = ((state << 1) | 1) & mask[c] per byte, a match when bit m-1 is set.
+ *              Branch-free per byte; used for patterns of 1-3 positions.
+ *   BNDM       the same masks mirrored, scanned backwards in a window of m bytes; a
+ *              window that cannot hold a match is skipped whole, so longer patterns read
+ *              only part of the line.
+ *
+ * Accepted syntax (anything else is left to std::regex): literal characters, escaped
+ * punctuation, \n \t \r \f \v, '.', \d \w \s \D \W \S and bracket classes with ranges,
+ * negation and the escapes above; at most 64 positions, no quantifiers, groups,
+ * alternation or anchors. Semantics follow std::regex<char> ECMAScript: '.' excludes
+ * '\n' and '\r', icase folds ASCII letters, every other byte matches itself.
+ */
+class ShiftAndMatcher {
+public:
+    static constexpr size_t MAX_POSITIONS = 64;
+
+    /**
+     * @return true if `pattern` fits the accepted syntax; the matcher is then active.
+     */
+    bool compile(std::string_view pattern, bool icase);
+
+    void clear() { m_length = 0; }
+
+    bool active() const { return m_length > 0; }
+
+    /**
+     * Every match has exactly this many bytes.
+     */
+    size_t length() const { return m_length; }
+
+    /**
+     * @return the start of the leftmost match at or after `from`, or std::string_view::npos.
+     */
+    size_t find(std::string_view text, size_t from = 0) const;
+
+private:
+    uint64_t m_masks[256];    // Bit i: the byte may appear at position i
+    uint64_t m_reverse[256];  // Bit m-1-i: the same, for BNDM's backward scan
+    uint32_t m_length = 0;
+};
+
+#endif // SHIFT_AND_MATCHER_HPP
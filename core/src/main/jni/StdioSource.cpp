@@ -0,0 +1,124 @@
+#include "StdioSource.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <android/log.h>
+
+#define TAG "LogcatEngine-Stdio"
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * BUFFERS: printf output is far thinner than logcat's, so one 16KB read per batch and a
+ * 256KB pipe (bursts while the worker is busy) are plenty.
+ */
+static constexpr size_t STDIO_READ_SIZE = 16 * 1024;
+static constexpr int STDIO_PIPE_SIZE = 256 * 1024;
+
+StdioSource::StdioSource(int fd, const char *tag, char level) : m_fd(fd), m_tag(tag), m_level(level) {}
+
+StdioSource::~StdioSource() {
+    uninstall();
+}
+
+/**
+ * INSTALL
+ * The stdio stream is flushed first so nothing buffered before the swap ends up in the
+ * pipe, and stdout is switched to line buffering (it is fully buffered when not a tty),
+ * otherwise lines would only arrive in 4KB chunks.
+ */
+bool StdioSource::install(const std::string &level, const std::string &tagFilter, size_t accumulatorCap) {
+    if (m_readFd >= 0) return false;
+
+    int p[2];
+    if (pipe2(p, O_CLOEXEC) < 0) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "install(%s): pipe2() failed: %s", m_tag, strerror(errno));
+        return false;
+    }
+    fcntl(p[0], F_SETFL, O_NONBLOCK);
+    fcntl(p[1], F_SETFL, O_NONBLOCK);
+    fcntl(p[1], F_SETPIPE_SZ, STDIO_PIPE_SIZE); // Not fatal if refused
+
+    FILE *stream = m_fd == STDOUT_FILENO ? stdout : stderr;
+    fflush(stream);
+    if (stream == stdout) setvbuf(stdout, nullptr, _IOLBF, BUFSIZ);
+
+    m_originalFd = fcntl(m_fd, F_DUPFD_CLOEXEC, 0); // -1 if the descriptor was closed: no tee
+    if (dup2(p[1], m_fd) < 0) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "install(%s): dup2() failed: %s", m_tag, strerror(errno));
+        close(p[0]);
+        close(p[1]);
+        if (m_originalFd >= 0) close(m_originalFd);
+        m_originalFd = -1;
+        return false;
+    }
+    close(p[1]);
+
+    m_readFd = p[0];
+    m_filter.configure(level, tagFilter);
+    if (!m_read) m_read = std::make_unique<char[]>(STDIO_READ_SIZE);
+    m_accumulatorCap = accumulatorCap;
+    return true;
+}
+
+void StdioSource::uninstall() {
+    if (m_readFd < 0) return;
+    fflush(m_fd == STDOUT_FILENO ? stdout : stderr);
+
+    if (m_originalFd >= 0) {
+        dup2(m_originalFd, m_fd);
+        close(m_originalFd);
+        m_originalFd = -1;
+    } else {
+        int devNull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+        if (devNull >= 0) {
+            dup2(devNull, m_fd);
+            close(devNull);
+        }
+    }
+    close(m_readFd);
+    m_readFd = -1;
+    m_accumulator.clear();
+}
+
+/**
+ * DRAIN
+ * One read per batch, split on '\n' exactly like processLogStream().
+ */
+ssize_t StdioSource::drain(LineSink &sink) {
+    ssize_t bytes = read(m_readFd, m_read.get(), STDIO_READ_SIZE);
+    if (unlikely(bytes <= 0)) {
+        if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+        return -1; // Nobody holds the write end any more
+    }
+    if (m_originalFd >= 0) (void) write(m_originalFd, m_read.get(), static_cast<size_t>(bytes));
+
+    m_accumulator.append(m_read.get(), static_cast<size_t>(bytes));
+    size_t pos = 0, next;
+    while ((next = m_accumulator.find('\n', pos)) != std::string::npos) {
+        bool ok = emit(sink, std::string_view(&m_accumulator[pos], next - pos));
+        pos = next + 1;
+        if (unlikely(!ok)) break;
+    }
+    m_accumulator.erase(0, pos);
+
+    // A line that never ends is delivered in pieces rather than dropped
+    if (unlikely(m_accumulator.size() > m_accumulatorCap)) {
+        emit(sink, m_accumulator);
+        m_accumulator.clear();
+    }
+    return bytes;
+}
+
+bool StdioSource::emit(LineSink &sink, std::string_view text) {
+    if (!text.empty() && text.back() == '\r') text.remove_suffix(1);
+    if (!m_filter.allows(m_tag, m_level)) return true;
+
+    LogRecord rec;
+    std::string_view line = m_renderer.render(m_line, sink.lineFormat(), TimeLineRenderer::nowNs(), m_level, m_tag,
+                                              getpid(), -1, text, rec);
+    return sink.onSourceLine(line, &rec);
+}
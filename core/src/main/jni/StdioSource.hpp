@@ -0,0 +1,62 @@
+#ifndef STDIO_SOURCE_HPP
+#define STDIO_SOURCE_HPP
+
+#include <memory>
+#include <string>
+#include "LogSource.hpp"
+
+/**
+ * STDOUT / STDERR CAPTURE
+ *
+ * Android points fd 1 and 2 of app processes at /dev/null, so whatever native libraries
+ * print is lost. install() swaps the descriptor for a pipe read by the engine; each line
+ * becomes a record with a synthetic tag ("stdout" at I, "stderr" at W) and the data is
+ * still written through to the original target. The write end is non-blocking: a stalled
+ * engine costs the printing thread its output, never a hang.
+ */
+class StdioSource : public LogSource {
+public:
+    /**
+     * @param fd STDOUT_FILENO or STDERR_FILENO.
+     */
+    StdioSource(int fd, const char *tag, char level);
+    ~StdioSource() override;
+
+    StdioSource(const StdioSource &) = delete;
+    StdioSource &operator=(const StdioSource &) = delete;
+
+    /**
+     * Redirects the descriptor. Lines are filtered like `logcat <tagFilter>` / `*:<level>`.
+     * @param accumulatorCap A longer unterminated line is delivered in pieces of this size.
+     */
+    bool install(const std::string &level, const std::string &tagFilter, size_t accumulatorCap);
+
+    /**
+     * Restores the original descriptor; a pending partial line is dropped.
+     */
+    void uninstall();
+
+    bool installed() const { return m_readFd >= 0; }
+
+    const char *name() const override { return m_tag; }
+    int pollFd() const override { return m_readFd; }
+    ssize_t drain(LineSink &sink) override;
+
+private:
+    bool emit(LineSink &sink, std::string_view text);
+
+    const int m_fd;
+    const char *const m_tag;
+    const char m_level;
+    int m_readFd = -1;
+    int m_originalFd = -1; // dup() of the descriptor before install(), target of the tee
+
+    LevelFilter m_filter;
+    std::unique_ptr<char[]> m_read;
+    std::string m_accumulator;
+    size_t m_accumulatorCap = 0;
+    std::string m_line;
+    TimeLineRenderer m_renderer;
+};
+
+#endif // STDIO_SOURCE_HPP
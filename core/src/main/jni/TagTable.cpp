@@ -0,0 +1,164 @@
+#include "TagTable.hpp"
+#include <cstring>
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * INITIAL SLOTS: a busy device logs a few hundred distinct tags; 1024 slots (4KB) cover
+ * that without growing, and each growth doubles.
+ */
+static constexpr uint32_t INITIAL_SLOTS = 1024;
+
+namespace {
+    struct SpinGuard {
+        explicit SpinGuard(std::atomic_flag &flag) : m_flag(flag) {
+            while (m_flag.test_and_set(std::memory_order_acquire));
+        }
+        ~SpinGuard() { m_flag.clear(std::memory_order_release); }
+        std::atomic_flag &m_flag;
+    };
+}
+
+TagTable::TagTable() {
+    m_slotArrays.emplace_back(makeSlots(INITIAL_SLOTS));
+    m_slots.store(m_slotArrays.back().get(), std::memory_order_release);
+    intern(std::string_view()); // Reserves EMPTY_TAG
+}
+
+TagTable::~TagTable() {
+    for (auto &chunk: m_chunks) delete[] chunk.load(std::memory_order_relaxed);
+}
+
+/**
+ * HASH: FNV-1a. Low bits pick the slot, high 16 bits are kept in the slot to reject
+ * most mismatches without touching the entry.
+ */
+uint32_t TagTable::hashOf(std::string_view tag) {
+    uint32_t h = 2166136261u;
+    for (char c: tag) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+TagTable::Slots *TagTable::makeSlots(uint32_t capacity) {
+    auto *slots = new Slots{capacity - 1, std::make_unique<std::atomic<uint32_t>[]>(capacity)};
+    for (uint32_t i = 0; i < capacity; ++i) slots->cells[i].store(0, std::memory_order_relaxed);
+    return slots;
+}
+
+/**
+ * PROBE (LOCK-FREE)
+ * Linear probing until an empty slot. Slots are only ever filled, never cleared, so a
+ * reader racing an insert either sees the new slot or stops at the empty one before it.
+ */
+TagTable::TagId TagTable::probe(const Slots *slots, std::string_view tag, uint32_t hash) const {
+    const uint32_t check = hash & 0xFFFF0000u;
+    for (uint32_t i = hash & slots->mask;; i = (i + 1) & slots->mask) {
+        uint32_t cell = slots->cells[i].load(std::memory_order_acquire);
+        if (cell == 0) return OVERFLOW_TAG;
+        if ((cell & 0xFFFF0000u) != check) continue;
+
+        auto id = static_cast<TagId>((cell & 0xFFFFu) - 1);
+        const Entry *e = entry(id);
+        if (likely(e && e->length == tag.size() && memcmp(e->name, tag.data(), tag.size()) == 0)) return id;
+    }
+}
+
+TagTable::TagId TagTable::find(std::string_view tag) const {
+    return probe(m_slots.load(std::memory_order_acquire), tag, hashOf(tag));
+}
+
+TagTable::TagId TagTable::intern(std::string_view tag) {
+    const uint32_t hash = hashOf(tag);
+    TagId id = probe(m_slots.load(std::memory_order_acquire), tag, hash);
+    if (likely(id != OVERFLOW_TAG)) return id;
+
+    SpinGuard guard(m_lock);
+    // Another thread may have inserted it while we waited
+    id = probe(m_slots.load(std::memory_order_relaxed), tag, hash);
+    return id != OVERFLOW_TAG ? id : insertLocked(tag, hash);
+}
+
+std::string_view TagTable::name(TagId id) const {
+    const Entry *e = entry(id);
+    return e ? std::string_view(e->name, e->length) : std::string_view();
+}
+
+/**
+ * INSERT (UNDER LOCK)
+ * The entry is published (m_size) before its slot, so any reader that finds the slot
+ * also finds a complete entry.
+ */
+TagTable::TagId TagTable::insertLocked(std::string_view tag, uint32_t hash) {
+    const uint32_t id = m_size.load(std::memory_order_relaxed);
+    if (unlikely(id >= MAX_TAGS)) return OVERFLOW_TAG;
+
+    Slots *slots = m_slots.load(std::memory_order_relaxed);
+    if ((id + 1) * 2 > slots->mask + 1) {
+        growLocked();
+        slots = m_slots.load(std::memory_order_relaxed);
+    }
+
+    auto &chunk = m_chunks[id >> CHUNK_SHIFT];
+    Entry *entries = chunk.load(std::memory_order_relaxed);
+    if (!entries) {
+        entries = new Entry[CHUNK_SIZE];
+        chunk.store(entries, std::memory_order_release);
+    }
+    Entry &e = entries[id & (CHUNK_SIZE - 1)];
+    e.name = storeName(tag);
+    e.length = static_cast<uint32_t>(tag.size());
+    e.hash = hash;
+    m_size.store(id + 1, std::memory_order_release);
+
+    uint32_t i = hash & slots->mask;
+    while (slots->cells[i].load(std::memory_order_relaxed) != 0) i = (i + 1) & slots->mask;
+    slots->cells[i].store((hash & 0xFFFF0000u) | (id + 1), std::memory_order_release);
+    return static_cast<TagId>(id);
+}
+
+/**
+ * GROW (UNDER LOCK)
+ * Rehashes into a doubled array and publishes it; readers still probing the old array
+ * see a consistent (if slightly older) table.
+ */
+void TagTable::growLocked() {
+    const Slots *old = m_slots.load(std::memory_order_relaxed);
+    Slots *grown = makeSlots((old->mask + 1) * 2);
+
+    const uint32_t count = m_size.load(std::memory_order_relaxed);
+    for (uint32_t id = 0; id < count; ++id) {
+        const Entry *e = entry(static_cast<TagId>(id));
+        uint32_t i = e->hash & grown->mask;
+        while (grown->cells[i].load(std::memory_order_relaxed) != 0) i = (i + 1) & grown->mask;
+        grown->cells[i].store((e->hash & 0xFFFF0000u) | (id + 1), std::memory_order_relaxed);
+    }
+
+    m_slotArrays.emplace_back(grown);
+    m_slots.store(grown, std::memory_order_release);
+}
+
+/**
+ * NAME STORAGE: bump allocation in 16KB blocks; names are never freed individually.
+ */
+const char *TagTable::storeName(std::string_view tag) {
+    if (tag.empty()) return "";
+    if (tag.size() > NAME_BLOCK / 4) {
+        // Dedicated block, kept behind the current bump block
+        auto at = m_nameBlocks.empty() ? m_nameBlocks.end() : m_nameBlocks.end() - 1;
+        char *dst = m_nameBlocks.emplace(at, new char[tag.size()])->get();
+        memcpy(dst, tag.data(), tag.size());
+        return dst;
+    }
+    if (m_nameUsed + tag.size() > NAME_BLOCK) {
+        m_nameBlocks.emplace_back(new char[NAME_BLOCK]);
+        m_nameUsed = 0;
+    }
+    char *dst = m_nameBlocks.back().get() + m_nameUsed;
+    memcpy(dst, tag.data(), tag.size());
+    m_nameUsed += tag.size();
+    return dst;
+}
@@ -0,0 +1,115 @@
+#ifndef TAG_TABLE_HPP
+#define TAG_TABLE_HPP
+
+#include <string_view>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+/**
+ * TagTable: process-wide intern table mapping log tags to dense 16-bit ids.
+ *
+ * Tags repeat on almost every line, so the engine stores and compares ids instead of
+ * strings: the event assembler keys pending events by id, the columnar export indexes
+ * its file dictionary by id and per-tag line counts live next to the name.
+ *
+ * Lookups are lock-free from any thread (open addressing over an atomically published
+ * slot array). Inserts take a spinlock; when the load factor exceeds 1/2 the writer
+ * publishes a doubled slot array and retires the old one, which stays readable until
+ * the table is destroyed. Names and entries never move once published.
+ *
+ * Id 0 is the empty tag (lines without a header). Once MAX_TAGS ids are in use, new tags
+ * all map to OVERFLOW_TAG.
+ */
+class TagTable {
+public:
+    using TagId = uint16_t;
+
+    static constexpr TagId EMPTY_TAG = 0;
+    static constexpr TagId OVERFLOW_TAG = 0xFFFF;
+    static constexpr uint32_t MAX_TAGS = OVERFLOW_TAG; // Ids 0 .. MAX_TAGS - 1
+
+    TagTable();
+    ~TagTable();
+
+    TagTable(const TagTable&) = delete;
+    TagTable& operator=(const TagTable&) = delete;
+
+    /**
+     * HOT PATH: returns the id of `tag`, inserting it on first use.
+     */
+    TagId intern(std::string_view tag);
+
+    /**
+     * @return the id of `tag`, or OVERFLOW_TAG if it was never interned. Never inserts.
+     */
+    TagId find(std::string_view tag) const;
+
+    /**
+     * Name of an id; the view stays valid for the lifetime of the table.
+     */
+    std::string_view name(TagId id) const;
+
+    /**
+     * Number of ids handed out (ids are dense, so valid ids are [0, size())).
+     */
+    uint32_t size() const { return m_size.load(std::memory_order_acquire); }
+
+    /**
+     * Per-tag line counter, bumped by the worker for every captured line.
+     */
+    void countLine(TagId id) {
+        Entry* e = entry(id);
+        if (e) e->lines.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t lines(TagId id) const {
+        const Entry* e = entry(id);
+        return e ? e->lines.load(std::memory_order_relaxed) : 0;
+    }
+
+private:
+    struct Entry {
+        const char* name = nullptr;
+        uint32_t length = 0;
+        uint32_t hash = 0;
+        std::atomic<uint64_t> lines{0};
+    };
+
+    // Slot value: (hash & 0xFFFF0000) | (id + 1); 0 = empty
+    struct Slots {
+        uint32_t mask;
+        std::unique_ptr<std::atomic<uint32_t>[]> cells;
+    };
+
+    static constexpr uint32_t CHUNK_SHIFT = 10;                   // 1024 entries per chunk
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_SHIFT;
+    static constexpr uint32_t CHUNK_COUNT = (MAX_TAGS + CHUNK_SIZE) / CHUNK_SIZE;
+    static constexpr size_t NAME_BLOCK = 16 * 1024;
+
+    static uint32_t hashOf(std::string_view tag);
+    static Slots* makeSlots(uint32_t capacity);
+
+    Entry* entry(TagId id) const {
+        if (id >= m_size.load(std::memory_order_acquire)) return nullptr;
+        return &m_chunks[id >> CHUNK_SHIFT].load(std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+    }
+
+    TagId probe(const Slots* slots, std::string_view tag, uint32_t hash) const;
+    TagId insertLocked(std::string_view tag, uint32_t hash);
+    void growLocked();
+    const char* storeName(std::string_view tag);
+
+    std::atomic<Slots*> m_slots{nullptr};
+    std::atomic<Entry*> m_chunks[CHUNK_COUNT] = {};
+    std::atomic<uint32_t> m_size{0};
+
+    // --- WRITER STATE (under m_lock) ---
+    std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
+    std::vector<std::unique_ptr<Slots>> m_slotArrays;   // Current and retired arrays (all readable)
+    std::vector<std::unique_ptr<char[]>> m_nameBlocks;
+    size_t m_nameUsed = NAME_BLOCK;
+};
+
+#endif // TAG_TABLE_HPP
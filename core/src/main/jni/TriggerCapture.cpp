@@ -0,0 +1,278 @@
+#include "TriggerCapture.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <android/log.h>
+
+#define TAG "LogcatEngine-Trigger"
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * HISTORY RING: 1MB holds roughly 10-15s of a busy single-app log stream.
+ * Older entries are evicted first, so the effective pre-window is min(preSeconds, ring).
+ * This is the default; the memory budget may shrink it under pressure.
+ */
+static constexpr size_t TRIGGER_RING_SIZE = 1024 * 1024;
+
+/**
+ * DEFAULT TRIGGERS: Java crashes, ANRs and native crash (tombstone / debuggerd) markers.
+ */
+static const char *const DEFAULT_TRIGGERS[] = {
+        "FATAL EXCEPTION",
+        "ANR in ",
+        "Fatal signal ",
+        "*** *** *** *** *** *** *** *** *** *** *** *** *** *** *** ***",
+        "Abort message: ",
+};
+
+TriggerCapture::TriggerCapture() : m_ringLimit(TRIGGER_RING_SIZE) {}
+
+TriggerCapture::~TriggerCapture() {
+    closeBundle();
+}
+
+uint64_t TriggerCapture::monotonicMs() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000ULL + static_cast<uint64_t>(ts.tv_nsec) / 1000000ULL;
+}
+
+/**
+ * CONFIGURE
+ * Stores the configuration for the worker thread; the hot path only checks an atomic flag.
+ */
+void TriggerCapture::configure(const TriggerConfig &config) {
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    m_pendingConfig = config;
+    m_configDirty.store(true, std::memory_order_release);
+}
+
+void TriggerCapture::applyPendingConfig() {
+    TriggerConfig cfg;
+    {
+        std::lock_guard<std::mutex> lock(m_configMutex);
+        cfg = m_pendingConfig;
+        m_configDirty.store(false, std::memory_order_relaxed);
+    }
+
+    closeBundle();
+
+    m_directory = cfg.directory;
+    m_enabled = !m_directory.empty();
+    m_preMs = static_cast<uint64_t>(cfg.preSeconds > 0 ? cfg.preSeconds : 0) * 1000ULL;
+    m_postMs = static_cast<uint64_t>(cfg.postSeconds > 0 ? cfg.postSeconds : 0) * 1000ULL;
+
+    m_patternStore.clear();
+    if (cfg.patterns.empty()) {
+        for (const char *p: DEFAULT_TRIGGERS) m_patternStore.emplace_back(p);
+    } else {
+        for (const auto &p: cfg.patterns) if (!p.empty()) m_patternStore.push_back(p);
+    }
+    m_patterns.assign(m_patternStore.begin(), m_patternStore.end());
+
+    // The ring is only allocated once capture is enabled, and kept for the engine lifetime
+    if (m_enabled && !m_ring) {
+        m_ring = std::make_unique<char[]>(m_ringLimit);
+        m_ringCapacity = m_ringLimit;
+    }
+    if (!m_enabled) {
+        m_ringHead = m_ringTail = m_ringUsed = 0;
+    }
+}
+
+/**
+ * ON LINE (HOT PATH)
+ * Records the line in history, matches trigger markers and feeds an active bundle.
+ */
+void TriggerCapture::onLine(std::string_view line, uint64_t nowMs) {
+    if (unlikely(m_configDirty.load(std::memory_order_acquire))) applyPendingConfig();
+    if (likely(!m_enabled)) return;
+
+    if (m_bundleFd >= 0) {
+        appendToBundle(line.data(), line.size());
+        appendToBundle("\n", 1);
+    } else if (const std::string_view *hit = matchTrigger(line)) {
+        openBundle(line, *hit, nowMs);
+    }
+
+    ringPush(line, nowMs);
+}
+
+const std::string_view *TriggerCapture::matchTrigger(std::string_view line) const {
+    for (const auto &p: m_patterns) {
+        if (line.size() >= p.size() && memmem(line.data(), line.size(), p.data(), p.size())) {
+            return &p;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * TICK
+ * Pushes staged bytes to the kernel (page cache survives process death) and finalizes
+ * the bundle after the post window.
+ */
+void TriggerCapture::tick(uint64_t nowMs) {
+    if (unlikely(m_configDirty.load(std::memory_order_acquire))) applyPendingConfig();
+    if (m_bundleFd < 0) return;
+
+    flushBundle();
+    if (nowMs >= m_bundleDeadlineMs) closeBundle();
+}
+
+/**
+ * OPEN BUNDLE
+ * Writes a small header and the pre-event window straight away: for our own crash the
+ * post window may never arrive because the process is about to be killed.
+ */
+void TriggerCapture::openBundle(std::string_view triggerLine, std::string_view pattern, uint64_t nowMs) {
+    struct timespec wall{};
+    clock_gettime(CLOCK_REALTIME, &wall);
+    uint64_t wallMs = static_cast<uint64_t>(wall.tv_sec) * 1000ULL + static_cast<uint64_t>(wall.tv_nsec) / 1000000ULL;
+
+    char name[64];
+    snprintf(name, sizeof(name), "/crash_%llu.log", static_cast<unsigned long long>(wallMs));
+    m_bundlePath = m_directory + name;
+    std::string partial = m_bundlePath + ".partial";
+
+    m_bundleFd = open(partial.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+    if (unlikely(m_bundleFd < 0)) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG,
+                            "openBundle(): open(%s) failed: %s", partial.c_str(), strerror(errno));
+        return;
+    }
+    m_bundles.fetch_add(1, std::memory_order_relaxed);
+    m_bundleDeadlineMs = nowMs + m_postMs;
+
+    char header[160];
+    int n = snprintf(header, sizeof(header),
+                     "# LogcatEngine bundle v1\n# time_ms=%llu pre_s=%llu post_s=%llu\n# trigger=",
+                     static_cast<unsigned long long>(wallMs),
+                     static_cast<unsigned long long>(m_preMs / 1000),
+                     static_cast<unsigned long long>(m_postMs / 1000));
+    appendToBundle(header, static_cast<size_t>(n));
+    appendToBundle(pattern.data(), pattern.size());
+    appendToBundle("\n", 1);
+
+    // Pre-event window: every ring entry newer than (now - pre)
+    uint64_t cutoff = nowMs > m_preMs ? nowMs - m_preMs : 0;
+    size_t pos = m_ringTail, remaining = m_ringUsed;
+    while (remaining > 0) {
+        EntryHeader eh{};
+        ringRead(pos, &eh, sizeof(eh));
+        size_t payloadPos = (pos + sizeof(eh)) % m_ringCapacity;
+        if (eh.tsMs >= cutoff) {
+            size_t first = std::min<size_t>(eh.len, m_ringCapacity - payloadPos);
+            appendToBundle(m_ring.get() + payloadPos, first);
+            if (first < eh.len) appendToBundle(m_ring.get(), eh.len - first);
+            appendToBundle("\n", 1);
+        }
+        size_t entry = sizeof(eh) + eh.len;
+        pos = (pos + entry) % m_ringCapacity;
+        remaining -= entry;
+    }
+
+    appendToBundle(triggerLine.data(), triggerLine.size());
+    appendToBundle("\n", 1);
+    flushBundle();
+
+    __android_log_print(ANDROID_LOG_INFO, TAG, "Trigger '%.*s' hit, capturing into %s",
+                        static_cast<int>(pattern.size()), pattern.data(), m_bundlePath.c_str());
+}
+
+void TriggerCapture::finish() {
+    closeBundle();
+}
+
+void TriggerCapture::closeBundle() {
+    if (m_bundleFd < 0) return;
+    flushBundle();
+    fdatasync(m_bundleFd);
+    close(m_bundleFd);
+    m_bundleFd = -1;
+
+    std::string partial = m_bundlePath + ".partial";
+    if (rename(partial.c_str(), m_bundlePath.c_str()) != 0) {
+        __android_log_print(ANDROID_LOG_WARN, TAG,
+                            "closeBundle(): rename failed: %s", strerror(errno));
+    }
+}
+
+void TriggerCapture::appendToBundle(const char *data, size_t len) {
+    m_bundleBuffer.append(data, len);
+}
+
+void TriggerCapture::flushBundle() {
+    size_t total = 0;
+    while (total < m_bundleBuffer.size() && m_bundleFd >= 0) {
+        ssize_t w = write(m_bundleFd, m_bundleBuffer.data() + total, m_bundleBuffer.size() - total);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            __android_log_print(ANDROID_LOG_WARN, TAG,
+                                "flushBundle(): write failed: %s", strerror(errno));
+            break;
+        }
+        total += static_cast<size_t>(w);
+    }
+    m_bundleBuffer.clear();
+}
+
+// --- HISTORY RING ---
+
+void TriggerCapture::ringPush(std::string_view line, uint64_t nowMs) {
+    size_t need = sizeof(EntryHeader) + line.size();
+    if (unlikely(need > m_ringCapacity / 4)) return; // Pathological line: not worth evicting history
+
+    while (m_ringCapacity - m_ringUsed < need) ringPopOldest();
+
+    EntryHeader eh{nowMs, static_cast<uint32_t>(line.size())};
+    ringWrite(m_ringHead, &eh, sizeof(eh));
+    ringWrite((m_ringHead + sizeof(eh)) % m_ringCapacity, line.data(), line.size());
+    m_ringHead = (m_ringHead + need) % m_ringCapacity;
+    m_ringUsed += need;
+}
+
+/**
+ * RING RESIZE
+ * Entries are copied oldest-first into a linear new ring after evicting the oldest ones
+ * that no longer fit, so history order and the entry format are preserved.
+ */
+void TriggerCapture::setRingCapacity(size_t bytes) {
+    m_ringLimit = bytes;
+    if (!m_ring || bytes == m_ringCapacity) return;
+
+    while (m_ringUsed > bytes) ringPopOldest();
+    auto ring = std::make_unique<char[]>(bytes);
+    ringRead(m_ringTail, ring.get(), m_ringUsed);
+
+    m_ring = std::move(ring);
+    m_ringCapacity = bytes;
+    m_ringTail = 0;
+    m_ringHead = m_ringUsed % m_ringCapacity;
+}
+
+void TriggerCapture::ringPopOldest() {
+    EntryHeader eh{};
+    ringRead(m_ringTail, &eh, sizeof(eh));
+    size_t entry = sizeof(eh) + eh.len;
+    m_ringTail = (m_ringTail + entry) % m_ringCapacity;
+    m_ringUsed -= entry;
+}
+
+void TriggerCapture::ringRead(size_t pos, void *out, size_t len) const {
+    size_t first = std::min(len, m_ringCapacity - pos);
+    memcpy(out, m_ring.get() + pos, first);
+    if (first < len) memcpy(static_cast<char *>(out) + first, m_ring.get(), len - first);
+}
+
+void TriggerCapture::ringWrite(size_t pos, const void *in, size_t len) {
+    size_t first = std::min(len, m_ringCapacity - pos);
+    memcpy(m_ring.get() + pos, in, first);
+    if (first < len) memcpy(m_ring.get(), static_cast<const char *>(in) + first, len - first);
+}
@@ -0,0 +1,127 @@
+#ifndef TRIGGER_CAPTURE_HPP
+#define TRIGGER_CAPTURE_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Crash/ANR trigger configuration.
+ * When a trigger pattern is seen, the preceding `preSeconds` of log history and the
+ * following `postSeconds` of live log are written into a bundle file inside `directory`.
+ */
+struct TriggerConfig {
+    std::string directory;             // Output directory for bundles; empty disables capture
+    int preSeconds = 10;               // History window captured before the trigger line
+    int postSeconds = 5;               // Live window captured after the trigger line
+    std::vector<std::string> patterns; // Literal trigger markers; empty selects the defaults
+};
+
+/**
+ * TriggerCapture: keeps a byte ring of recent lines and, on a trigger hit, snapshots it
+ * (plus a post-event window) into a bundle file using raw syscalls only.
+ *
+ * Threading: onLine()/tick() are called exclusively from the engine worker thread.
+ * configure() may be called from any thread; the change is picked up on the next line.
+ */
+class TriggerCapture {
+public:
+    TriggerCapture();
+    ~TriggerCapture();
+
+    /**
+     * Installs a new configuration. Thread-safe; an in-flight bundle is finalized first.
+     */
+    void configure(const TriggerConfig& config);
+
+    /**
+     * Feeds one raw line (without the trailing '\n') into the ring and the trigger matcher.
+     * @param nowMs Monotonic timestamp of the read batch the line belongs to.
+     */
+    void onLine(std::string_view line, uint64_t nowMs);
+
+    /**
+     * Flushes pending bundle bytes and closes the bundle once the post window elapsed.
+     * Called once per read batch and on every epoll timeout.
+     */
+    void tick(uint64_t nowMs);
+
+    /**
+     * Finalizes an in-flight bundle immediately (engine shutdown).
+     */
+    void finish();
+
+    /**
+     * Number of bundles started since the engine was created.
+     */
+    uint64_t bundleCount() const { return m_bundles.load(std::memory_order_relaxed); }
+
+    /**
+     * Resizes the history ring (memory budget). Worker thread only; the newest history
+     * that fits is kept. Takes effect at allocation time if capture is not enabled yet.
+     */
+    void setRingCapacity(size_t bytes);
+
+    /**
+     * Bytes currently allocated for the history ring.
+     */
+    size_t memoryUsage() const { return m_ring ? m_ringCapacity : 0; }
+
+    /**
+     * Monotonic clock in milliseconds, shared with the engine loop.
+     */
+    static uint64_t monotonicMs();
+
+private:
+    // Fixed-size entry header stored in front of every line inside the ring
+    struct EntryHeader {
+        uint64_t tsMs;
+        uint32_t len;
+    };
+
+    void applyPendingConfig();
+    const std::string_view* matchTrigger(std::string_view line) const;
+    void openBundle(std::string_view triggerLine, std::string_view pattern, uint64_t nowMs);
+    void closeBundle();
+    void appendToBundle(const char* data, size_t len);
+    void flushBundle();
+
+    void ringPush(std::string_view line, uint64_t nowMs);
+    void ringPopOldest();
+    void ringRead(size_t pos, void* out, size_t len) const;
+    void ringWrite(size_t pos, const void* in, size_t len);
+
+    // --- ACTIVE CONFIGURATION (worker thread only) ---
+    bool m_enabled = false;
+    std::string m_directory;
+    uint64_t m_preMs = 0;
+    uint64_t m_postMs = 0;
+    std::vector<std::string> m_patternStore;
+    std::vector<std::string_view> m_patterns;
+
+    // --- PENDING CONFIGURATION (handed over from JNI threads) ---
+    std::mutex m_configMutex;
+    TriggerConfig m_pendingConfig;
+    std::atomic<bool> m_configDirty{false};
+
+    // --- HISTORY RING ---
+    std::unique_ptr<char[]> m_ring;
+    size_t m_ringCapacity = 0;
+    size_t m_ringHead = 0;  // Write offset
+    size_t m_ringTail = 0;  // Offset of the oldest entry
+    size_t m_ringUsed = 0;
+    size_t m_ringLimit;     // Capacity to allocate (memory budget quota)
+
+    // --- ACTIVE BUNDLE ---
+    int m_bundleFd = -1;
+    uint64_t m_bundleDeadlineMs = 0;
+    std::string m_bundlePath;      // Final path; the file is written as "<path>.partial"
+    std::string m_bundleBuffer;    // Staging buffer flushed once per read batch
+    std::atomic<uint64_t> m_bundles{0};
+};
+
+#endif // TRIGGER_CAPTURE_HPP
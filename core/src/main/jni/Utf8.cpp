@@ -0,0 +1,229 @@
+#include "Utf8.hpp"
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+size_t asciiPrefix(const char *p, size_t n) {
+    const char *begin = p, *end = p + n;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; end - p >= 16; p += 16) {
+        const uint8x16_t high = vcgeq_u8(vld1q_u8(reinterpret_cast<const uint8_t *>(p)), vdupq_n_u8(0x80));
+        // Narrow to 4 bits per byte: no movemask on NEON
+        const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(high), 4)), 0);
+        if (mask) return static_cast<size_t>(p - begin) + (__builtin_ctzll(mask) >> 2);
+    }
+#elif defined(__SSE2__)
+    for (; end - p >= 16; p += 16) {
+        const int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        if (mask) return static_cast<size_t>(p - begin) + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+#endif
+    for (; end - p >= 8; p += 8) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        v &= 0x8080808080808080ULL;
+        if (v) return static_cast<size_t>(p - begin) + (__builtin_ctzll(v) >> 3);
+    }
+    for (; p < end; ++p) {
+        if (static_cast<unsigned char>(*p) >= 0x80) break;
+    }
+    return static_cast<size_t>(p - begin);
+}
+
+/**
+ * SEQUENCE CHECK (Unicode table 3-7, well-formed byte sequences)
+ * @return the length of the valid sequence at `p`, or 0 with `invalid` set to the length
+ * of the maximal invalid subpart (at least 1).
+ */
+static size_t sequenceLength(const unsigned char *p, size_t n, size_t &invalid) {
+    const unsigned char c = p[0];
+    size_t trailing;
+    unsigned char lo = 0x80, hi = 0xBF; // Range of the first continuation byte
+    if (c >= 0xC2 && c <= 0xDF) {
+        trailing = 1;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        trailing = 2;
+        if (c == 0xE0) lo = 0xA0;      // Overlong
+        else if (c == 0xED) hi = 0x9F; // Surrogates
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        trailing = 3;
+        if (c == 0xF0) lo = 0x90;      // Overlong
+        else if (c == 0xF4) hi = 0x8F; // Above U+10FFFF
+    } else {
+        invalid = 1;                   // Continuation byte, C0/C1 or F5..FF
+        return 0;
+    }
+    for (size_t i = 1; i <= trailing; ++i) {
+        if (i == n || p[i] < lo || p[i] > hi) {
+            invalid = i;
+            return 0;
+        }
+        lo = 0x80;
+        hi = 0xBF;
+    }
+    return trailing + 1;
+}
+
+size_t utf8InvalidOffset(std::string_view text) {
+    const auto *p = reinterpret_cast<const unsigned char *>(text.data());
+    const size_t n = text.size();
+    size_t i = 0, invalid;
+    while (i < n) {
+        i += asciiPrefix(text.data() + i, n - i);
+        // Non-ASCII text tends to come in runs: stay scalar until ASCII shows up again
+        while (i < n && p[i] >= 0x80) {
+            size_t length = sequenceLength(p + i, n - i, invalid);
+            if (unlikely(length == 0)) return i;
+            i += length;
+        }
+    }
+    return std::string_view::npos;
+}
+
+void utf8Repair(std::string_view text, size_t from, Utf8Repair mode, std::string &out) {
+    static constexpr char HEX[] = "0123456789ABCDEF";
+    const auto *p = reinterpret_cast<const unsigned char *>(text.data());
+    const size_t n = text.size();
+    out.append(text.data(), from);
+    size_t i = from, invalid;
+    while (i < n) {
+        size_t ascii = asciiPrefix(text.data() + i, n - i);
+        out.append(text.data() + i, ascii);
+        i += ascii;
+        while (i < n && p[i] >= 0x80) {
+            size_t length = sequenceLength(p + i, n - i, invalid);
+            if (likely(length != 0)) {
+                out.append(text.data() + i, length);
+                i += length;
+            } else if (mode == Utf8Repair::REPLACE) {
+                out.append("\xEF\xBF\xBD");
+                i += invalid;
+            } else {
+                const char escape[] = {'\\', 'x', HEX[p[i] >> 4], HEX[p[i] & 15]};
+                out.append(escape, sizeof(escape));
+                i += 1;
+            }
+        }
+    }
+}
+
+/**
+ * ASCII WIDENING
+ * Zero-extends 16 bytes to 16 UTF-16 units if they are all ASCII.
+ * @return false (nothing written) if the block holds a non-ASCII byte.
+ */
+static inline bool widenAscii16(const char *p, char16_t *out) {
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+    const uint8x16_t high = vcgeq_u8(v, vdupq_n_u8(0x80));
+    if (vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(high), 4)), 0)) return false;
+    vst1q_u16(reinterpret_cast<uint16_t *>(out), vmovl_u8(vget_low_u8(v)));
+    vst1q_u16(reinterpret_cast<uint16_t *>(out) + 8, vmovl_u8(vget_high_u8(v)));
+    return true;
+#elif defined(__SSE2__)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    if (_mm_movemask_epi8(v)) return false;
+    const __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi8(v, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out) + 1, _mm_unpackhi_epi8(v, zero));
+    return true;
+#else
+    uint64_t a, b;
+    memcpy(&a, p, sizeof(a));
+    memcpy(&b, p + 8, sizeof(b));
+    if ((a | b) & 0x8080808080808080ULL) return false;
+    for (int i = 0; i < 16; ++i) out[i] = static_cast<unsigned char>(p[i]);
+    return true;
+#endif
+}
+
+size_t utf8ToUtf16(const char *p, size_t n, char16_t *out) {
+    const auto *s = reinterpret_cast<const unsigned char *>(p);
+    char16_t *o = out;
+    size_t i = 0, invalid;
+    while (i < n) {
+        while (n - i >= 16 && widenAscii16(p + i, o)) {
+            i += 16;
+            o += 16;
+        }
+        if (i == n) break;
+
+        const unsigned char c = s[i];
+        if (c < 0x80) {
+            *o++ = c;
+            ++i;
+            continue;
+        }
+        const size_t length = sequenceLength(s + i, n - i, invalid);
+        if (unlikely(length == 0)) {
+            *o++ = 0xFFFD;
+            i += invalid;
+            continue;
+        }
+        uint32_t cp;
+        if (length == 2) {
+            cp = (c & 0x1Fu) << 6 | (s[i + 1] & 0x3Fu);
+        } else if (length == 3) {
+            cp = (c & 0x0Fu) << 12 | (s[i + 1] & 0x3Fu) << 6 | (s[i + 2] & 0x3Fu);
+        } else {
+            cp = (c & 0x07u) << 18 | (s[i + 1] & 0x3Fu) << 12 | (s[i + 2] & 0x3Fu) << 6 | (s[i + 3] & 0x3Fu);
+        }
+        if (cp < 0x10000) {
+            *o++ = static_cast<char16_t>(cp);
+        } else {
+            cp -= 0x10000;
+            *o++ = static_cast<char16_t>(0xD800 + (cp >> 10));
+            *o++ = static_cast<char16_t>(0xDC00 + (cp & 0x3FF));
+        }
+        i += length;
+    }
+    return static_cast<size_t>(o - out);
+}
+
+void utf16ToUtf8(const char16_t *p, size_t n, std::string &out) {
+    out.reserve(out.size() + n);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t cp = p[i];
+        if (likely(cp < 0x80)) {
+            out.push_back(static_cast<char>(cp));
+            continue;
+        }
+        if (cp >= 0xD800 && cp <= 0xDFFF) {
+            if (cp <= 0xDBFF && i + 1 < n && p[i + 1] >= 0xDC00 && p[i + 1] <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (p[++i] - 0xDC00);
+            } else {
+                cp = 0xFFFD;
+            }
+        }
+        if (cp < 0x800) {
+            const char bytes[] = {static_cast<char>(0xC0 | cp >> 6), static_cast<char>(0x80 | (cp & 0x3F))};
+            out.append(bytes, 2);
+        } else if (cp < 0x10000) {
+            const char bytes[] = {static_cast<char>(0xE0 | cp >> 12), static_cast<char>(0x80 | (cp >> 6 & 0x3F)),
+                                  static_cast<char>(0x80 | (cp & 0x3F))};
+            out.append(bytes, 3);
+        } else {
+            const char bytes[] = {static_cast<char>(0xF0 | cp >> 18), static_cast<char>(0x80 | (cp >> 12 & 0x3F)),
+                                  static_cast<char>(0x80 | (cp >> 6 & 0x3F)), static_cast<char>(0x80 | (cp & 0x3F))};
+            out.append(bytes, 4);
+        }
+    }
+}
+
+size_t utf8BoundaryPrefix(const char *p, size_t n) {
+    const auto *s = reinterpret_cast<const unsigned char *>(p);
+    // Back up over at most 3 continuation bytes to the lead byte of the last character
+    size_t lead = n;
+    while (lead > 0 && n - lead < 4 && (s[lead - 1] & 0xC0) == 0x80) --lead;
+    if (lead == 0 || s[lead - 1] < 0xC0) return n; // ASCII or stray continuation bytes: nothing to keep back
+    const unsigned char c = s[lead - 1];
+    const size_t expected = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+    return n - (lead - 1) < expected ? lead - 1 : n;
+}
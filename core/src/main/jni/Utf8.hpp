@@ -0,0 +1,68 @@
+#ifndef UTF8_HPP
+#define UTF8_HPP
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * UTF-8 CHECKS
+ *
+ * Native code may log anything (truncated multi-byte characters, Latin-1, binary), while
+ * the Kotlin side decodes the stream as UTF-8. Events are checked before delivery and
+ * invalid sequences are repaired here, once, so the decoder never meets them.
+ *
+ * ASCII runs are skipped 16 bytes at a time (NEON on ARM, SSE2 on x86, 8-byte SWAR words
+ * elsewhere and for tails); multi-byte sequences are checked against the Unicode
+ * well-formedness table (no overlongs, surrogates or code points above U+10FFFF).
+ */
+enum class Utf8Repair : uint8_t {
+    REPLACE,    // Each maximal invalid subpart becomes U+FFFD (as decoders do)
+    HEX,        // Each invalid byte becomes "\xNN", keeping the original bytes readable
+};
+
+/**
+ * @return the number of leading ASCII bytes of [p, p + n).
+ */
+size_t asciiPrefix(const char *p, size_t n);
+
+inline bool isAscii(std::string_view text) {
+    return asciiPrefix(text.data(), text.size()) == text.size();
+}
+
+/**
+ * @return the offset of the first invalid byte, or std::string_view::npos if `text` is
+ * valid UTF-8. A sequence cut off by the end of `text` counts as invalid.
+ */
+size_t utf8InvalidOffset(std::string_view text);
+
+/**
+ * Appends `text` to `out` with every invalid sequence repaired.
+ * @param from Offset of the first invalid byte (utf8InvalidOffset()); everything before
+ *        it is copied as is.
+ */
+void utf8Repair(std::string_view text, size_t from, Utf8Repair mode, std::string &out);
+
+/**
+ * UTF-8 -> UTF-16 for Java strings. ASCII is widened 16 bytes per step; characters above
+ * U+FFFF become surrogate pairs and an invalid sequence becomes one U+FFFD.
+ * @param out Room for `n` units (never more are written).
+ * @return the number of UTF-16 units written.
+ */
+size_t utf8ToUtf16(const char *p, size_t n, char16_t *out);
+
+/**
+ * UTF-16 -> UTF-8 for strings coming from Java. Surrogate pairs become 4-byte sequences
+ * (not the 6-byte CESU form of modified UTF-8); an unpaired surrogate becomes U+FFFD.
+ * Appends to `out`.
+ */
+void utf16ToUtf8(const char16_t *p, size_t n, std::string &out);
+
+/**
+ * @return the length of the longest prefix of [p, p + n) that does not end inside a
+ * multi-byte sequence (where a buffer can be cut without splitting a character).
+ */
+size_t utf8BoundaryPrefix(const char *p, size_t n);
+
+#endif // UTF8_HPP
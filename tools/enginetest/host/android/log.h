@@ -0,0 +1,37 @@
+#ifndef ENGINETEST_ANDROID_LOG_H
+#define ENGINETEST_ANDROID_LOG_H
+
+#include <cstdarg>
+#include <cstdio>
+
+/**
+ * Host stand-in for the NDK's <android/log.h>: the priorities and __android_log_print()
+ * the engine sources use, printed to stderr. LiblogSource mirrors the rest itself.
+ */
+typedef enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+} android_LogPriority;
+
+extern "C" inline int __android_log_print(int prio, const char *tag, const char *fmt, ...)
+        __attribute__((format(printf, 3, 4)));
+
+extern "C" inline int __android_log_print(int prio, const char *tag, const char *fmt, ...) {
+    static const char LEVELS[] = "??VDIWEFS";
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%c/%s: ", prio >= 0 && prio <= ANDROID_LOG_SILENT ? LEVELS[prio] : '?', tag);
+    int n = vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    return n;
+}
+
+#endif // ENGINETEST_ANDROID_LOG_H
@@ -0,0 +1,197 @@
+#include "LogEngine.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+/**
+ * hot_path_alloc_test: counts heap allocations made by the engine's read batches once
+ * they reach a steady state, and fails if a path that must not allocate does.
+ *
+ * Every batch runs exactly what processLogStream() runs per read (beginBatch(), one
+ * acceptLine() per line, endBatch()), single-threaded, with output to /dev/null. The
+ * corpus repeats, so after warm-up every tag is interned, every buffer has grown and the
+ * arena covers a whole batch.
+ *
+ * Lines the std::regex executor sees are reported but not asserted: its state is private
+ * to the standard library (libstdc++ keeps one vector per search outside the arena;
+ * libc++ keeps a std::deque per candidate start position).
+ */
+
+/**
+ * MALLOC COUNTER
+ * Interposes the glibc entry points; only calls made while g_counting is set are counted.
+ */
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void *__libc_memalign(size_t align, size_t size);
+
+static bool g_counting = false;
+static size_t g_allocations = 0;
+
+extern "C" void *malloc(size_t size) {
+    if (g_counting) ++g_allocations;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) {
+    if (g_counting) ++g_allocations;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) {
+    if (g_counting) ++g_allocations;
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" int posix_memalign(void **out, size_t align, size_t size) {
+    if (g_counting) ++g_allocations;
+    *out = __libc_memalign(align, size);
+    return *out ? 0 : ENOMEM;
+}
+
+extern "C" void *aligned_alloc(size_t align, size_t size) {
+    if (g_counting) ++g_allocations;
+    return __libc_memalign(align, size);
+}
+
+/**
+ * One read batch of `-v time` output: app logs, a crash with its stack trace, a line
+ * with invalid UTF-8 and lines without a header.
+ */
+static const char CORPUS[] =
+        "10-17 09:14:03.101 I/ActivityManager( 1312): Start proc 8123:com.example.mail/u0a211 for activity\n"
+        "10-17 09:14:03.102 D/OkHttp  ( 8123): --> GET https://api.example.com/v1/inbox\n"
+        "10-17 09:14:03.140 D/OkHttp  ( 8123): <-- 200 OK https://api.example.com/v1/inbox (38ms)\n"
+        "10-17 09:14:03.141 W/okhttp.OkHttpClient( 8123): A connection was leaked. Did you forget to close a response body?\n"
+        "10-17 09:14:03.150 V/Choreographer( 8123): Skipped 31 frames!  The application may be doing too much work\n"
+        "10-17 09:14:03.151 I/chatty  ( 8123): uid=10211(com.example.mail) RenderThread identical 4 lines\n"
+        "10-17 09:14:03.162 E/AndroidRuntime( 8123): FATAL EXCEPTION: main\n"
+        "10-17 09:14:03.162 E/AndroidRuntime( 8123): java.lang.IllegalStateException: socket closed\n"
+        "10-17 09:14:03.162 E/AndroidRuntime( 8123): \tat com.example.mail.sync.Fetcher.read(Fetcher.java:88)\n"
+        "10-17 09:14:03.162 E/AndroidRuntime( 8123): \tat com.example.mail.sync.Fetcher.run(Fetcher.java:41)\n"
+        "10-17 09:14:03.162 E/AndroidRuntime( 8123): Caused by: java.net.SocketException: Connection reset\n"
+        "10-17 09:14:03.162 E/AndroidRuntime( 8123): \t... 2 more\n"
+        "10-17 09:14:03.170 I/Process ( 8123): Sending signal. PID: 8123 SIG: 9\n"
+        "10-17 09:14:03.171 W/InputDispatcher( 1312): channel '3f2a com.example.mail' ~ Channel is unrecoverably broken\n"
+        "10-17 09:14:03.172 I/WifiService( 1312): acquireWifiLock uid=10211 lockMode=3 caf\xe9\n"
+        "--------- beginning of system\n"
+        "10-17 09:14:03.180 D/PowerManagerService( 1312): acquireWakeLockInternal: lock=87151 flags=0x1 tag=\"*job*/sync\"\n"
+        "10-17 09:14:03.181 I/ActivityManager( 1312): Process com.example.mail (pid 8123) has died: fg  TOP\n"
+        "plain text without a header\n";
+
+/**
+ * Which matcher decides the filtered lines; the harness checks the engine agrees.
+ */
+enum class Path { NONE, PREFILTER, BIT_PARALLEL, REGEX };
+
+struct Scenario {
+    const char *name;
+    const char *pattern;  // Filter, "" for none
+    bool framed;
+    uint32_t windowMs;    // Multi-line reassembly window, 0 = off
+    Path path;            // REGEX: allocations are reported, not asserted
+};
+
+static const Scenario SCENARIOS[] = {
+        {"unfiltered, plain",            "",                        false, 0,  Path::NONE},
+        {"unfiltered, framed",           "",                        true,  0,  Path::NONE},
+        {"unfiltered, reassembly",       "",                        false, 50, Path::NONE},
+        {"prefilter rejects",            "timeout.*retry",          false, 0,  Path::PREFILTER},
+        {"prefilter rejects, framed",    "timeout.*retry",          true,  50, Path::PREFILTER},
+        {"bit-parallel matcher",         "Ok[Hh]ttp",               false, 0,  Path::BIT_PARALLEL},
+        {"bit-parallel matcher, framed", "\\tat com\\.example",      true,  50, Path::BIT_PARALLEL},
+        {"std::regex",                   "pid \\d+|SIG: \\d",       false, 0,  Path::REGEX},
+        {"std::regex, framed",           "(Fetch|Sync)er\\.\\w+",   true,  50, Path::REGEX},
+};
+
+static constexpr int WARMUP_BATCHES = 16;
+static constexpr int MEASURED_BATCHES = 256;
+
+/**
+ * Drives a LogEngine the way its worker does, without logcat or a thread.
+ */
+class HotPathHarness {
+public:
+    explicit HotPathHarness(const Scenario &s) {
+        m_null = open("/dev/null", O_WRONLY | O_CLOEXEC);
+        m_engine.m_output.reset(m_null, s.framed);
+        Arena::setCurrent(&m_engine.m_batch_arena);
+        m_engine.updateRegex(s.pattern);
+        m_engine.setReassemblyWindow(s.windowMs);
+    }
+
+    ~HotPathHarness() {
+        Arena::setCurrent(nullptr);
+        close(m_null);
+    }
+
+    bool batch(std::string_view input) {
+        m_engine.beginBatch();
+        bool ok = true;
+        size_t pos = 0, next;
+        while (ok && (next = input.find('\n', pos)) != std::string_view::npos) {
+            ok = m_engine.acceptLine(input.substr(pos, next - pos), nullptr);
+            pos = next + 1;
+        }
+        m_engine.endBatch(input.size());
+        return ok;
+    }
+
+    EngineStats stats() const { return m_engine.stats(); }
+
+    bool bitParallel() const { return m_engine.m_short_matcher.active(); }
+
+private:
+    LogEngine m_engine;
+    int m_null = -1;
+};
+
+int main() {
+    const std::string_view corpus(CORPUS, sizeof(CORPUS) - 1);
+    bool failed = false;
+
+    printf("%-30s %8s %8s %8s %8s\n", "scenario", "lines", "checks", "skips", "mallocs");
+    for (const Scenario &s: SCENARIOS) {
+        HotPathHarness harness(s);
+        bool ok = true;
+        for (int i = 0; i < WARMUP_BATCHES; ++i) ok = harness.batch(corpus) && ok;
+        const EngineStats before = harness.stats();
+
+        g_allocations = 0;
+        g_counting = true;
+        for (int i = 0; i < MEASURED_BATCHES; ++i) ok = harness.batch(corpus) && ok;
+        g_counting = false;
+        const size_t allocations = g_allocations;
+
+        const EngineStats after = harness.stats();
+        const uint64_t lines = after.linesRead - before.linesRead;
+        const uint64_t checks = after.filterChecks - before.filterChecks;
+        const uint64_t skips = after.prefilterSkips - before.prefilterSkips;
+        const bool asserted = s.path != Path::REGEX;
+        printf("%-30s %8llu %8llu %8llu %8zu%s\n", s.name, static_cast<unsigned long long>(lines),
+               static_cast<unsigned long long>(checks), static_cast<unsigned long long>(skips), allocations,
+               asserted ? "" : "  (not asserted)");
+
+        // The scenario must exercise the path it is named after
+        bool onPath;
+        switch (s.path) {
+            case Path::NONE: onPath = checks == 0; break;
+            case Path::PREFILTER: onPath = checks > 0 && skips == checks; break;
+            case Path::BIT_PARALLEL: onPath = checks > skips && harness.bitParallel(); break;
+            default: onPath = checks > skips && !harness.bitParallel(); break;
+        }
+        if (!ok || lines == 0 || !onPath) {
+            fprintf(stderr, "FAIL %s: the batches did not take the expected path\n", s.name);
+            failed = true;
+        } else if (asserted && allocations != 0) {
+            fprintf(stderr, "FAIL %s: %zu heap allocations in the steady state\n", s.name, allocations);
+            failed = true;
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+#include "LiteralPrefilter.hpp"
+#include <cctype>
+#include <cstdio>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+/**
+ * prefilter_diff_test: LiteralPrefilter against std::regex.
+ *
+ * The prefilter may only reject a line the regex rejects too; the engine compiles filters
+ * as ECMAScript | icase, so that is the reference. Patterns come from a fixed corpus of
+ * the constructs the pattern walk has to get right (classes, "[^a]" under icase, '.'
+ * against "\r\n", {n,m}, lookaheads, groups, alternation, escapes) and from a seeded
+ * generator; texts likewise. findFolded() is checked against a naive search.
+ */
+
+static const std::regex::flag_type ENGINE_FLAGS =
+        std::regex::ECMAScript | std::regex::icase | std::regex::optimize;
+
+static const char *const PATTERNS[] = {
+        // Literals and case
+        "Http.*timeout", "OkHttp", "E/AndroidRuntime", "FATAL EXCEPTION", "caf\xc3\xa9",
+        // Classes
+        "E/Ok[Hh]ttp", "[abc]]x", "a[^a]b", "[^a]bc", "x[^A]y", "err[o0]r", "[-a]bc", "ab[]]",
+        "\\d+ms took", "\\w+Exception", "id=\\s*\\d", "\\Dab", "ab\\Wcd", "[\\d_]xy",
+        // '.' and line breaks
+        "err.r", "a.b", "a\\.b", "no\\nnewline", "a\\r\\nb", "line.\\nnext", "ab.cd",
+        // Quantifiers
+        "ab+c", "colou?r", "x{2,}yy", "ab{2}c", "ab{0,1}cd", "a{1,3}bc", "(ab){2,3}cd",
+        "xa*?b", "ab+?cd", "abc{0}de", "ab{3,5}?c",
+        // Groups and alternation
+        "foo(bar)?baz", "foo(bar|qux)end", "(?:GET|POST) /api", "a|b", "ab|cd", "(ab)+cd",
+        "((ab)c)d", "(a(b|c))de", "x(?:yz)*w", "(ab)(cd)?ef", "(ab|)cd",
+        // Lookaheads and back-references
+        "(?=abc)abcd", "(?!abc)abd", "ab(?=cd)", "ab(?!cd)ef", "(ab)\\1cd", "(a)b\\1",
+        // Escapes
+        "\\x41bc", "\\u0041bc", "\\cJab", "\\0ab", "\\.so\\b", "\\bword\\b", "a\\tb", "\\/path\\/",
+        // Anchors
+        "^ab", "cd$", "^abc$", "a^b",
+};
+
+static const char *const TEXTS[] = {
+        "", "a", "ab", "abc", "ABC", "abcd", "AbCd", "abd", "abef", "abcdef", "abab cd", "ababcd",
+        "10-17 09:14:03.101 D/OkHttp  ( 8123): --> GET https://api.example.com/v1",
+        "10-17 09:14:03.162 E/AndroidRuntime( 8123): FATAL EXCEPTION: main",
+        "E/OKHTTP timeout", "HTTP read TIMEOUT", "error", "err0r", "ERRoR", "errXr", "err\nr", "err\rr",
+        "a\nb", "a\rb", "a.b", "a\r\nb", "no\nnewline", "line1\nnext", "abcde", "abc]x", "ab]",
+        "aab", "abb", "aAb", "xay", "xAy", "xby", "bbc", "Abc", "-bc", "12ms took", "NullPointerException",
+        "id= 5", "id=5", "xab", "1ab", "ab cd", "ab-cd", "_xy", "5xy", "colour", "color", "COLOR",
+        "xxyy", "xyy", "abbc", "acd", "abcd", "aaabc", "ababcd", "abababcd", "xb", "xaaab", "abbcd",
+        "abde", "abbbc", "foobaz", "foobarbaz", "FOOQUXEND", "GET /api/v1", "post /API", "cd", "b",
+        "abcd", "abcdd", "acde", "abde", "xw", "xyzyzw", "abef", "abcdef", "ababcd", "aba", "Aba",
+        "Abc", "\x01" "ab", "ab\ncd", "libfoo.so ", "a word.", "a\tb", "/path/", "caf\xc3\xa9",
+        "CAF\xc3\x89", "ab^c", "aab", "xcd",
+};
+
+/**
+ * @return a "<pattern> / <text>" description with control characters escaped.
+ */
+static std::string describe(const std::string &pattern, const std::string &text) {
+    std::string s = pattern + "  /  ";
+    for (unsigned char c: text) {
+        if (c == '\n') s += "\\n";
+        else if (c == '\r') s += "\\r";
+        else if (c < 0x20) s += "\\x" + std::to_string(c);
+        else s += static_cast<char>(c);
+    }
+    return s;
+}
+
+struct Totals {
+    size_t checks = 0;
+    size_t skips = 0;
+    size_t failures = 0;
+};
+
+/**
+ * One pattern against texts: a text the prefilter rejects must not match.
+ */
+static void check(const std::string &pattern, const std::vector<std::string> &texts, Totals &totals) {
+    std::regex re;
+    try {
+        re = std::regex(pattern, ENGINE_FLAGS);
+    } catch (const std::regex_error &) {
+        return; // The engine keeps no filter then
+    }
+    LiteralPrefilter prefilter;
+    if (!prefilter.compile(pattern)) return;
+    for (const std::string &text: texts) {
+        ++totals.checks;
+        if (prefilter.mayMatch(text)) continue;
+        ++totals.skips;
+        if (std::regex_search(text, re)) {
+            if (totals.failures++ < 20) fprintf(stderr, "FAIL rejected a match: %s\n", describe(pattern, text).c_str());
+        }
+    }
+}
+
+static bool checkLiterals(const char *pattern, const std::vector<std::string> &expected) {
+    LiteralPrefilter prefilter;
+    prefilter.compile(pattern);
+    std::vector<std::string> literals;
+    for (size_t i = 0; i < prefilter.count(); ++i) literals.push_back(prefilter.literal(i));
+    if (literals == expected) return true;
+    std::string got;
+    for (const std::string &l: literals) got += " [" + l + "]";
+    fprintf(stderr, "FAIL literals of %s:%s\n", pattern, got.c_str());
+    return false;
+}
+
+int main() {
+    bool failed = false;
+    Totals totals;
+    std::mt19937 rng(0x5eed);
+
+    // Fixed corpus, plus texts generated from the same alphabet as the patterns
+    std::vector<std::string> texts(std::begin(TEXTS), std::end(TEXTS));
+    static const char ALPHABET[] = "aAbBcCdx.1 _-\n\r\xc3\xa9";
+    for (int i = 0; i < 400; ++i) {
+        std::string text;
+        const size_t length = rng() % 24;
+        for (size_t k = 0; k < length; ++k) text += ALPHABET[rng() % (sizeof(ALPHABET) - 1)];
+        texts.push_back(text);
+    }
+    for (const char *pattern: PATTERNS) check(pattern, texts, totals);
+    printf("corpus:    %zu checks, %zu rejected\n", totals.checks, totals.skips);
+
+    // Generated patterns: atoms with quantifiers, some inside alternations
+    static const char *const ATOMS[] = {"a", "b", "A", "B", "c", "x", "ab", "Ba", "\\.", ".", "[ab]", "[^a]",
+                                        "\\d", "\\s", "1", " ", "(ab)", "(a|b)", "(?:bA)", "(?=ab)", "(?!a)",
+                                        "\\n", "\\r", "\xc3\xa9"};
+    static const char *const QUANTIFIERS[] = {"", "", "", "*", "+", "?", "{2}", "{0,1}", "{1,3}", "{2,}", "*?"};
+    Totals generated;
+    for (int i = 0; i < 20000; ++i) {
+        std::string pattern;
+        const size_t atoms = 1 + rng() % 6;
+        for (size_t k = 0; k < atoms; ++k) {
+            pattern += ATOMS[rng() % (sizeof(ATOMS) / sizeof(*ATOMS))];
+            pattern += QUANTIFIERS[rng() % (sizeof(QUANTIFIERS) / sizeof(*QUANTIFIERS))];
+        }
+        if (rng() % 10 == 0) pattern += "|c";
+        std::vector<std::string> some;
+        for (int k = 0; k < 16; ++k) some.push_back(texts[rng() % texts.size()]);
+        check(pattern, some, generated);
+    }
+    printf("generated: %zu checks, %zu rejected\n", generated.checks, generated.skips);
+    totals.failures += generated.failures;
+
+    // The analysis must not be vacuous either
+    failed |= !checkLiterals("Http.*timeout", {"timeout", "http"});
+    failed |= !checkLiterals("E/Ok[Hh]ttp", {"e/ok", "ttp"});
+    failed |= !checkLiterals("foo(bar)?baz", {"foo", "baz"});
+    failed |= !checkLiterals("foo(bar|qux)end", {"foo", "end"});
+    failed |= !checkLiterals("(?:GET|POST) /api", {" /api"});
+    failed |= !checkLiterals("(?=abc)abd", {"abd"});
+    failed |= !checkLiterals("x{2,}yy", {"yy"});
+    failed |= !checkLiterals("a|b", {});
+    if (totals.skips == 0 || generated.skips == 0) {
+        fprintf(stderr, "FAIL the prefilter never rejected a line\n");
+        failed = true;
+    }
+
+    // findFolded against a naive search; haystacks long enough for the vector loop and its tail
+    size_t findFailures = 0;
+    for (int i = 0; i < 100000; ++i) {
+        std::string haystack, needle;
+        const size_t size = rng() % 80, length = 1 + rng() % 6;
+        for (size_t k = 0; k < size; ++k) haystack += "aAbB:zZ\xc3"[rng() % 8];
+        for (size_t k = 0; k < length; ++k) needle += "ab:z\xc3"[rng() % 5];
+        size_t expected = std::string::npos;
+        for (size_t p = 0; p + length <= size && expected == std::string::npos; ++p) {
+            size_t k = 0;
+            while (k < length && static_cast<char>(tolower(static_cast<unsigned char>(haystack[p + k]))) == needle[k]) ++k;
+            if (k == length) expected = p;
+        }
+        if (findFolded(haystack, needle) != expected && findFailures++ < 20) {
+            fprintf(stderr, "FAIL findFolded(%s, %s) = %zu, expected %zu\n", haystack.c_str(), needle.c_str(),
+                    findFolded(haystack, needle), expected);
+        }
+    }
+
+    if (totals.failures || findFailures) {
+        fprintf(stderr, "FAIL %zu false rejections, %zu findFolded mismatches\n", totals.failures, findFailures);
+        failed = true;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+#include "ShiftAndMatcher.hpp"
+#include <cstdio>
+#include <random>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * shift_and_diff_test: ShiftAndMatcher against std::regex.
+ *
+ * For every pattern the matcher accepts, the successive leftmost matches it finds (as the
+ * engine collects highlight spans) must equal std::regex_search's, with and without icase.
+ * Patterns outside its syntax ({n,m}, groups, lookaheads, alternation, anchors, ...) must
+ * be refused so the engine falls back to std::regex. Patterns come from a fixed corpus and
+ * a seeded generator; both Shift-And (under 4 positions) and BNDM are covered.
+ */
+
+using Spans = std::vector<std::pair<size_t, size_t>>;
+
+static const char *const ACCEPTED[] = {
+        // Literals, case and escaped punctuation
+        "a", "ab", "OkHttp", "E/AndroidRuntime", "FATAL EXCEPTION", "\\.so", "a\\.b", "\\/path\\/",
+        "\\[x\\]", "caf\xc3\xa9",
+        // Classes
+        "E/Ok[Hh]ttp", "[abc]", "[^a]", "a[^a]b", "[^a]bc", "x[^A]y", "[a-c]x", "[A-c]", "[-a]b", "[a-]b",
+        "[^\\s]x", "[\\d_]y", "[\\w.]z", "[^\\d]a", "\\d\\d:\\d\\d", "\\w\\w\\w", "\\s\\S", "\\D\\W",
+        // '.' against line breaks, control escapes
+        ".", "a.b", "err.r", "..", "a\\nb", "a\\r\\nb", "\\t.", "x\\fy\\vz",
+        // Long enough for BNDM's skips, at the 64 position limit
+        "abcdefghijklmnopqrstuvwxyz", "Start proc \\d\\d\\d\\d:com\\.example",
+        "0123456789012345678901234567890123456789012345678901234567890123",
+};
+
+static const char *const REFUSED[] = {
+        "a{2}", "ab{0,1}c", "a{1,3}b", "x{2,}", "ab*c", "ab+c", "colou?r", "(ab)", "(?:ab)cd", "(a|b)c",
+        "a|b", "(?=ab)a", "(?!ab)c", "(ab)\\1", "^ab", "ab$", "\\bword", "\\Bx", "\\x41", "\\u0041",
+        "\\cJ", "[[:alpha:]]", "[z-a]", "ab\\", "[ab", "a]", "a}", "",
+        "01234567890123456789012345678901234567890123456789012345678901234", // 65 positions
+};
+
+static const char *const TEXTS[] = {
+        "", "a", "ab", "AB", "aab", "abab", "aAbB", "xay", "xAy", "xby", "bbc", "Abc", "-b", "b-b",
+        "10-17 09:14:03.101 D/OkHttp  ( 8123): --> GET https://api.example.com/v1",
+        "10-17 09:14:03.162 E/AndroidRuntime( 8123): FATAL EXCEPTION: main",
+        "10-17 09:14:03.101 I/ActivityManager( 1312): Start proc 8123:com.example.mail/u0a211",
+        "e/okhttp E/OKHTTP", "error err0r ERRoR errXr", "err\nr err\rr", "a\nb", "a\rb", "a\r\nb",
+        "libfoo.so", "/path/", "[x]", "caf\xc3\xa9 CAF\xc3\x89", "\t\t", "x\fy\vz", "12:34:56",
+        "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ abcdefghijklmnopqrstuvwxyz",
+        "0123456789012345678901234567890123456789012345678901234567890123456789",
+};
+
+static Spans regexSpans(const std::string &text, const std::regex &re) {
+    Spans spans;
+    const char *cur = text.data(), *end = text.data() + text.size();
+    auto flags = std::regex_constants::match_default;
+    std::cmatch m;
+    while (cur <= end && std::regex_search(cur, end, m, re, flags)) {
+        spans.emplace_back(m[0].first - text.data(), m[0].second - text.data());
+        cur = m[0].second;
+        flags = std::regex_constants::match_prev_avail;
+    }
+    return spans;
+}
+
+static Spans matcherSpans(const std::string &text, const ShiftAndMatcher &matcher) {
+    Spans spans;
+    for (size_t from = 0, p; (p = matcher.find(text, from)) != std::string::npos; from = p + matcher.length()) {
+        spans.emplace_back(p, p + matcher.length());
+    }
+    return spans;
+}
+
+/**
+ * @return a "<pattern> / <text>" description with control characters escaped.
+ */
+static std::string describe(const std::string &pattern, const std::string &text) {
+    std::string s = pattern + "  /  ";
+    for (unsigned char c: text) {
+        if (c == '\n') s += "\\n";
+        else if (c == '\r') s += "\\r";
+        else if (c < 0x20) s += "\\x" + std::to_string(c);
+        else s += static_cast<char>(c);
+    }
+    return s;
+}
+
+struct Totals {
+    size_t patterns = 0;
+    size_t comparisons = 0;
+    size_t failures = 0;
+};
+
+/**
+ * @return false if the matcher refused the pattern (or std::regex did).
+ */
+static bool compare(const std::string &pattern, bool icase, const std::vector<std::string> &texts, Totals &totals) {
+    std::regex re;
+    try {
+        re = std::regex(pattern, std::regex::ECMAScript | std::regex::optimize |
+                                 (icase ? std::regex::icase : std::regex::flag_type{}));
+    } catch (const std::regex_error &) {
+        return false;
+    }
+    ShiftAndMatcher matcher;
+    if (!matcher.compile(pattern, icase)) return false;
+    ++totals.patterns;
+    for (const std::string &text: texts) {
+        ++totals.comparisons;
+        const Spans expected = regexSpans(text, re), got = matcherSpans(text, matcher);
+        if (expected != got && totals.failures++ < 20) {
+            fprintf(stderr, "FAIL icase=%d %s: %zu matches, expected %zu\n", icase,
+                    describe(pattern, text).c_str(), got.size(), expected.size());
+        }
+    }
+    return true;
+}
+
+int main() {
+    bool failed = false;
+    std::mt19937 rng(0x5eed);
+
+    std::vector<std::string> texts(std::begin(TEXTS), std::end(TEXTS));
+    static const char ALPHABET[] = "aAbBcCx.1-_: \t\n\r\xc3\xa9";
+    for (int i = 0; i < 200; ++i) {
+        std::string text;
+        const size_t length = rng() % 48;
+        for (size_t k = 0; k < length; ++k) text += ALPHABET[rng() % (sizeof(ALPHABET) - 1)];
+        texts.push_back(text);
+    }
+
+    Totals corpus;
+    for (const char *pattern: ACCEPTED) {
+        for (bool icase: {true, false}) {
+            if (!compare(pattern, icase, texts, corpus)) {
+                fprintf(stderr, "FAIL refused %s (icase=%d)\n", pattern, icase);
+                failed = true;
+            }
+        }
+    }
+    for (const char *pattern: REFUSED) {
+        ShiftAndMatcher matcher;
+        if (matcher.compile(pattern, true)) {
+            fprintf(stderr, "FAIL accepted %s\n", pattern);
+            failed = true;
+        }
+    }
+    printf("corpus:    %zu patterns, %zu comparisons\n", corpus.patterns, corpus.comparisons);
+
+    // Generated patterns, long ones included so BNDM's window skips are exercised
+    static const char *const ATOMS[] = {"a", "b", "A", "B", "x", ".", "\\.", "[ab]", "[^a]", "[A-c]", "\\d",
+                                        "\\w", "\\s", "\\W", "1", "-", "[\\d_]", "[a-]", "\\n", "\\r", ":",
+                                        "[^\\s]", "\xc3\xa9"};
+    Totals generated;
+    for (int i = 0; i < 6000; ++i) {
+        std::string pattern;
+        const size_t atoms = 1 + rng() % (i % 3 == 0 ? 40 : 8);
+        for (size_t k = 0; k < atoms; ++k) pattern += ATOMS[rng() % (sizeof(ATOMS) / sizeof(*ATOMS))];
+        std::vector<std::string> some;
+        for (int k = 0; k < 24; ++k) some.push_back(texts[rng() % texts.size()]);
+        compare(pattern, rng() % 4 != 0, some, generated);
+    }
+    printf("generated: %zu patterns, %zu comparisons\n", generated.patterns, generated.comparisons);
+
+    if (corpus.failures || generated.failures) {
+        fprintf(stderr, "FAIL %zu mismatches against std::regex\n", corpus.failures + generated.failures);
+        failed = true;
+    }
+    return failed ? 1 : 0;
+}
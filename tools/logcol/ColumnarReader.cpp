@@ -0,0 +1,146 @@
+#include "ColumnarReader.hpp"
+#include <cstdio>
+#include <cstring>
+#include <zlib.h>
+
+namespace logcol {
+
+void Block::clear() {
+    timeNs.clear();
+    level.clear();
+    pid.clear();
+    tid.clear();
+    tagId.clear();
+    msgOffset.clear();
+    msgLength.clear();
+    messages.clear();
+}
+
+bool Reader::fail(const std::string &message) {
+    m_error = message;
+    return false;
+}
+
+bool Reader::open(const std::string &path) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return fail("cannot open " + path);
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    m_data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    size_t got = m_data.empty() ? 0 : fread(m_data.data(), 1, m_data.size(), f);
+    fclose(f);
+    if (got != m_data.size()) return fail("short read on " + path);
+
+    if (m_data.size() < sizeof(FileHeader)) return fail("file too small");
+    memcpy(&m_header, m_data.data(), sizeof(FileHeader));
+    if (m_header.magic != FILE_MAGIC) return fail("not a LOGCOL file");
+    if (m_header.version != FORMAT_VERSION) return fail("unsupported LOGCOL version");
+
+    m_pos = sizeof(FileHeader);
+    m_tags.clear();
+    return true;
+}
+
+/**
+ * READ BLOCK
+ * Each column is decoded in its own tight loop (no per-record branching across columns).
+ */
+bool Reader::readBlock(Block &out) {
+    out.clear();
+    if (m_pos + sizeof(BlockHeader) > m_data.size()) return false;
+
+    BlockHeader bh{};
+    memcpy(&bh, m_data.data() + m_pos, sizeof(bh));
+    if (bh.magic != BLOCK_MAGIC) return fail("bad block magic");
+
+    size_t body = static_cast<size_t>(bh.dictBytes) + bh.tsBytes + bh.levelBytes + bh.pidBytes +
+                  bh.tidBytes + bh.tagBytes + bh.msgLenBytes + bh.msgCompressedBytes;
+    if (m_pos + sizeof(bh) + body > m_data.size()) return false; // Truncated tail
+
+    const uint8_t *p = m_data.data() + m_pos + sizeof(bh);
+    const size_t n = bh.recordCount;
+    uint64_t v;
+
+    // Dictionary additions
+    const uint8_t *end = p + bh.dictBytes;
+    for (uint32_t i = 0; i < bh.newTags; ++i) {
+        if (!(p = getVarint(p, end, v)) || v > static_cast<uint64_t>(end - p)) return fail("corrupt dictionary");
+        m_tags.emplace_back(reinterpret_cast<const char *>(p), static_cast<size_t>(v));
+        p += v;
+    }
+    p = end;
+
+    // Timestamps: zigzag deltas
+    out.timeNs.resize(n);
+    end = p + bh.tsBytes;
+    int64_t ts = bh.firstTsNs;
+    for (size_t i = 0; i < n; ++i) {
+        if (!(p = getVarint(p, end, v))) return fail("corrupt ts column");
+        ts += unzigzag(v);
+        out.timeNs[i] = ts;
+    }
+    p = end;
+
+    // Levels: raw bytes
+    if (bh.levelBytes != n) return fail("corrupt level column");
+    out.level.assign(reinterpret_cast<const char *>(p), reinterpret_cast<const char *>(p) + n);
+    p += bh.levelBytes;
+
+    // Pids: zigzag deltas
+    out.pid.resize(n);
+    end = p + bh.pidBytes;
+    int64_t pid = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!(p = getVarint(p, end, v))) return fail("corrupt pid column");
+        pid += unzigzag(v);
+        out.pid[i] = static_cast<int32_t>(pid);
+    }
+    p = end;
+
+    // Tids: relative to the pid of the same record
+    out.tid.resize(n);
+    end = p + bh.tidBytes;
+    for (size_t i = 0; i < n; ++i) {
+        if (!(p = getVarint(p, end, v))) return fail("corrupt tid column");
+        out.tid[i] = static_cast<int32_t>(out.pid[i] + unzigzag(v));
+    }
+    p = end;
+
+    // Tag ids
+    out.tagId.resize(n);
+    end = p + bh.tagBytes;
+    for (size_t i = 0; i < n; ++i) {
+        if (!(p = getVarint(p, end, v)) || v >= m_tags.size()) return fail("corrupt tag column");
+        out.tagId[i] = static_cast<uint32_t>(v);
+    }
+    p = end;
+
+    // Message lengths -> offsets
+    out.msgOffset.resize(n);
+    out.msgLength.resize(n);
+    end = p + bh.msgLenBytes;
+    uint64_t offset = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!(p = getVarint(p, end, v))) return fail("corrupt message length column");
+        out.msgOffset[i] = static_cast<uint32_t>(offset);
+        out.msgLength[i] = static_cast<uint32_t>(v);
+        offset += v;
+    }
+    p = end;
+    if (offset != bh.msgRawBytes) return fail("message lengths do not add up");
+
+    // Messages: one inflate per block
+    out.messages.resize(bh.msgRawBytes);
+    uLongf rawLen = bh.msgRawBytes;
+    if (uncompress(reinterpret_cast<Bytef *>(out.messages.data()), &rawLen, p, bh.msgCompressedBytes) != Z_OK ||
+        rawLen != bh.msgRawBytes) {
+        return fail("corrupt message block");
+    }
+
+    m_pos += sizeof(bh) + body;
+    return true;
+}
+
+} // namespace logcol
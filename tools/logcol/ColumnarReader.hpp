@@ -0,0 +1,77 @@
+#ifndef COLUMNAR_READER_HPP
+#define COLUMNAR_READER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "ColumnarFormat.hpp"
+
+namespace logcol {
+
+/**
+ * One decoded block: columns are exposed as plain arrays for vectorized analysis.
+ * `message(i)` views into `messages`, which stays valid until the next readBlock().
+ */
+struct Block {
+    std::vector<int64_t> timeNs;
+    std::vector<char> level;
+    std::vector<int32_t> pid;
+    std::vector<int32_t> tid;      // Equals pid when the capture format had no thread id
+    std::vector<uint32_t> tagId;
+    std::vector<uint32_t> msgOffset;
+    std::vector<uint32_t> msgLength;
+    std::string messages;
+
+    size_t size() const { return timeNs.size(); }
+
+    std::string_view message(size_t i) const {
+        return std::string_view(messages.data() + msgOffset[i], msgLength[i]);
+    }
+
+    void clear();
+};
+
+/**
+ * Reader: loads a LOGCOL file into memory and decodes it block by block.
+ *
+ * Truncated trailing blocks (e.g. the device died mid-write) are ignored; every earlier
+ * block remains readable.
+ */
+class Reader {
+public:
+    /**
+     * Opens and validates `path`. @return false with `error()` set on failure.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Decodes the next block into `out`. @return false at end of file or on corruption.
+     */
+    bool readBlock(Block& out);
+
+    /**
+     * Tag dictionary accumulated so far (ids index into it).
+     */
+    const std::vector<std::string>& tags() const { return m_tags; }
+
+    std::string_view tag(uint32_t id) const {
+        return id < m_tags.size() ? std::string_view(m_tags[id]) : std::string_view();
+    }
+
+    int64_t createdNs() const { return m_header.createdNs; }
+    const std::string& error() const { return m_error; }
+
+private:
+    bool fail(const std::string& message);
+
+    std::vector<uint8_t> m_data;
+    size_t m_pos = 0;
+    FileHeader m_header{};
+    std::vector<std::string> m_tags;
+    std::string m_error;
+};
+
+} // namespace logcol
+
+#endif // COLUMNAR_READER_HPP
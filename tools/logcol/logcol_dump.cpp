@@ -0,0 +1,80 @@
+#include "ColumnarReader.hpp"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <chrono>
+
+/**
+ * logcol_dump: prints a LOGCOL export.
+ *   logcol_dump <file>            "-v time"-like text (UTC)
+ *   logcol_dump --csv <file>      time_ns,level,pid,tid,tag,message
+ *   logcol_dump --stats <file>    record/block counts and decode time only
+ */
+static void printCsvField(std::string_view s) {
+    putchar('"');
+    for (char c: s) {
+        if (c == '"') putchar('"');
+        putchar(c);
+    }
+    putchar('"');
+}
+
+int main(int argc, char **argv) {
+    bool csv = false, stats = false;
+    const char *path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--csv")) csv = true;
+        else if (!strcmp(argv[i], "--stats")) stats = true;
+        else path = argv[i];
+    }
+    if (!path) {
+        fprintf(stderr, "usage: %s [--csv|--stats] <file.logcol>\n", argv[0]);
+        return 2;
+    }
+
+    logcol::Reader reader;
+    if (!reader.open(path)) {
+        fprintf(stderr, "%s\n", reader.error().c_str());
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    logcol::Block block;
+    size_t records = 0, blocks = 0;
+    if (csv) puts("time_ns,level,pid,tid,tag,message");
+
+    while (reader.readBlock(block)) {
+        blocks++;
+        records += block.size();
+        if (stats) continue;
+
+        for (size_t i = 0; i < block.size(); ++i) {
+            std::string_view tag = reader.tag(block.tagId[i]);
+            std::string_view msg = block.message(i);
+            char level = block.level[i] ? block.level[i] : '-';
+            if (csv) {
+                printf("%lld,%c,%d,%d,", static_cast<long long>(block.timeNs[i]), level, block.pid[i], block.tid[i]);
+                printCsvField(tag);
+                putchar(',');
+                printCsvField(msg);
+                putchar('\n');
+            } else {
+                time_t sec = static_cast<time_t>(block.timeNs[i] / 1000000000LL);
+                struct tm t{};
+                gmtime_r(&sec, &t);
+                printf("%02d-%02d %02d:%02d:%02d.%03d %c/%.*s(%5d): %.*s\n",
+                       t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec,
+                       static_cast<int>((block.timeNs[i] / 1000000) % 1000), level,
+                       static_cast<int>(tag.size()), tag.data(), block.pid[i],
+                       static_cast<int>(msg.size()), msg.data());
+            }
+        }
+    }
+    if (!reader.error().empty()) fprintf(stderr, "stopped: %s\n", reader.error().c_str());
+
+    if (stats) {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        printf("records=%zu blocks=%zu tags=%zu decode_ms=%.2f\n", records, blocks, reader.tags().size(), ms);
+    }
+    return 0;
+}